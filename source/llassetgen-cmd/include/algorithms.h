@@ -1,5 +1,6 @@
 #pragma once
 
+#include <llassetgen/Atlas.h>
 #include <llassetgen/DistanceTransform.h>
 #include <llassetgen/Image.h>
 #include <llassetgen/Packing.h>
@@ -7,24 +8,63 @@
 using namespace llassetgen;
 
 using VecIter = std::vector<Vec2<size_t>>::const_iterator;
-using ImageTransform = void (*)(Image&, Image&);
+using DistanceTransformFactory = ImageTransform (*)(DistanceTransform::OutputType bandLimit);
 
-std::map<std::string, ImageTransform> dtAlgos{
-    {"deadrec", [](Image& input, Image& output) { DeadReckoning(input, output).transform(); }},
-    {"parabola", [](Image& input, Image& output) { ParabolaEnvelope(input, output).transform(); }},
+template <class Transform>
+ImageTransform bandLimitedTransform(DistanceTransform::OutputType bandLimit) {
+    return [bandLimit](Image& input, Image& output) {
+        Transform transform(input, output);
+        transform.setBandLimit(bandLimit);
+        transform.transform();
+    };
+}
+
+// the transforms only need to be exact up to the band limit
+std::map<std::string, DistanceTransformFactory> dtAlgos{
+    {"antialiased", bandLimitedTransform<AntiAliasedEuclidean>},
+    {"deadrec", bandLimitedTransform<DeadReckoning>},
+    {"parabola", bandLimitedTransform<ParabolaEnvelope>},
+    {"parabola-simd", bandLimitedTransform<SimdParabolaEnvelope>},
 };
 
+// distance transforms that work on anti-aliased (grayscale) glyphs instead of black/white ones
+std::set<std::string> coverageDtAlgos{"antialiased"};
+
+// distance transforms that can write a center downsampled distance field directly
+std::set<std::string> centerSamplingDtAlgos{"parabola", "parabola-simd"};
+
+// distance fields computed analytically from the glyph outlines, without rendering the glyphs, by channel count:
+// a single channel, a multi-channel distance field, and the latter with the true distance field as alpha channel
+std::map<std::string, size_t> outlineDtAlgos{{"outline", 1}, {"msdf", 3}, {"mtsdf", 4}};
+
 std::map<std::string, Packing (*)(VecIter, VecIter, bool)> packingAlgos{
     {"shelf", shelfPackAtlas},
-    {"maxrects", maxRectsPackAtlas}
+    {"skyline", skylinePackAtlas},
+    {"guillotine", guillotinePackAtlas},
+    {"maxrects", maxRectsPackAtlas},
+    {"auto", autoPackAtlas}
+};
+
+// the same packings, spread over as many pages of at most the given size as needed
+std::map<std::string, Packing (*)(VecIter, VecIter, Vec2<PackingSizeType>, bool)> pagedPackingAlgos{
+    {"shelf", shelfPackAtlasPages},
+    {"skyline", skylinePackAtlasPages},
+    {"guillotine", guillotinePackAtlasPages},
+    {"maxrects", maxRectsPackAtlasPages},
+    {"auto", autoPackAtlasPages}
 };
 
 std::map<std::string, ImageTransform> downsamplingAlgos{
     {"center", [](Image& input, Image& output) { input.centerDownsampling<DistanceTransform::OutputType>(output); }},
     {"average", [](Image& input, Image& output) { input.averageDownsampling<DistanceTransform::OutputType>(output); }},
-    {"min", [](Image& input, Image& output) { input.minDownsampling<DistanceTransform::OutputType>(output); }}
+    {"min", [](Image& input, Image& output) { input.minDownsampling<DistanceTransform::OutputType>(output); }},
+    {"average-simd", [](Image& input, Image& output) { input.simdAverageDownsampling(output); }},
+    {"min-simd", [](Image& input, Image& output) { input.simdMinDownsampling(output); }}
 };
 
+// downsampling algorithms whose results inside the band only depend on distances inside the band
+std::set<std::string> bandPreservingDownsamplingAlgos{"center", "min", "min-simd"};
+
 template <class Func>
 std::set<std::string> algoNames(std::map<std::string, Func> map) {
     std::set<std::string> names;
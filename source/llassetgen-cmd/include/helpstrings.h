@@ -6,7 +6,10 @@ std::string
     atlasHelp{"Create a font atlas, optionally applying a distance transform"},
     distfieldHelp{
         "Apply a distance transform algorithm to the atlas. If none is chosen, no distance transform will be applied"},
-    packingHelp{"Use a different packing algorithm. 'maxrects' is more space-efficient, 'shelf' is faster"},
+    packingHelp{"Use a different packing algorithm. 'maxrects' is more space-efficient, 'shelf' is faster, 'skyline' "
+                "is almost as fast as 'shelf' and almost as space-efficient as 'maxrects', 'guillotine' is much faster "
+                "than 'maxrects' for many glyphs. 'auto' tries all of them with several heuristics and glyph orders on "
+                "all threads and keeps the smallest atlas"},
     glyphHelp{"Add the specified glyphs to the atlas"},
     charcodeHelp{"Add glyphs to the atlas by specifying their character codes, separated by spaces"},
     fontnameHelp{"Use the font with the specified name"}, fontpathHelp{"Use the font file at the specified path"},
@@ -22,6 +25,23 @@ std::string
         "can find an example file in the 'config' directory"},
     fntHelp{"Generate a font file in the FNT format"}, downsamplingRatioHelp{"Downsample the atlas by this factor."},
     downsamplingHelp{"Use a different downsampling algorithm"},
+    parallelRenderHelp{"Render the glyphs in parallel, with one font face per thread"},
+    directRenderHelp{"Pack the glyph metrics first and render each glyph directly into the atlas, without keeping "
+                     "all glyph images in memory"},
+    bitDepthHelp{"Bits per pixel of the atlas. Font atlases have 1 (default) or 8 bits, glyph pixels are 255 then. "
+                 "Distance field atlases have 32 (default), 8 or 16 bits: the distances of each glyph are quantized to "
+                 "the dynamic range as they are written into the atlas instead of storing floats"},
+    halfFloatHelp{"Store the distance field atlas as 16 bit half floats, without clamping to the dynamic range, and "
+                  "write it as KTX texture (or as raw pixels, if the output file ends with .raw)"},
+    maxMemoryHelp{"Stream the distance field atlas to the PNG file band by band, such that the atlas and glyph buffers "
+                  "stay below the given number of MiB (implies --directrender)"},
+    maxSizeHelp{"Limit the atlas to pages of at most WIDTHxHEIGHT pixels, e.g. 4096x4096. Glyphs that do not fit are "
+                "packed onto further pages, written as OUTFILE_0.png, OUTFILE_1.png and so on"},
+    parallelPagesHelp{"Generate and write the pages of a multi-page atlas in parallel, one page per thread. Not "
+                      "supported with --directrender"},
+    scheduleReportHelp{"Print how busy each thread was while rendering the glyphs and computing the atlas. The glyphs "
+                       "are handed out to the threads largest first. Not supported with --parallel-pages, whose pages run their "
+                       "glyph loops on one thread each"},
 
     dfHelp{"Apply a distance transform to an image"},
     algorithmHelp{"Apply a different distance transform algorithm to the atlas"},
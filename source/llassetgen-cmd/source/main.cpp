@@ -1,7 +1,11 @@
 #include <CLI11.h>
 #include <codecvt>
+#include <cstdlib>
+#include <exception>
 #include <map>
+#include <memory>
 #include <ostream>
+#include <sstream>
 
 #include <algorithms.h>
 #include <helpstrings.h>
@@ -10,6 +14,7 @@
 #include <llassetgen/Atlas.h>
 #include <llassetgen/FntWriter.h>
 #include <llassetgen/FontFinder.h>
+#include <llassetgen/Schedule.h>
 
 using namespace llassetgen;
 
@@ -24,21 +29,60 @@ std::u32string UTF8toUCS4(const std::string& str) {
 #endif
 }
 
-std::vector<Vec2<size_t>> sizes(const std::vector<Image>& images, unsigned int downsamplingRatio) {
-    std::vector<Vec2<size_t>> imageSizes(images.size());
-    std::transform(images.begin(), images.end(), imageSizes.begin(),
-                   [downsamplingRatio](const Image& img) { return img.getSize() / downsamplingRatio; });
+template <class Glyph>
+std::vector<Vec2<size_t>> sizes(const std::vector<Glyph>& glyphs, unsigned int downsamplingRatio) {
+    std::vector<Vec2<size_t>> imageSizes(glyphs.size());
+    std::transform(glyphs.begin(), glyphs.end(), imageSizes.begin(),
+                   [downsamplingRatio](const Glyph& glyph) { return glyph.getSize() / downsamplingRatio; });
     return imageSizes;
 }
 
-std::pair<std::string, std::string> outNames(const std::string& outPath) {
-    std::string pathWithoutExtension;
-    if (outPath.substr(outPath.length() - 4) == ".png") {
-        pathWithoutExtension = outPath.substr(0, outPath.length() - 4);
-    } else {
-        pathWithoutExtension = outPath;
+std::pair<std::string, std::string> outNames(const std::string& outPath, bool halfFloat) {
+    // PNG has no floating point pixels, half float atlases are written as KTX texture or raw pixels
+    std::string extension = halfFloat ? ".ktx" : ".png";
+    std::string pathWithoutExtension = outPath;
+    for (const std::string known : {".png", ".ktx", ".raw"}) {
+        if (outPath.length() > 4 && outPath.substr(outPath.length() - 4) == known) {
+            pathWithoutExtension = outPath.substr(0, outPath.length() - 4);
+            if (halfFloat && known != ".png") {
+                extension = known;
+            }
+        }
     }
-    return std::make_pair(pathWithoutExtension + ".png", pathWithoutExtension + ".fnt");
+    return std::make_pair(pathWithoutExtension + extension, pathWithoutExtension + ".fnt");
+}
+
+// the path of a page of a multi-page atlas, e.g. atlas_1.png for the second page of atlas.png
+std::string pagePath(const std::string& outPath, size_t page) {
+    size_t extension = outPath.rfind('.');
+    return outPath.substr(0, extension) + "_" + std::to_string(page) + outPath.substr(extension);
+}
+
+std::string fileName(const std::string& path) {
+    size_t separator = path.find_last_of("/\\");
+    return separator == std::string::npos ? path : path.substr(separator + 1);
+}
+
+Vec2<PackingSizeType> parseSize(const std::string& size) {
+    std::istringstream stream{size};
+    Vec2<PackingSizeType> result;
+    char separator = 0;
+    stream >> result.x >> separator >> result.y;
+    if (!stream || !stream.eof() || separator != 'x' || result.x == 0 || result.y == 0) {
+        throw std::runtime_error("--max-size expects WIDTHxHEIGHT, e.g. 4096x4096");
+    }
+    return result;
+}
+
+// move the items with the given indices out of a vector
+template <class T>
+std::vector<T> takeItems(std::vector<T>& items, const std::vector<size_t>& indices) {
+    std::vector<T> taken;
+    taken.reserve(indices.size());
+    for (size_t i : indices) {
+        taken.push_back(std::move(items[i]));
+    }
+    return taken;
 }
 
 std::set<unsigned long> makeGlyphSet(const std::string& glyphs, const std::vector<unsigned int>& charCodes,
@@ -84,7 +128,11 @@ int parseAtlasArgs(int argc, char** argv) {
 
     // algorithms
     std::string algorithm;
-    CLI::Option* distfieldOpt = app.add_set("-d, --distfield", algorithm, algoNames(dtAlgos), distfieldHelp);
+    std::set<std::string> distfieldNames = algoNames(dtAlgos);
+    for (const auto& name : algoNames(outlineDtAlgos)) {
+        distfieldNames.insert(name);
+    }
+    CLI::Option* distfieldOpt = app.add_set("-d, --distfield", algorithm, distfieldNames, distfieldHelp);
 
     std::string packing = "shelf";
     app.add_set("-k, --packing", packing, algoNames(packingAlgos), packingHelp, true);
@@ -125,12 +173,37 @@ int parseAtlasArgs(int argc, char** argv) {
     bool createFnt = false;
     app.add_flag("--fnt", createFnt, fntHelp);
 
+    bool parallelRender = false;
+    app.add_flag("--parallelrender", parallelRender, parallelRenderHelp);
+
+    bool directRender = false;
+    app.add_flag("--directrender", directRender, directRenderHelp);
+
+    unsigned int bitDepth = 0;
+    CLI::Option* bitDepthOpt = app.add_set("--bitdepth", bitDepth, {1, 8, 16, 32}, bitDepthHelp);
+
+    bool halfFloat = false;
+    app.add_flag("--halffloat", halfFloat, halfFloatHelp)->requires(distfieldOpt)->excludes(bitDepthOpt);
+
+    size_t maxMemory = 0;
+    CLI::Option* maxMemoryOpt = app.add_option("--max-memory", maxMemory, maxMemoryHelp)->requires(distfieldOpt);
+
+    std::string maxSizeArg;
+    CLI::Option* maxSizeOpt = app.add_option("--max-size", maxSizeArg, maxSizeHelp);
+
+    bool parallelPages = false;
+    CLI::Option* parallelPagesOpt =
+        app.add_flag("--parallel-pages", parallelPages, parallelPagesHelp)->requires(maxSizeOpt);
+
+    bool scheduleReport = false;
+    app.add_flag("--schedule-report", scheduleReport, scheduleReportHelp)->excludes(parallelPagesOpt);
+
     app.set_config("--config", "", configHelp);
 
     CLI11_PARSE(app, argc, argv);
 
     std::string fntPath;
-    std::tie(outPath, fntPath) = outNames(outPath);
+    std::tie(outPath, fntPath) = outNames(outPath, halfFloat);
 
     std::set<unsigned long> glyphSet = makeGlyphSet(glyphs, charCodes, presetName);
     if (glyphSet.empty()) {
@@ -146,30 +219,281 @@ int parseAtlasArgs(int argc, char** argv) {
         // adjust padding such that it resembles the final padding in the result in pixels
         padding *= downsamplingRatio;
 
-        std::vector<Image> glyphImages = fontFinder.renderGlyphs(glyphSet, fontSize, padding, downsamplingRatio);
-        std::vector<Vec2<size_t>> imageSizes = sizes(glyphImages, downsamplingRatio);
-        Packing p = packingAlgos[packing](imageSizes.begin(), imageSizes.end(), false);
+        // collects the timing of all glyph loops from here on
+        std::unique_ptr<ScheduleReport> report;
+        if (scheduleReport) {
+            report.reset(new ScheduleReport);
+        }
 
         if (static_cast<bool>(*distfieldOpt)) {
-            Image atlas = distanceFieldAtlas(glyphImages.begin(), glyphImages.end(), p, dtAlgos[algorithm],
-                                             downsamplingAlgos[downsampling]);
-            atlas.exportPng<DistanceTransform::OutputType>(outPath, -dynamicRange[0], -dynamicRange[1]);
+            if (!*bitDepthOpt) {
+                bitDepth = DistanceTransform::bitDepth;
+            } else if (bitDepth == 1) {
+                throw std::runtime_error("distance field atlases have a bit depth of 8, 16 or 32");
+            }
+        } else if (!*bitDepthOpt) {
+            bitDepth = 1;
+        } else if (bitDepth > 8) {
+            throw std::runtime_error("font atlases have a bit depth of 1 or 8");
+        }
+
+        Packing p;
+        bool fromOutlines = static_cast<bool>(*distfieldOpt) && outlineDtAlgos.count(algorithm);
+        if (halfFloat) {
+            if (static_cast<bool>(*maxMemoryOpt)) {
+                throw std::runtime_error("--halffloat can not be streamed with --max-memory");
+            }
+            bitDepth = 16;
+        }
+        bool quantized = bitDepth < DistanceTransform::bitDepth;
+        if (quantized && fromOutlines) {
+            throw std::runtime_error("--bitdepth and --halffloat are not supported for distance fields from outlines");
+        }
+        if (static_cast<bool>(*maxMemoryOpt)) {
+            if (fromOutlines) {
+                throw std::runtime_error("--max-memory is not supported for distance fields from outlines");
+            }
+            // the glyph sizes are needed before rendering anyway
+            directRender = true;
+        }
+        if (parallelPages && directRender) {
+            throw std::runtime_error("--parallel-pages is not supported with --directrender or --max-memory");
+        }
+        Vec2<PackingSizeType> maxSize;
+        if (static_cast<bool>(*maxSizeOpt)) {
+            maxSize = parseSize(maxSizeArg);
+        }
+        auto pack = [&](const std::vector<Vec2<size_t>>& imageSizes) -> Packing {
+            if (!static_cast<bool>(*maxSizeOpt)) {
+                return packingAlgos[packing](imageSizes.begin(), imageSizes.end(), false);
+            }
+            Packing paged = pagedPackingAlgos[packing](imageSizes.begin(), imageSizes.end(), maxSize, false);
+            if (paged.rects.size() != imageSizes.size()) {
+                throw std::runtime_error("a glyph is larger than --max-size");
+            }
+            return paged;
+        };
+
+        bool antiAliased = static_cast<bool>(*distfieldOpt) && coverageDtAlgos.count(algorithm);
+        std::vector<GlyphOutline> glyphOutlines;
+        std::vector<Image> glyphImages;
+        std::vector<unsigned long> depictableGlyphs;
+        size_t maxGlyphPixels = 0;
+        if (fromOutlines) {
+            // the glyphs are never rendered, their distance fields are computed at the atlas resolution right away
+            glyphOutlines = fontFinder.loadOutlines(glyphSet, fontSize, padding, downsamplingRatio);
+            std::vector<Vec2<size_t>> imageSizes = sizes(glyphOutlines, downsamplingRatio);
+            p = pack(imageSizes);
+        } else if (directRender) {
+            // pack the glyph metrics first, then render each glyph straight into its place in the atlas
+            std::map<unsigned long, Vec2<size_t>> glyphSizes =
+                fontFinder.glyphSizes(glyphSet, fontSize, padding, downsamplingRatio, antiAliased);
+            std::vector<Vec2<size_t>> imageSizes;
+            for (const auto& glyphSize : glyphSizes) {
+                depictableGlyphs.push_back(glyphSize.first);
+                imageSizes.push_back(glyphSize.second / downsamplingRatio);
+                maxGlyphPixels = std::max(maxGlyphPixels, glyphSize.second.x * glyphSize.second.y);
+            }
+            p = pack(imageSizes);
         } else {
-            Image atlas = fontAtlas(glyphImages.begin(), glyphImages.end(), p);
-            atlas.exportPng<uint8_t>(outPath);
+            glyphImages = parallelRender
+                              ? fontFinder.renderGlyphsParallel(glyphSet, fontSize, padding, downsamplingRatio,
+                                                                antiAliased)
+                              : fontFinder.renderGlyphs(glyphSet, fontSize, padding, downsamplingRatio, antiAliased);
+            std::vector<Vec2<size_t>> imageSizes = sizes(glyphImages, downsamplingRatio);
+            p = pack(imageSizes);
+        }
+
+        if (!p.strategy.empty()) {
+            std::cout << "Packing strategy: " << p.strategy << std::endl;
+        }
+
+        size_t pageCount = p.pageCount();
+        std::vector<std::string> pagePaths;
+        for (size_t page = 0; page < pageCount; page++) {
+            pagePaths.push_back(pageCount == 1 ? outPath : pagePath(outPath, page));
+        }
+
+        // Each page is an atlas of its own, made of the glyphs packed onto it.
+        auto generatePage = [&](size_t page) {
+            std::vector<size_t> indices = p.rectsOnPage(page);
+            Packing pagePacking = pageCount == 1 ? p : p.page(page);
+            const std::string& atlasPath = pagePaths[page];
+
+            if (fromOutlines) {
+                std::vector<GlyphOutline> outlines = takeItems(glyphOutlines, indices);
+                auto bandLimit = static_cast<DistanceTransform::OutputType>(
+                    std::max(std::abs(dynamicRange[0]), std::abs(dynamicRange[1])));
+                size_t channelCount = outlineDtAlgos[algorithm];
+                if (channelCount == 1) {
+                    Image atlas = outlineDistanceFieldAtlas(outlines.begin(), outlines.end(), pagePacking, bandLimit);
+                    atlas.exportPng<DistanceTransform::OutputType>(atlasPath, -dynamicRange[0], -dynamicRange[1]);
+                } else {
+                    std::vector<Image> atlas = multiChannelDistanceFieldAtlas(outlines.begin(), outlines.end(),
+                                                                              pagePacking, channelCount, bandLimit);
+                    Image::exportMultiChannelPng<DistanceTransform::OutputType>(atlasPath, atlas, -dynamicRange[0],
+                                                                               -dynamicRange[1]);
+                }
+                return;
+            }
+
+            std::vector<Image> pageImages;
+            GlyphRenderer renderer;
+            GlyphChunkRenderer chunkRenderer;
+            if (directRender) {
+                std::vector<unsigned long> pageGlyphs;
+                // the largest glyphs are rendered first, such that no thread is left with a big one at the end
+                std::vector<size_t> areas;
+                for (size_t i : indices) {
+                    pageGlyphs.push_back(depictableGlyphs[i]);
+                    areas.push_back(p.rects[i].size.x * p.rects[i].size.y);
+                }
+                renderer = [&, pageGlyphs, areas](const std::function<void(size_t, Image&)>& consumer) {
+                    fontFinder.renderGlyphs(pageGlyphs, fontSize, padding, downsamplingRatio, antiAliased, consumer,
+                                            areas);
+                };
+                chunkRenderer = [&, pageGlyphs, areas](const std::vector<size_t>& chunkIndices,
+                                                       const std::function<void(size_t, Image&)>& consumer) {
+                    std::vector<unsigned long> chunk;
+                    std::vector<size_t> chunkAreas;
+                    for (size_t i : chunkIndices) {
+                        chunk.push_back(pageGlyphs[i]);
+                        chunkAreas.push_back(areas[i]);
+                    }
+                    fontFinder.renderGlyphs(chunk, fontSize, padding, downsamplingRatio, antiAliased,
+                                            [&](size_t i, Image& glyph) { consumer(chunkIndices[i], glyph); },
+                                            chunkAreas);
+                };
+            } else {
+                pageImages = takeItems(glyphImages, indices);
+            }
+
+            if (static_cast<bool>(*distfieldOpt)) {
+                DistanceTransform::OutputType bandLimit = DistanceTransform::backgroundVal;
+                if (bandPreservingDownsamplingAlgos.count(downsampling)) {
+                    bandLimit = static_cast<DistanceTransform::OutputType>(
+                        std::max(std::abs(dynamicRange[0]), std::abs(dynamicRange[1])));
+                }
+                ImageTransform distanceTransform = dtAlgos[algorithm](bandLimit);
+
+                bool fusedDownsampling = downsampling == "center" && centerSamplingDtAlgos.count(algorithm);
+                ImageTransform downSampling = downsamplingAlgos[downsampling];
+                if (static_cast<bool>(*maxMemoryOpt)) {
+                    // generous estimate of the glyph canvas, distance field and transform buffers per pixel
+                    size_t glyphBytes = maxGlyphPixels * (antiAliased ? 56 : 24);
+                    size_t bandHeight = streamingBandHeight(pagePacking, glyphBytes, maxMemory << 20);
+                    if (bandHeight == 0) {
+                        throw std::runtime_error("--max-memory is too small for the atlas width and glyph size");
+                    }
+                    PngRowWriter writer(atlasPath, pagePacking.atlasSize.x, pagePacking.atlasSize.y,
+                                        static_cast<uint8_t>(bitDepth));
+                    auto writeRows = [&](const Image& rows) {
+                        if (!quantized) {
+                            writer.writeRows<DistanceTransform::OutputType>(rows, -dynamicRange[0], -dynamicRange[1]);
+                            return;
+                        }
+                        Image quantizedRows{rows.getWidth(), rows.getHeight(), bitDepth};
+                        quantizedRows.quantize<DistanceTransform::OutputType>(rows, -dynamicRange[0],
+                                                                              -dynamicRange[1]);
+                        writer.writeRows<uint8_t>(quantizedRows);
+                    };
+                    if (fusedDownsampling) {
+                        streamDistanceFieldAtlas(chunkRenderer, pagePacking, distanceTransform, bandHeight, writeRows);
+                    } else {
+                        streamDistanceFieldAtlas(chunkRenderer, pagePacking, distanceTransform, downSampling,
+                                                 bandHeight, writeRows);
+                    }
+                    writer.finish();
+                } else if (quantized) {
+                    // the distances are quantized per glyph, the atlas never exists as floats
+                    Quantization quantization{static_cast<uint8_t>(bitDepth),
+                                              static_cast<DistanceTransform::OutputType>(-dynamicRange[0]),
+                                              static_cast<DistanceTransform::OutputType>(-dynamicRange[1]),
+                                              halfFloat};
+                    Image atlas =
+                        directRender
+                            ? (fusedDownsampling ? distanceFieldAtlas(renderer, pagePacking, distanceTransform,
+                                                                      quantization)
+                                                 : distanceFieldAtlas(renderer, pagePacking, distanceTransform,
+                                                                      downSampling, quantization))
+                            : (fusedDownsampling ? distanceFieldAtlas(pageImages.begin(), pageImages.end(),
+                                                                      pagePacking, distanceTransform, quantization)
+                                                 : distanceFieldAtlas(pageImages.begin(), pageImages.end(),
+                                                                      pagePacking, distanceTransform, downSampling,
+                                                                      quantization));
+                    if (!halfFloat) {
+                        atlas.exportPng<uint8_t>(atlasPath);
+                    } else if (atlasPath.substr(atlasPath.length() - 4) == ".raw") {
+                        atlas.exportRaw(atlasPath);
+                    } else {
+                        atlas.exportKtx<Half>(atlasPath);
+                    }
+                } else {
+                    Image atlas =
+                        directRender
+                            ? (fusedDownsampling
+                                   ? distanceFieldAtlas(renderer, pagePacking, distanceTransform)
+                                   : distanceFieldAtlas(renderer, pagePacking, distanceTransform, downSampling))
+                            : (fusedDownsampling ? distanceFieldAtlas(pageImages.begin(), pageImages.end(),
+                                                                      pagePacking, distanceTransform)
+                                                 : distanceFieldAtlas(pageImages.begin(), pageImages.end(),
+                                                                      pagePacking, distanceTransform, downSampling));
+                    atlas.exportPng<DistanceTransform::OutputType>(atlasPath, -dynamicRange[0], -dynamicRange[1]);
+                }
+            } else {
+                auto atlasBitDepth = static_cast<uint8_t>(bitDepth);
+                Image atlas = directRender
+                                  ? fontAtlas(renderer, pagePacking, atlasBitDepth)
+                                  : fontAtlas(pageImages.begin(), pageImages.end(), pagePacking, atlasBitDepth);
+                atlas.exportPng<uint8_t>(atlasPath);
+            }
+        };
+
+        // the pages share no glyphs (direct rendering would share the font face, see above)
+        std::vector<std::exception_ptr> pageErrors(pageCount);
+#pragma omp parallel for schedule(dynamic, 1) if (parallelPages)
+        for (long page = 0; page < static_cast<long>(pageCount); page++) {
+            try {
+                generatePage(static_cast<size_t>(page));
+            } catch (...) {
+                // exceptions must not leave the parallel region
+                pageErrors[page] = std::current_exception();
+            }
+        }
+        for (const auto& error : pageErrors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        if (report) {
+            std::cerr << report->summary();
         }
 
         if (createFnt) {
             std::string faceName = static_cast<bool>(*fontNameOpt) ? fontName : "Unknown";
             FntWriter writer{fontFinder.fontFace, faceName, fontSize, downsamplingRatio > 1 ? 1.f / float(downsamplingRatio) : 1.0f, (float)padding};
-            writer.setAtlasProperties(p.atlasSize);
+            std::vector<std::string> pageFiles;
+            for (const std::string& path : pagePaths) {
+                pageFiles.push_back(fileName(path));
+            }
+            writer.setAtlasProperties(p.atlasSize, pageFiles);
+            if (fromOutlines && outlineDtAlgos[algorithm] == 3) {
+                writer.setChannels(7);  // red, green and blue, the alpha channel is opaque
+            }
             writer.readFont(glyphSet.begin(), glyphSet.end());
 
             std::set<FT_ULong> charsWithoutRect = fontFinder.nonDepictableChars;
             bool charIsDepictable = true;
             auto rectIt = p.rects.begin();
             for (auto gIt = glyphSet.begin(); gIt != glyphSet.end(); gIt++) {
-                charIsDepictable = writer.setCharInfo(static_cast<FT_ULong>(*gIt), *rectIt, charsWithoutRect);
+                if (FT_Get_Char_Index(fontFinder.fontFace, static_cast<FT_ULong>(*gIt)) == 0) {
+                    continue;  // not in the font, neither rendered nor packed
+                }
+                size_t rectIndex = rectIt - p.rects.begin();
+                int page = p.pages.empty() ? 0 : static_cast<int>(p.pages[rectIndex]);
+                charIsDepictable =
+                    writer.setCharInfo(static_cast<FT_ULong>(*gIt), *rectIt, charsWithoutRect, page);
                 if (charIsDepictable) {
                     ++rectIt;
                 }
@@ -205,14 +529,21 @@ int parseDistfieldArgs(int argc, char** argv) {
     CLI11_PARSE(app, argc, argv);
 
     Image input = Image(imgPath);
-    if (input.getBitDepth() != 1) {
+    if (coverageDtAlgos.count(algorithm)) {
+        if (input.getBitDepth() > 8) {
+            std::cerr << "Error: only grayscale images with a bit depth of up to 8 are supported." << std::endl;
+            return 2;
+        }
+    } else if (input.getBitDepth() != 1) {
         std::cerr << "Error: only black/white images are supported. Please use an image with a bit depth of 1."
                   << std::endl;
         return 2;
     }
 
     Image output = Image(input.getWidth(), input.getHeight(), DistanceTransform::bitDepth);
-    dtAlgos[algorithm](input, output);
+    auto bandLimit = static_cast<DistanceTransform::OutputType>(
+        std::max(std::abs(dynamicRange[0]), std::abs(dynamicRange[1])));
+    dtAlgos[algorithm](bandLimit)(input, output);
     output.exportPng<DistanceTransform::OutputType>(outPath, dynamicRange[1], dynamicRange[0]);
     return 0;
 }
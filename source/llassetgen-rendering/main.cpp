@@ -514,6 +514,19 @@ class Window : public WindowQt {
                     pack = llassetgen::shelfPackAtlas(imageSizes.begin(), imageSizes.end(), false);
                     break;
                 }
+                case 2: {
+                    pack = llassetgen::skylinePackAtlas(imageSizes.begin(), imageSizes.end(), false);
+                    break;
+                }
+                case 3: {
+                    pack = llassetgen::guillotinePackAtlas(imageSizes.begin(), imageSizes.end(), false);
+                    break;
+                }
+                case 4: {
+                    pack = llassetgen::autoPackAtlas(imageSizes.begin(), imageSizes.end(), false);
+                    std::cout << "Packing Strategy: " << pack.strategy << std::endl;
+                    break;
+                }
                 default:
                 case 1: {
                     pack = llassetgen::maxRectsPackAtlas(imageSizes.begin(), imageSizes.end(), false);
@@ -721,6 +734,9 @@ void setupGUI(QMainWindow* window) {
     // item order is important
     packComboBox->addItem("Shelf");
     packComboBox->addItem("Max Rects");
+    packComboBox->addItem("Skyline");
+    packComboBox->addItem("Guillotine");
+    packComboBox->addItem("Auto");
     packComboBox->setCurrentIndex(1);
     QObject::connect(packComboBox, SIGNAL(currentIndexChanged(int)), glwindow, SLOT(packingAlgoChanged(int)));
     acLayout->addRow("Packing:", packComboBox);
@@ -1,11 +1,28 @@
 #pragma once
 
+#include <functional>
+
 #include <llassetgen/DistanceTransform.h>
 #include <llassetgen/Image.h>
+#include <llassetgen/Outline.h>
 #include <llassetgen/Packing.h>
+#include <llassetgen/Schedule.h>
+#include <llassetgen/llassetgen_api.h>
 
 namespace llassetgen {
-    using ImageTransform = void (*)(Image&, Image&);
+    using ImageTransform = std::function<void(Image&, Image&)>;
+    /*
+     * Renders the glyphs of a Packing one by one and passes each to the given consumer together with the index of
+     * its Rect, e.g. a bound FontFinder::renderGlyphs. The consumer may be called concurrently for different glyphs,
+     * the glyph image is only valid during the call. The renderer chooses the order, passing the Rect areas as
+     * costs to FontFinder::renderGlyphs balances the threads best.
+     */
+    using GlyphRenderer = std::function<void(const std::function<void(size_t, Image&)>&)>;
+    /*
+     * Like GlyphRenderer, but only renders the glyphs of the given Rect indices.
+     */
+    using GlyphChunkRenderer =
+        std::function<void(const std::vector<size_t>&, const std::function<void(size_t, Image&)>&)>;
 
     namespace internal {
         template <class Iter>
@@ -18,20 +35,112 @@ namespace llassetgen {
                           "Input iterator must be a RandomAccessIterator");
             return 0;
         }
-    }    template <class ImageIter>
+
+        /*
+         * The pixel areas of the Rects, as costs for scheduleLargestFirst.
+         */
+        inline std::vector<size_t> rectAreas(const Packing& packing) {
+            std::vector<size_t> areas;
+            areas.reserve(packing.rects.size());
+            for (const auto& rect : packing.rects) {
+                areas.push_back(rect.size.x * rect.size.y);
+            }
+            return areas;
+        }
+
+        template <class ImageIter>
+        std::vector<size_t> imageAreas(ImageIter imgBegin, ImageIter imgEnd) {
+            std::vector<size_t> areas;
+            for (ImageIter it = imgBegin; it != imgEnd; ++it) {
+                areas.push_back(it->getWidth() * it->getHeight());
+            }
+            return areas;
+        }
+
+        template <class ImageIter>
+        void transformIntoAtlas(ImageIter imgBegin, ImageIter imgEnd, const Packing& packing, Image& atlas,
+                                const ImageTransform& distanceTransform, const ImageTransform& downSampling) {
+            checkImageIteratorType<ImageIter>();
+            assert(static_cast<size_t>(std::distance(imgBegin, imgEnd)) == packing.rects.size());
+
+            // the distance transform at the glyph resolution dominates
+            scheduleLargestFirst(imageAreas(imgBegin, imgEnd), [&](size_t i) {
+                auto& imgInput = imgBegin[i];
+                Image distField =
+                    DistanceTransformWorkspace::local().distanceField(imgInput.getWidth(), imgInput.getHeight());
+                distanceTransform(imgInput, distField);
+
+                auto& rect = packing.rects[i];
+                Image output = atlas.view(rect.position, rect.position + rect.size);
+                downSampling(output, distField);
+            });
+        }
+
+        template <class ImageIter>
+        void transformIntoAtlas(ImageIter imgBegin, ImageIter imgEnd, const Packing& packing, Image& atlas,
+                                const ImageTransform& distanceTransform) {
+            checkImageIteratorType<ImageIter>();
+            assert(static_cast<size_t>(std::distance(imgBegin, imgEnd)) == packing.rects.size());
+
+            scheduleLargestFirst(imageAreas(imgBegin, imgEnd), [&](size_t i) {
+                auto& rect = packing.rects[i];
+                Image output = atlas.view(rect.position, rect.position + rect.size);
+                distanceTransform(imgBegin[i], output);
+            });
+        }
+    }
+
+    /*
+     * Store a distance field atlas with 8 or 16 bits per pixel instead of floats: the distances of each glyph are
+     * mapped from [black, white] to the full range of `bitDepth` as soon as they are written into the atlas (see
+     * Image::quantize), so exporting the atlas is a plain copy of its rows. At 16 bits, the exported PNG is the same
+     * as exportPng of the float atlas with the same black and white.
+     *
+     * With `halfFloat` (and a bit depth of 16), the distances are stored unchanged as Half instead, keeping their
+     * sign and sub-pixel precision outside of [black, white] (which are ignored then).
+     */
+    struct LLASSETGEN_API Quantization {
+        uint8_t bitDepth;
+        DistanceTransform::OutputType black, white;
+        bool halfFloat;
+
+        /*
+         * An atlas of the given size, filled with the quantized background value.
+         */
+        Image atlas(Vec2<size_t> size) const;
+        /*
+         * Quantize the float `distances` into `output` of the same size.
+         */
+        void store(const Image& distances, const Image& output) const;
+        /*
+         * Wrap a distance transform (input, output) or a downsampling (output, input) which writes distances, such
+         * that it writes them into a float image of the workspace (DistanceTransformWorkspace::sampledField) first
+         * and then quantizes them into its output.
+         */
+        ImageTransform distanceTransform(ImageTransform transform) const;
+        ImageTransform downSampling(ImageTransform downSampling) const;
+    };
+
+    /*
+     * Copy the glyph images into an atlas of `bitDepth` bits per pixel, either the bit depth of the images or 8 for
+     * packed images (the glyph pixels are scaled to 255 then). The glyphs are copied in parallel, Image::copyDataFrom
+     * merges the bytes which neighbouring glyphs share in packed atlases atomically.
+     *
+     * All atlas functions hand out the glyphs to the threads one by one, largest first (see scheduleLargestFirst).
+     */
+    template <class ImageIter>
     Image fontAtlas(ImageIter imgBegin, ImageIter imgEnd, Packing packing, uint8_t bitDepth = 1) {
-        using DiffType = typename std::iterator_traits<ImageIter>::difference_type;
-        assert(std::distance(imgBegin, imgEnd) == static_cast<DiffType>(packing.rects.size()));
+        assert(static_cast<size_t>(std::distance(imgBegin, imgEnd)) == packing.rects.size());
+        static_cast<void>(imgEnd);  // only needed for the assertion
 
         Image atlas{packing.atlasSize.x, packing.atlasSize.y, bitDepth};
         atlas.clear();
 
-#pragma omp parallel for
-        for (int i = 0; i < std::distance(imgBegin, imgEnd); i++) {
+        scheduleLargestFirst(internal::rectAreas(packing), [&](size_t i) {
             auto& rect = packing.rects[i];
             Image view = atlas.view(rect.position, rect.position + rect.size);
             view.copyDataFrom(imgBegin[i]);
-        }
+        });
         return atlas;
     }
 
@@ -40,30 +149,140 @@ namespace llassetgen {
      * size, the Image will be downsampled in the returned atlas. The downsampling ratio is determined by
      * dividing the Image's size by its Rect's size. Only integer ratios are allowed: if the division
      * has a remainder, an error will occur.
+     *
+     * The distance fields of the glyphs are computed in the DistanceTransformWorkspace of each thread.
      */
     template <class ImageIter>
     Image distanceFieldAtlas(ImageIter imgBegin, ImageIter imgEnd, Packing packing, ImageTransform distanceTransform,
                              ImageTransform downSampling) {
-        internal::checkImageIteratorType<ImageIter>();
-        using DiffType = typename std::iterator_traits<ImageIter>::difference_type;
-        assert(std::distance(imgBegin, imgEnd) == static_cast<DiffType>(packing.rects.size()));
+        Image atlas{packing.atlasSize.x, packing.atlasSize.y, DistanceTransform::bitDepth};
+        atlas.fillRect({0, 0}, atlas.getSize(), DistanceTransform::backgroundVal);
+        internal::transformIntoAtlas(imgBegin, imgEnd, packing, atlas, distanceTransform, downSampling);
+        return atlas;
+    }
+
+    template <class ImageIter>
+    Image distanceFieldAtlas(ImageIter imgBegin, ImageIter imgEnd, Packing packing, ImageTransform distanceTransform,
+                             ImageTransform downSampling, const Quantization& quantization) {
+        Image atlas = quantization.atlas(packing.atlasSize);
+        internal::transformIntoAtlas(imgBegin, imgEnd, packing, atlas, distanceTransform,
+                                     quantization.downSampling(downSampling));
+        return atlas;
+    }
 
+    /*
+     * Like distanceFieldAtlas above, but the distance transform writes directly into the atlas, i.e. it has to
+     * accept an output that is smaller than its input and do the downsampling itself (e.g. ParabolaEnvelope, which
+     * samples the centers). This skips the full resolution distance field of each glyph.
+     */
+    template <class ImageIter>
+    Image distanceFieldAtlas(ImageIter imgBegin, ImageIter imgEnd, Packing packing, ImageTransform distanceTransform) {
         Image atlas{packing.atlasSize.x, packing.atlasSize.y, DistanceTransform::bitDepth};
         atlas.fillRect({0, 0}, atlas.getSize(), DistanceTransform::backgroundVal);
+        internal::transformIntoAtlas(imgBegin, imgEnd, packing, atlas, distanceTransform);
+        return atlas;
+    }
+
+    template <class ImageIter>
+    Image distanceFieldAtlas(ImageIter imgBegin, ImageIter imgEnd, Packing packing, ImageTransform distanceTransform,
+                             const Quantization& quantization) {
+        Image atlas = quantization.atlas(packing.atlasSize);
+        internal::transformIntoAtlas(imgBegin, imgEnd, packing, atlas,
+                                     quantization.distanceTransform(distanceTransform));
+        return atlas;
+    }
+
+    /*
+     * The atlases above for glyphs that are rendered on demand instead of kept in memory: only the atlas and one
+     * glyph (and its distance field) per thread are held at a time. The output is the same as when the rendered
+     * images are passed in the order of their Rects.
+     */
+    LLASSETGEN_API Image fontAtlas(const GlyphRenderer& renderGlyphs, Packing packing, uint8_t bitDepth = 1);
+    LLASSETGEN_API Image distanceFieldAtlas(const GlyphRenderer& renderGlyphs, Packing packing,
+                                            ImageTransform distanceTransform, ImageTransform downSampling);
+    LLASSETGEN_API Image distanceFieldAtlas(const GlyphRenderer& renderGlyphs, Packing packing,
+                                            ImageTransform distanceTransform);
+    LLASSETGEN_API Image distanceFieldAtlas(const GlyphRenderer& renderGlyphs, Packing packing,
+                                            ImageTransform distanceTransform, ImageTransform downSampling,
+                                            const Quantization& quantization);
+    LLASSETGEN_API Image distanceFieldAtlas(const GlyphRenderer& renderGlyphs, Packing packing,
+                                            ImageTransform distanceTransform, const Quantization& quantization);
+
+    /*
+     * Streaming variants of the distanceFieldAtlas functions above for atlases that do not fit into memory. The
+     * atlas is produced in bands of `bandHeight` rows from top to bottom: the glyphs are rendered in chunks ordered
+     * by the top of their Rect, and each band is passed to `writeRows` as soon as no glyph can touch it anymore.
+     * Only one band plus the height of the tallest Rect is held at a time.
+     */
+    LLASSETGEN_API void streamDistanceFieldAtlas(const GlyphChunkRenderer& renderGlyphs, Packing packing,
+                                                 ImageTransform distanceTransform, ImageTransform downSampling,
+                                                 size_t bandHeight, const std::function<void(const Image&)>& writeRows);
+    LLASSETGEN_API void streamDistanceFieldAtlas(const GlyphChunkRenderer& renderGlyphs, Packing packing,
+                                                 ImageTransform distanceTransform, size_t bandHeight,
+                                                 const std::function<void(const Image&)>& writeRows);
+    /*
+     * The largest band height for streamDistanceFieldAtlas such that the bands together with the glyph buffers of
+     * all threads (`glyphBytes` each) fit into `maxMemory` bytes, or 0 if not even a single row fits.
+     */
+    LLASSETGEN_API size_t streamingBandHeight(const Packing& packing, size_t glyphBytes, size_t maxMemory);
 
-        const int max = std::distance(imgBegin, imgEnd);
-#pragma omp parallel for
-        for (int i = 0; i < max; i++) {
-            auto& imgInput = imgBegin[i];
-            Image distField{imgInput.getWidth(), imgInput.getHeight(), DistanceTransform::bitDepth};
-            distanceTransform(imgInput, distField);
+    /*
+     * Distance field atlas computed from the glyph outlines instead of rendered images, directly at the resolution
+     * of the atlas. The ratio between a GlyphOutline's size and its Rect's size is the downsampling ratio, distances
+     * stay in the units of the outline (i.e. pixels of the font size), like with the image based atlas. Only the
+     * distances up to `bandLimit` are computed exactly, see OutlineDistanceField.
+     */
+    template <class GlyphIter>
+    Image outlineDistanceFieldAtlas(GlyphIter glyphBegin, GlyphIter glyphEnd, Packing packing,
+                                    DistanceTransform::OutputType bandLimit = DistanceTransform::backgroundVal) {
+        assert(static_cast<size_t>(std::distance(glyphBegin, glyphEnd)) == packing.rects.size());
+        static_cast<void>(glyphEnd);  // only needed for the assertion
 
+        Image atlas{packing.atlasSize.x, packing.atlasSize.y, DistanceTransform::bitDepth};
+        atlas.fillRect({0, 0}, atlas.getSize(), DistanceTransform::backgroundVal);
+
+        scheduleLargestFirst(internal::rectAreas(packing), [&](size_t i) {
+            const GlyphOutline& glyph = glyphBegin[i];
             auto& rect = packing.rects[i];
             Image output = atlas.view(rect.position, rect.position + rect.size);
-            downSampling(output, distField);
+            double scale = static_cast<double>(glyph.size.x) / rect.size.x;
+            OutlineDistanceField(glyph.outline, bandLimit).render(output, glyph.origin, scale);
+        });
+
+        return atlas;
+    }
+
+    /*
+     * Multi-channel distance field atlas computed from the glyph outlines, like outlineDistanceFieldAtlas. Returns
+     * the red, green and blue channel atlases and, if `channelCount` is 4, the true distance field as alpha channel.
+     */
+    template <class GlyphIter>
+    std::vector<Image> multiChannelDistanceFieldAtlas(
+        GlyphIter glyphBegin, GlyphIter glyphEnd, Packing packing, size_t channelCount = 3,
+        DistanceTransform::OutputType bandLimit = DistanceTransform::backgroundVal) {
+        assert(static_cast<size_t>(std::distance(glyphBegin, glyphEnd)) == packing.rects.size());
+        static_cast<void>(glyphEnd);  // only needed for the assertion
+        assert(channelCount == 3 || channelCount == 4);
+
+        std::vector<Image> atlas;
+        for (size_t c = 0; c < channelCount; c++) {
+            atlas.push_back(Image{packing.atlasSize.x, packing.atlasSize.y, DistanceTransform::bitDepth});
+            atlas.back().fillRect({0, 0}, atlas.back().getSize(), DistanceTransform::backgroundVal);
         }
 
+        scheduleLargestFirst(internal::rectAreas(packing), [&](size_t i) {
+            const GlyphOutline& glyph = glyphBegin[i];
+            auto& rect = packing.rects[i];
+            Vec2<size_t> end = rect.position + rect.size;
+            Image trueDistance = channelCount == 4 ? atlas[3].view(rect.position, end)
+                                                   : DistanceTransformWorkspace::local().distanceField(rect.size.x,
+                                                                                                       rect.size.y);
+            double scale = static_cast<double>(glyph.size.x) / rect.size.x;
+            MultiChannelDistanceField(glyph.outline, bandLimit)
+                .render(atlas[0].view(rect.position, end), atlas[1].view(rect.position, end),
+                        atlas[2].view(rect.position, end), trueDistance, glyph.origin, scale);
+        });
+
         return atlas;
     }
 }
-
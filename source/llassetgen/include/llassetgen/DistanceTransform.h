@@ -2,9 +2,82 @@
 
 #include <llassetgen/Geometry.h>
 #include <llassetgen/Image.h>
+#include <llassetgen/ImageView.h>
 #include <llassetgen/llassetgen_api.h>
 
 namespace llassetgen {
+    /*
+     * Scratch memory of the distance transforms and the distance field of a glyph, kept per thread and reused
+     * across calls. Every buffer only grows, so after the largest glyph has been processed once, no more allocations
+     * happen on that thread. Pointers and views returned by a workspace stay valid until the same buffer is
+     * requested again with a larger size or the workspace is released.
+     */
+    class LLASSETGEN_API DistanceTransformWorkspace {
+       public:
+        enum Buffer {
+            InputBuffer,
+            ColumnBuffer,
+            LineBuffer,
+            Parabolas,
+            Positions,
+            Progress,
+            SimdLines,
+            SimdSignMasks,
+            SimdApexes,
+            SimdBegins,
+            SimdValues,
+            SampledRows,
+            Coverage,
+            GradientX,
+            GradientY,
+            OffsetX,
+            OffsetY,
+            Outside,
+            Inside,
+            BufferCount
+        };
+
+       private:
+        std::unique_ptr<uint8_t[]> buffers[BufferCount];
+        size_t capacities[BufferCount] = {};
+        Image field;
+        Image sampled;
+        Image canvas;
+
+        void* reserve(Buffer buffer, size_t bytes);
+
+       public:
+        DistanceTransformWorkspace();
+
+        /*
+         * The workspace of the calling thread.
+         */
+        static DistanceTransformWorkspace& local();
+
+        template <typename T>
+        T* get(Buffer buffer, size_t count) {
+            return static_cast<T*>(reserve(buffer, count * sizeof(T)));
+        }
+
+        /*
+         * A float image of the given size to transform a glyph into.
+         */
+        Image distanceField(size_t width, size_t height);
+
+        /*
+         * A second float image, for the distance field of a glyph at the resolution of the atlas (e.g. before it
+         * is quantized).
+         */
+        Image sampledField(size_t width, size_t height);
+
+        /*
+         * An image of the given size and bit depth to render a glyph into.
+         */
+        Image glyphCanvas(size_t width, size_t height, size_t bitDepth);
+
+        void release();
+    };
+
     class LLASSETGEN_API DistanceTransform {
        public:
         using DimensionType = size_t;
@@ -15,45 +88,105 @@ namespace llassetgen {
         static constexpr OutputType backgroundVal = std::numeric_limits<OutputType>::infinity();
 
        protected:
-        template <typename PixelType, bool flipped = false, bool invalidBounds = false>
-        LLASSETGEN_NO_EXPORT PixelType getPixel(PositionType pos);
-        template <typename PixelType, bool flipped = false>
-        LLASSETGEN_NO_EXPORT void setPixel(PositionType pos, PixelType value);
+        OutputType bandLimit = backgroundVal;
 
        public:
         const Image& input;
         const Image& output;
         DistanceTransform(const Image& _input, const Image& _output);
         LLASSETGEN_NO_EXPORT virtual void transform() = 0;
+
+        /*
+         * Only distances up to `limit` (in absolute value) are needed, e.g. because the result is clamped to a dynamic
+         * range afterwards. Larger distances may then be replaced by +/- `limit` without computing them exactly.
+         */
+        void setBandLimit(OutputType limit);
     };
 
     class LLASSETGEN_API DeadReckoning : public DistanceTransform {
-        std::unique_ptr<PositionType[]> posBuffer;
+        PositionType* posBuffer = nullptr;
 
         LLASSETGEN_NO_EXPORT PositionType& posAt(PositionType pos);
-        LLASSETGEN_NO_EXPORT void transformAt(PositionType pos, PositionType target, OutputType distance);
+        LLASSETGEN_NO_EXPORT void transformAt(const ImageView<OutputType>& distances, PositionType pos,
+                                             PositionType target, OutputType distance);
 
        public:
         DeadReckoning(const Image& _input, const Image& _output) : DistanceTransform(_input, _output) {}
         void transform();
     };
 
+    /*
+     * Anti-aliased Euclidean distance transform (edtaa3, GUSTAVSON and STRAND 2011). The input may be a grayscale
+     * coverage image (up to 8 bit, e.g. an anti-aliased FreeType render); the coverage of the edge pixels is used to
+     * estimate the sub-pixel position of the edge. This gives smooth distance fields from renders at much lower
+     * resolutions than the binary transforms need.
+     */
+    class LLASSETGEN_API AntiAliasedEuclidean : public DistanceTransform {
+       public:
+        AntiAliasedEuclidean(const Image& _input, const Image& _output) : DistanceTransform(_input, _output) {}
+        void transform();
+    };
+
+    /*
+     * The output may be smaller than the input by an integer ratio. Then the distance field is center downsampled
+     * (same result as Image::centerDownsampling of the full size distance field), but the row pass is only evaluated
+     * at the sample points.
+     */
     class LLASSETGEN_API ParabolaEnvelope : public DistanceTransform {
+        DimensionType columnBlockWidth;
+
+        LLASSETGEN_NO_EXPORT void transformColumns(const InputType* inputBuffer, OutputType* rows,
+                                                   DimensionType rowPitch, DimensionType rowStep);
+        LLASSETGEN_NO_EXPORT void transformSampled(const InputType* inputBuffer);
+
+       protected:
         struct Parabola {
             DimensionType apex;
             OutputType begin;
             OutputType value;
         };
-        std::unique_ptr<Parabola[]> parabolas;
-        std::unique_ptr<OutputType[]> lineBuffer;
 
-        template <bool flipped, bool fill>
-        LLASSETGEN_NO_EXPORT void edgeDetection(DimensionType offset, DimensionType length);
-        template <bool flipped>
-        LLASSETGEN_NO_EXPORT void transformLine(DimensionType offset, DimensionType length);
+        template <bool fill>
+        LLASSETGEN_NO_EXPORT void edgeDetection(const InputType* inputLine, DimensionType inputStride,
+                                                OutputType* outputLine, DimensionType length);
+        LLASSETGEN_NO_EXPORT void transformLine(const InputType* inputLine, OutputType* outputLine,
+                                                DimensionType length, Parabola* parabolas, DimensionType sampleStep,
+                                                OutputType* samples);
+        LLASSETGEN_NO_EXPORT void transformLineInBand(const InputType* inputLine, OutputType* outputLine,
+                                                      DimensionType length, Parabola* parabolas,
+                                                      DimensionType sampleStep, OutputType* samples);
+        LLASSETGEN_NO_EXPORT virtual void transformRows(const InputType* inputBuffer);
 
        public:
-        ParabolaEnvelope(const Image& _input, const Image& _output) : DistanceTransform(_input, _output) {}
+        /*
+         * The column pass transposes blocks of `columnBlockWidth` columns into contiguous lines, so that it reads and
+         * writes whole cache lines per image row. A block width of 1 processes the columns one by one.
+         */
+        static constexpr DimensionType defaultColumnBlockWidth = 16;
+
+        ParabolaEnvelope(const Image& _input, const Image& _output,
+                         DimensionType _columnBlockWidth = defaultColumnBlockWidth)
+            : DistanceTransform(_input, _output), columnBlockWidth(_columnBlockWidth) {}
         void transform();
     };
+
+    /*
+     * ParabolaEnvelope that computes the lower envelopes of the row pass for several rows at once, one row per SIMD
+     * lane (8 lanes with AVX2, 4 with SSE4.1). The instruction set is chosen at runtime, if neither is available the
+     * scalar row pass is used, as well as for downsampled outputs and with a band limit. The results are identical to
+     * those of the ParabolaEnvelope.
+     */
+    class LLASSETGEN_API SimdParabolaEnvelope : public ParabolaEnvelope {
+        LLASSETGEN_NO_EXPORT void transformRows(const InputType* inputBuffer) override;
+
+       public:
+        /*
+         * Number of rows processed at once on this machine, 1 if the scalar fallback is used.
+         */
+        static DimensionType laneCount();
+
+        SimdParabolaEnvelope(const Image& _input, const Image& _output,
+                             DimensionType _columnBlockWidth = defaultColumnBlockWidth)
+            : ParabolaEnvelope(_input, _output, _columnBlockWidth) {}
+    };
 }
@@ -74,9 +74,22 @@ namespace llassetgen {
         FntWriter(FT_Face face, std::string faceName, unsigned int fontSize, float scalingFactor, float padding);
         void readFont(std::set<FT_ULong>::iterator charcodesBegin, std::set<FT_ULong>::iterator charcodesEnd);
         void setAtlasProperties(Vec2<PackingSizeType> size);
+        /*
+         * For atlases with several pages: the size of each page and the file names of the page textures, relative to
+         * the .fnt file. Without page files, the single page is expected in "<faceName>.png".
+         */
+        void setAtlasProperties(Vec2<PackingSizeType> size, std::vector<std::string> pageFiles);
+        /*
+         * The `chnl` bit mask of the atlas texture channels holding the glyphs (1 blue, 2 green, 4 red, 8 alpha),
+         * e.g. 7 for an RGB multi-channel distance field. Defaults to 15 (all channels), as for a grayscale atlas.
+         * Applies to the chars set afterwards.
+         */
+        void setChannels(uint8_t channels);
         void saveFnt(std::string filepath);
-        void setCharInfo(FT_ULong charcode, Rect<PackingSizeType> charArea);
-        bool setCharInfo(FT_ULong charcode, Rect<PackingSizeType> charArea, std::set<FT_ULong> charsWithoutRect);
+        // `page` is the index of the page texture holding the char area, as in `pages` of the packing
+        void setCharInfo(FT_ULong charcode, Rect<PackingSizeType> charArea, int page = 0);
+        bool setCharInfo(FT_ULong charcode, Rect<PackingSizeType> charArea, std::set<FT_ULong> charsWithoutRect,
+                         int page = 0);
 
        private:
         void setFontInfo();
@@ -87,8 +100,10 @@ namespace llassetgen {
         Common fontCommon;
         std::vector<CharInfo> charInfos;
         std::vector<KerningInfo> kerningInfos;
+        std::vector<std::string> pageFiles;
         FT_Pos maxYBearing;
         float scalingFactor;
         float padding;
+        uint8_t channels;
     };
 }
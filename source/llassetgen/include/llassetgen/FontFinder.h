@@ -2,11 +2,12 @@
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include <functional>
+#include <map>
 #include <string>
-#ifdef _WIN32
 #include <vector>
-#endif
 
+#include <llassetgen/Outline.h>
 #include <llassetgen/llassetgen.h>
 #include <llassetgen/llassetgen_api.h>
 
@@ -20,8 +21,45 @@ namespace llassetgen {
 
         void setFontSize(int size);
 
+        /*
+         * Render the glyphs as 1 bit masks, or as 8 bit coverage images if `antiAliased` is set.
+         */
         std::vector<Image> renderGlyphs(const std::set<unsigned long>& glyphs, int size, size_t padding = 0,
-                                        size_t divisibleBy = 1);
+                                        size_t divisibleBy = 1, bool antiAliased = false);
+        /*
+         * Like renderGlyphs, with the same result, but the glyphs are rendered by the OpenMP threads. The threads
+         * take the glyphs one by one, each renders with its own FT_Library and FT_Face, which are opened from the
+         * font file loaded into memory once.
+         */
+        std::vector<Image> renderGlyphsParallel(const std::set<unsigned long>& glyphs, int size, size_t padding = 0,
+                                                size_t divisibleBy = 1, bool antiAliased = false);
+        /*
+         * The sizes of the images renderGlyphs would produce for the depictable glyphs, from the glyph metrics only
+         * (without rendering). Glyphs with an embedded bitmap at this size are measured by that bitmap, as they are
+         * rendered from it.
+         */
+        std::map<unsigned long, Vec2<size_t>> glyphSizes(const std::set<unsigned long>& glyphs, int size,
+                                                         size_t padding = 0, size_t divisibleBy = 1,
+                                                         bool antiAliased = false);
+        /*
+         * Render the glyphs without keeping them: each glyph is rendered into a canvas of the rendering thread's
+         * DistanceTransformWorkspace and passed to `consumer` with its index in `glyphs`. The glyphs are distributed
+         * over the OpenMP threads with a dynamic schedule, so `consumer` is called concurrently. All glyphs
+         * have to be depictable, see glyphSizes. Exceptions of `consumer` are rethrown once all threads are done,
+         * as is a glyph with another pixel mode than requested (an embedded bitmap).
+         *
+         * If `costs` are given (one per glyph, e.g. the area of its Rect), the glyphs are handed out largest first
+         * like in scheduleLargestFirst, otherwise in their order.
+         */
+        void renderGlyphs(const std::vector<unsigned long>& glyphs, int size, size_t padding, size_t divisibleBy,
+                          bool antiAliased, const std::function<void(size_t, Image&)>& consumer,
+                          const std::vector<size_t>& costs = std::vector<size_t>());
+        /*
+         * Load the outlines of the glyphs without rendering them. Each outline is placed like the image that
+         * renderGlyphs would produce for it with the same arguments (as a 1 bit mask).
+         */
+        std::vector<GlyphOutline> loadOutlines(const std::set<unsigned long>& glyphs, int size, size_t padding = 0,
+                                               size_t divisibleBy = 1);
         std::set<FT_ULong> nonDepictableChars;
         FT_Face fontFace;
 
@@ -34,8 +72,10 @@ namespace llassetgen {
         static bool findFontPath(const std::string& fontName, std::string& fontPath);
 #endif
 
-#ifdef _WIN32
+        void loadFontData();
+
+        // the font file, loaded on demand if the face was opened from a path
+        std::string fontPath;
         std::vector<FT_Byte> fontData;
-#endif
     };
 }
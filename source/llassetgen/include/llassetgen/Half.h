@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace llassetgen {
+    /*
+     * IEEE 754 binary16 ("half float") pixel type: 1 sign, 5 exponent and 10 mantissa bits. Converts implicitly from
+     * and to float, rounding to the nearest representable value (ties to even), so arithmetic happens in float.
+     * Signed distances keep their sign and about 3 decimal digits, e.g. steps of 1/64 pixel below 16 pixels.
+     */
+    class Half {
+        uint16_t bits;
+
+       public:
+        Half() = default;
+        Half(float value) : bits(fromFloat(value)) {}  // NOLINT implicit like the built-in floating point types
+
+        operator float() const { return toFloat(bits); }  // NOLINT
+
+        uint16_t getBits() const { return bits; }
+        static Half fromBits(uint16_t bits) {
+            Half half;
+            half.bits = bits;
+            return half;
+        }
+
+        static uint16_t fromFloat(float value) {
+            uint32_t f;
+            std::memcpy(&f, &value, sizeof(f));
+            auto sign = static_cast<uint16_t>((f >> 16) & 0x8000);
+            uint32_t magnitude = f & 0x7FFFFFFF;
+
+            if (magnitude >= 0x7F800000) {
+                // infinity, or a quiet NaN
+                return sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0);
+            }
+            if (magnitude >= 0x477FF000) {
+                // rounds to more than the largest half (65504)
+                return sign | 0x7C00;
+            }
+            uint32_t half, remainder, halfway;
+            if (magnitude < 0x38800000) {
+                // subnormal half: the mantissa including its leading 1 is shifted into place, values below 2^-25
+                // round to zero
+                if (magnitude < 0x33000000) {
+                    return sign;
+                }
+                uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+                uint32_t shift = 126 - (magnitude >> 23);
+                half = mantissa >> shift;
+                remainder = mantissa & ((1u << shift) - 1);
+                halfway = 1u << (shift - 1);
+            } else {
+                // normal half: rebias the exponent from 127 to 15, the mantissa loses 13 bits
+                half = (magnitude - 0x38000000) >> 13;
+                remainder = magnitude & 0x1FFF;
+                halfway = 0x1000;
+            }
+            if (remainder > halfway || (remainder == halfway && (half & 1))) {
+                half++;  // may carry into the exponent, which is still correct
+            }
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        static float toFloat(uint16_t half) {
+            uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+            uint32_t exponent = (half >> 10) & 0x1F;
+            uint32_t mantissa = half & 0x3FF;
+
+            if (exponent == 0) {
+                // zero or subnormal, exactly representable as float
+                float value = static_cast<float>(mantissa) * (1.0F / (1 << 24));
+                return sign ? -value : value;
+            }
+            uint32_t f;
+            if (exponent == 0x1F) {
+                f = sign | 0x7F800000 | (mantissa << 13);
+            } else {
+                f = sign | ((exponent + 112) << 23) | (mantissa << 13);
+            }
+            float value;
+            std::memcpy(&value, &f, sizeof(value));
+            return value;
+        }
+    };
+}
+
+namespace std {
+    template <>
+    class numeric_limits<llassetgen::Half> {
+       public:
+        static constexpr bool is_specialized = true;
+        static constexpr bool is_signed = true;
+        static constexpr bool has_infinity = true;
+        static constexpr int digits = 11;
+
+        static llassetgen::Half min() { return llassetgen::Half::fromBits(0x0400); }
+        static llassetgen::Half max() { return llassetgen::Half::fromBits(0x7BFF); }
+        static llassetgen::Half lowest() { return llassetgen::Half::fromBits(0xFBFF); }
+        static llassetgen::Half epsilon() { return llassetgen::Half::fromBits(0x1400); }
+        static llassetgen::Half infinity() { return llassetgen::Half::fromBits(0x7C00); }
+    };
+}
@@ -1,17 +1,27 @@
 #pragma once
 
 #include <llassetgen/Geometry.h>
+#include <llassetgen/Half.h>
 #include <llassetgen/llassetgen_api.h>
 
 #include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
 struct FT_Bitmap_;
 struct png_struct_def;
 
 namespace llassetgen {
+    class PngRowWriter;
+    template <typename PixelT, size_t BitDepth>
+    class ImageView;
+
     class LLASSETGEN_API Image {
+        friend class PngRowWriter;
+        template <typename PixelT, size_t BitDepth>
+        friend class ImageView;
+
         Vec2<size_t> min, max;
         size_t stride;
         uint8_t bitDepth;
@@ -25,7 +35,6 @@ namespace llassetgen {
         LLASSETGEN_NO_EXPORT static void readData(png_struct_def* png, uint8_t* data, size_t length);
         LLASSETGEN_NO_EXPORT static void writeData(png_struct_def* png, uint8_t* data, size_t length);
         LLASSETGEN_NO_EXPORT static void flushData(png_struct_def* png);
-        LLASSETGEN_NO_EXPORT static size_t divisiblePadding(size_t size, size_t padding, size_t divisor);
 
         LLASSETGEN_NO_EXPORT void fillPadding(Rect<size_t> image);
 
@@ -39,6 +48,12 @@ namespace llassetgen {
         Image(FT_Bitmap_ bitmap, size_t padding = 0, size_t divisibleBy = 1);
         Image view(Vec2<size_t> _min, Vec2<size_t> _max, size_t padding = 0);
 
+        /*
+         * The size of an image with `size` pixels of content, surrounded by `padding` pixels and then padded on the
+         * far side to be divisible by `divisor`, as done by the FT_Bitmap constructor.
+         */
+        static size_t divisiblePadding(size_t size, size_t padding, size_t divisor);
+
         size_t getWidth() const;
         size_t getHeight() const;
         size_t getBitDepth() const;
@@ -50,9 +65,27 @@ namespace llassetgen {
         template <typename pixelType>
         void setPixel(Vec2<size_t> pos, pixelType data) const;
 
+        /*
+         * Raw access to the pixels of a row, for bit depths which match the pixel type. Consecutive rows are
+         * `getRowPitch<pixelType>()` pixels apart.
+         */
+        template <typename pixelType>
+        pixelType* getRowData(size_t y) const;
+        template <typename pixelType>
+        size_t getRowPitch() const;
+        /*
+         * Expand a row of a packed image (bit depth <= 8) to one byte per pixel.
+         */
+        void unpackRow(size_t y, uint8_t* out) const;
+
         template <typename pixelType = uint8_t>
         void fillRect(Vec2<size_t> _min, Vec2<size_t> _max, pixelType in = 0) const;
         void clear() const;
+        /*
+         * Copy the pixels of an image of the same size and bit depth, or of a packed image into an 8 bit image with
+         * the values scaled to the full range. Like fillRect and load, this only writes the bits of this view, so
+         * non-overlapping views of one packed image can be written from several threads.
+         */
         void copyDataFrom(const Image& copy);
 
         template <typename pixelType>
@@ -61,12 +94,74 @@ namespace llassetgen {
         void averageDownsampling(const Image& src) const;
         template <typename pixelType>
         void minDownsampling(const Image& src) const;
+        /*
+         * averageDownsampling<float> and minDownsampling<float> for 32 bit images, which reduce the source rows of
+         * each output row with SIMD kernels first (AVX2 or SSE2, picked at runtime, or plain C++) and then the runs of
+         * pixels within the reduced row. The minima are the same, the averages may differ in the last bits since the
+         * pixels are summed in a different order.
+         */
+        void simdAverageDownsampling(const Image& src) const;
+        void simdMinDownsampling(const Image& src) const;
+
+        /*
+         * Map the values of `src` (same size) from [black, white] to the full range of this image's bit depth (8 or
+         * 16 bits), clamped and truncated like exportPng does when it reduces wider images to 16 bits.
+         */
+        template <typename pixelType>
+        void quantize(const Image& src, pixelType black, pixelType white) const;
 
         void load(const FT_Bitmap_& ft_bitmap);
+        /*
+         * Load a bitmap at (padding, padding) and clear the rest of the image, like the FT_Bitmap constructor.
+         */
+        void loadPadded(const FT_Bitmap_& ft_bitmap, size_t padding);
         Image(const std::string& filepath, uint8_t _bitDepth = 0);
         template <typename pixelType>
         void exportPng(const std::string& filepath,
                        pixelType black = std::numeric_limits<pixelType>::min(),
                        pixelType white = std::numeric_limits<pixelType>::max());
+        /*
+         * Export the pixels as they are stored, row after row without padding, in the byte order of the machine.
+         * Only for bit depths of at least 8.
+         */
+        void exportRaw(const std::string& filepath) const;
+        /*
+         * Export a single channel KTX 1.1 texture with the OpenGL format matching pixelType (R8, R16, R16F for Half
+         * or R32F), without any conversion of the values. The rows are stored from top to bottom, as declared by the
+         * KTXorientation key.
+         */
+        template <typename pixelType>
+        void exportKtx(const std::string& filepath) const;
+        /*
+         * Export 3 (RGB) or 4 (RGBA) images of the same size as the channels of one PNG with 8 bits per channel.
+         * The values are mapped to the channels like with exportPng.
+         */
+        template <typename pixelType>
+        static void exportMultiChannelPng(const std::string& filepath, const std::vector<Image>& channels,
+                                          pixelType black, pixelType white);
+    };
+
+    /*
+     * Writes a grayscale PNG row by row as the rows become available, so that the image never has to be in memory
+     * as a whole. The rows are converted like with Image::exportPng for an image of the given bit depth.
+     */
+    class LLASSETGEN_API PngRowWriter {
+        struct State;
+        std::unique_ptr<State> state;
+
+       public:
+        PngRowWriter(const std::string& filepath, size_t width, size_t height, uint8_t bitDepth);
+        ~PngRowWriter();
+
+        /*
+         * Append all rows of `rows`, which must have the width and bit depth given to the constructor.
+         */
+        template <typename pixelType>
+        void writeRows(const Image& rows, pixelType black = std::numeric_limits<pixelType>::min(),
+                       pixelType white = std::numeric_limits<pixelType>::max());
+        /*
+         * Write the end of the PNG, after all rows have been written. Called by the destructor if necessary.
+         */
+        void finish();
     };
 }
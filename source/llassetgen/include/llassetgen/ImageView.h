@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include <llassetgen/Geometry.h>
+#include <llassetgen/Image.h>
+
+namespace llassetgen {
+    /*
+     * A row of an ImageView with whole bytes per pixel, a plain array of pixels.
+     */
+    template <typename PixelT>
+    class ImageRow {
+        PixelT* first;
+        size_t length;
+
+       public:
+        ImageRow(PixelT* _first, size_t _length) : first(_first), length(_length) {}
+
+        PixelT* begin() const { return first; }
+        PixelT* end() const { return first + length; }
+        size_t size() const { return length; }
+        PixelT& operator[](size_t x) const { return first[x]; }
+    };
+
+    /*
+     * A row of an ImageView with several pixels per byte (BitDepth 1, 2 or 4), most significant bits first like in
+     * Image. Pixels are read through operator[] and the iterators and written with set.
+     */
+    template <typename PixelT, size_t BitDepth>
+    class PackedImageRow {
+        static constexpr uint8_t mask = (1 << BitDepth) - 1;
+
+        uint8_t* bytes;
+        size_t offset, length;
+
+       public:
+        class Iterator {
+            const uint8_t* bytes;
+            size_t position;
+
+           public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = PixelT;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = PixelT;
+
+            Iterator(const uint8_t* _bytes, size_t _position) : bytes(_bytes), position(_position) {}
+
+            PixelT operator*() const {
+                size_t bit = position * BitDepth;
+                return static_cast<PixelT>((bytes[bit / 8] >> (8 - BitDepth - bit % 8)) & mask);
+            }
+            Iterator& operator++() {
+                ++position;
+                return *this;
+            }
+            Iterator operator++(int) {
+                Iterator previous = *this;
+                ++position;
+                return previous;
+            }
+            bool operator==(const Iterator& other) const { return position == other.position; }
+            bool operator!=(const Iterator& other) const { return position != other.position; }
+        };
+
+        PackedImageRow(uint8_t* _bytes, size_t _offset, size_t _length)
+            : bytes(_bytes), offset(_offset), length(_length) {}
+
+        Iterator begin() const { return {bytes, offset}; }
+        Iterator end() const { return {bytes, offset + length}; }
+        size_t size() const { return length; }
+        PixelT operator[](size_t x) const { return *Iterator(bytes, offset + x); }
+
+        void set(size_t x, PixelT value) const {
+            size_t bit = (offset + x) * BitDepth;
+            uint8_t& byte = bytes[bit / 8];
+            uint8_t shift = 8 - BitDepth - bit % 8;
+            byte = static_cast<uint8_t>((byte & ~(mask << shift)) | ((static_cast<uint8_t>(value) & mask) << shift));
+        }
+    };
+
+    /*
+     * Typed access to the pixels of an Image whose pixel format is known at compile time. Image::getPixel and
+     * Image::setPixel branch on the bit depth and compute the pixel address from the stride for every pixel, the
+     * ImageView resolves the format once when it is created (asserting that it matches) and then only does the
+     * address arithmetic of that format. BitDepth is the size of PixelT, or 1, 2 or 4 for packed images.
+     *
+     * The view does not own the pixels, the Image has to outlive it.
+     */
+    template <typename PixelT, size_t BitDepth = 8 * sizeof(PixelT)>
+    class ImageView {
+        static_assert(BitDepth == 8 * sizeof(PixelT) || (BitDepth < 8 && 8 % BitDepth == 0 && sizeof(PixelT) == 1),
+                      "BitDepth must be the size of PixelT or divide 8");
+
+       public:
+        static constexpr bool packed = BitDepth < 8;
+        using Row = typename std::conditional<packed, PackedImageRow<PixelT, BitDepth>, ImageRow<PixelT>>::type;
+
+       private:
+        uint8_t* data;  // the first row, for packed images the byte containing the first pixel
+        size_t offset;  // packed images: the pixel offset of the first pixel within the rows
+        size_t width, height, stride;
+
+        Row makeRow(uint8_t* rowData, std::true_type) const { return {rowData, offset, width}; }
+        Row makeRow(uint8_t* rowData, std::false_type) const { return {reinterpret_cast<PixelT*>(rowData), width}; }
+
+        PixelT get(Vec2<size_t> pos, std::true_type) const { return row(pos.y)[pos.x]; }
+        PixelT get(Vec2<size_t> pos, std::false_type) const {
+            return reinterpret_cast<const PixelT*>(data + pos.y * stride)[pos.x];
+        }
+        void set(Vec2<size_t> pos, PixelT value, std::true_type) const { row(pos.y).set(pos.x, value); }
+        void set(Vec2<size_t> pos, PixelT value, std::false_type) const {
+            reinterpret_cast<PixelT*>(data + pos.y * stride)[pos.x] = value;
+        }
+
+       public:
+        explicit ImageView(const Image& image)
+            : width(image.getWidth()), height(image.getHeight()), stride(image.stride) {
+            assert(image.getBitDepth() == BitDepth);
+            if (packed) {
+                data = image.data + image.min.y * stride;
+                offset = image.min.x;
+            } else {
+                data = image.data + image.min.y * stride + image.min.x * sizeof(PixelT);
+                offset = 0;
+            }
+        }
+
+        size_t getWidth() const { return width; }
+        size_t getHeight() const { return height; }
+        Vec2<size_t> getSize() const { return {width, height}; }
+
+        Row row(size_t y) const {
+            assert(y < height);
+            return makeRow(data + y * stride, std::integral_constant<bool, packed>());
+        }
+
+        PixelT getPixel(Vec2<size_t> pos) const {
+            assert(pos.x < width && pos.y < height);
+            return get(pos, std::integral_constant<bool, packed>());
+        }
+        void setPixel(Vec2<size_t> pos, PixelT value) const {
+            assert(pos.x < width && pos.y < height);
+            set(pos, value, std::integral_constant<bool, packed>());
+        }
+    };
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <vector>
+
+#include <llassetgen/DistanceTransform.h>
+#include <llassetgen/Geometry.h>
+#include <llassetgen/Image.h>
+#include <llassetgen/llassetgen_api.h>
+
+struct FT_Outline_;
+
+namespace llassetgen {
+    /*
+     * A glyph outline made of contours of line, conic (quadratic) and cubic Bézier segments. Coordinates are
+     * in pixels with the y axis pointing up, as in FreeType.
+     */
+    class LLASSETGEN_API Outline {
+        Vec2<double> cursor;
+
+       public:
+        struct LLASSETGEN_API Segment {
+            /*
+             * The type is the degree of the curve, a segment has type + 1 control points.
+             */
+            enum Type : uint8_t { Line = 1, Conic = 2, Cubic = 3 };
+            /*
+             * The channels of a multi-channel distance field a segment belongs to, see Outline::colorEdges.
+             */
+            enum Channels : uint8_t {
+                Red = 1,
+                Green = 2,
+                Blue = 4,
+                Yellow = Red | Green,
+                Magenta = Red | Blue,
+                Cyan = Green | Blue,
+                White = Red | Green | Blue
+            };
+
+            Type type;
+            Vec2<double> points[4];
+            uint8_t channels;
+
+            Vec2<double> point(double t) const;
+            /*
+             * The derivative at `t`, or the direction towards the next distinct control point where it vanishes.
+             */
+            Vec2<double> direction(double t) const;
+            /*
+             * Parameter of the point on the segment which is closest to `p`.
+             */
+            double closestParameter(Vec2<double> p) const;
+            /*
+             * Unsigned distance from `p` to the closest point on the segment.
+             */
+            double distance(Vec2<double> p) const;
+            /*
+             * Split the segment at `t` into two segments of the same type.
+             */
+            void split(double t, Segment& first, Segment& second) const;
+            /*
+             * Bounding box of the control points, which contains the segment.
+             */
+            Vec2<double> min() const;
+            Vec2<double> max() const;
+        };
+
+        using Contour = std::vector<Segment>;
+
+        std::vector<Contour> contours;
+        bool evenOddFill = false;
+
+        Outline() = default;
+        /*
+         * Decompose a FreeType outline (26.6 fixed point coordinates) with FT_Outline_Decompose.
+         */
+        explicit Outline(const FT_Outline_& outline);
+
+        /*
+         * Build the outline segment by segment, every moveTo starts a new contour. Open contours are closed
+         * implicitly for the inside test.
+         */
+        void moveTo(Vec2<double> to);
+        void lineTo(Vec2<double> to);
+        void conicTo(Vec2<double> control, Vec2<double> to);
+        void cubicTo(Vec2<double> control1, Vec2<double> control2, Vec2<double> to);
+
+        /*
+         * Assign channels to the segments for a multi-channel distance field, such that the segments meeting at a
+         * corner share only one channel, after Chlumsky's simple edge coloring. A corner is where the directions of
+         * the segments meeting there are at least 90 degrees apart, or where the sine of the angle between them
+         * exceeds sin(angleThreshold). With the default of 3 (radians), the sine threshold is about 0.14, so a
+         * direction change of about 8 degrees already makes a corner. Contours with only one corner are split into at
+         * least three segments first.
+         */
+        void colorEdges(double angleThreshold = 3);
+
+        bool empty() const;
+        Vec2<double> min() const;
+        Vec2<double> max() const;
+    };
+
+    /*
+     * A glyph outline together with the placement of the image the rasterizer would produce for it: `size` is the
+     * (padded) image size and `origin` the outline coordinates of the image's top left corner.
+     */
+    struct LLASSETGEN_API GlyphOutline {
+        Outline outline;
+        Vec2<double> origin;
+        Vec2<size_t> size;
+
+        Vec2<size_t> getSize() const { return size; }
+    };
+
+    /*
+     * Signed distance field computed analytically from an Outline, without rasterizing it. Distances are positive
+     * outside and negative inside the outline (by its fill rule), in the units of the outline coordinates.
+     *
+     * Only segments whose bounding box lies within the band limit of a pixel are considered for it: the segments are
+     * sorted into a grid of cells over the output first. Pixels without any segment in reach get +/- bandLimit.
+     */
+    class LLASSETGEN_API OutlineDistanceField {
+        const Outline& outline;
+        DistanceTransform::OutputType bandLimit;
+
+       public:
+        OutlineDistanceField(const Outline& _outline,
+                             DistanceTransform::OutputType _bandLimit = DistanceTransform::backgroundVal);
+
+        /*
+         * Pixel (x, y) of the output (bit depth 32) is sampled at outline coordinates
+         * origin + ((x + 0.5) * scale, -(y + 0.5) * scale), i.e. `scale` is the size of an output pixel.
+         */
+        void render(const Image& output, Vec2<double> origin, double scale = 1) const;
+    };
+
+    /*
+     * Multi-channel signed distance field (MSDF) of an Outline, after CHLUMSKY, Viktor. Shape Decomposition for
+     * Multi-channel Distance Fields. Master's thesis, Czech Technical University in Prague, 2015.
+     *
+     * The outline is copied and its edges colored, each channel holds the signed pseudo-distance to the closest
+     * segment of that channel. The median of the three channels reconstructs the outline including sharp corners.
+     * Where the median has the wrong sign (i.e. would produce an artifact), all channels get the true distance.
+     */
+    class LLASSETGEN_API MultiChannelDistanceField {
+        Outline outline;
+        DistanceTransform::OutputType bandLimit;
+
+       public:
+        MultiChannelDistanceField(const Outline& _outline,
+                                  DistanceTransform::OutputType _bandLimit = DistanceTransform::backgroundVal,
+                                  double angleThreshold = 3);
+
+        /*
+         * Sampled like OutlineDistanceField::render, all outputs have bit depth 32 and the same size. `trueDistance`
+         * receives the single channel signed distance field.
+         */
+        void render(const Image& red, const Image& green, const Image& blue, const Image& trueDistance,
+                    Vec2<double> origin, double scale = 1) const;
+    };
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <llassetgen/llassetgen_api.h>
+
+namespace llassetgen {
+    /*
+     * Statistics of the parallel glyph loops (atlas generation, rendering), per OpenMP thread. While a
+     * ScheduleReport exists, every loop that the constructing thread starts adds to it, so a report around a call
+     * of e.g. distanceFieldAtlas shows how well the glyphs were balanced over the threads. Reports can be nested,
+     * then only the innermost one is filled.
+     */
+    class LLASSETGEN_API ScheduleReport {
+       public:
+        struct Thread {
+            size_t items = 0;
+            double busySeconds = 0;
+        };
+
+        ScheduleReport();
+        ~ScheduleReport();
+        ScheduleReport(const ScheduleReport&) = delete;
+        ScheduleReport& operator=(const ScheduleReport&) = delete;
+
+        /*
+         * The share of the wall time of the loops in which the threads were busy with a work item, between 0 and 1.
+         * Time spent waiting for the last items of a loop counts as idle.
+         */
+        double utilization() const;
+        /*
+         * One line per thread with its items, busy time and utilization.
+         */
+        std::string summary() const;
+
+        std::vector<Thread> threads;
+        double wallSeconds = 0;
+        size_t loops = 0;
+
+       private:
+        ScheduleReport* outer;
+    };
+
+    /*
+     * The indices of the work items ordered by decreasing `costs`, equal costs in index order.
+     */
+    LLASSETGEN_API std::vector<size_t> largestFirst(const std::vector<size_t>& costs);
+
+    /*
+     * Call `work` for the index of every work item, concurrently on the OpenMP threads. The items are handed out
+     * one by one, largest cost first (e.g. the pixel area of a glyph): threads that finish early take the next
+     * item, and the cheap items at the end fill the gaps instead of a big glyph starting last.
+     */
+    LLASSETGEN_API void scheduleLargestFirst(const std::vector<size_t>& costs,
+                                             const std::function<void(size_t)>& work);
+
+    namespace internal {
+        /*
+         * Times the work items of one parallel loop for the ScheduleReport of the thread that constructs it, if
+         * there is one. It has to be constructed before the parallel region, the threads call `done` after each item
+         * with the time returned by `start`.
+         */
+        class LLASSETGEN_API LoopTimer {
+           public:
+            LoopTimer();
+            ~LoopTimer();
+            LoopTimer(const LoopTimer&) = delete;
+            LoopTimer& operator=(const LoopTimer&) = delete;
+
+            double start() const;
+            void done(double startTime);
+
+           private:
+            ScheduleReport* report;
+            std::vector<ScheduleReport::Thread> threads;
+            double loopStart;
+        };
+    }
+}
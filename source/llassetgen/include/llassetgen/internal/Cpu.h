@@ -0,0 +1,26 @@
+#pragma once
+
+#include <llassetgen/llassetgen_api.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define LLASSETGEN_X86
+#endif
+
+namespace llassetgen {
+    namespace internal {
+        /**
+         * Instruction sets of the CPU the SIMD kernels are selected by. Everything is false on other architectures
+         * and compilers without a way to query the CPU.
+         */
+        struct CpuFeatures {
+            bool sse2;
+            bool sse41;
+            bool avx2;
+        };
+
+        /**
+         * The features of the CPU, detected once.
+         */
+        LLASSETGEN_API const CpuFeatures& cpuFeatures();
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+
+#include <llassetgen/internal/Cpu.h>
+#include <llassetgen/llassetgen_api.h>
+
+namespace llassetgen {
+    namespace internal {
+        /**
+         * One output row of a box (average) or min downsampling of a float image by `xScale` x `yScale`.
+         *
+         * The `yScale` source rows (`srcPitch` floats apart) are first reduced column-wise into `accumulator`
+         * (`outWidth * xScale` floats), `Lanes::count` columns at a time in a register. Then each run of `xScale`
+         * accumulated pixels is reduced to an output pixel. Per output pixel, that are yScale vector operations per
+         * `Lanes::count` columns and xScale scalar ones instead of xScale * yScale calls to Image::getPixel. The sums
+         * are divided by xScale * yScale.
+         *
+         * `Lanes` wraps the intrinsics of one instruction set, it is instantiated in the translation units that are
+         * compiled for that instruction set. It does not call inline library functions like std::min, whose copies
+         * compiled for that instruction set could be picked by the linker for other callers.
+         */
+        template <class Lanes, bool minimum>
+        void downsampleRow(float* out, size_t outWidth, const float* src, size_t srcPitch, size_t xScale,
+                           size_t yScale, float* accumulator) {
+            using Float = typename Lanes::Float;
+            constexpr size_t count = Lanes::count;
+            const size_t length = outWidth * xScale;
+            const size_t vectorLength = length - length % count;
+
+            for (size_t x = 0; x < vectorLength; x += count) {
+                Float value = Lanes::load(&src[x]);
+                for (size_t j = 1; j < yScale; ++j) {
+                    Float next = Lanes::load(&src[j * srcPitch + x]);
+                    value = minimum ? Lanes::min(value, next) : Lanes::add(value, next);
+                }
+                Lanes::store(&accumulator[x], value);
+            }
+            for (size_t x = vectorLength; x < length; ++x) {
+                float value = src[x];
+                for (size_t j = 1; j < yScale; ++j) {
+                    float next = src[j * srcPitch + x];
+                    value = minimum ? (next < value ? next : value) : value + next;
+                }
+                accumulator[x] = value;
+            }
+
+            const auto area = static_cast<float>(xScale * yScale);
+            for (size_t x = 0; x < outWidth; ++x) {
+                const float* run = &accumulator[x * xScale];
+                float value = run[0];
+                for (size_t i = 1; i < xScale; ++i) {
+                    value = minimum ? (run[i] < value ? run[i] : value) : value + run[i];
+                }
+                out[x] = minimum ? value : value / area;
+            }
+        }
+
+        /**
+         * Plain C++ lanes for the fallback kernel.
+         */
+        struct ScalarLanes {
+            using Float = float;
+            static constexpr size_t count = 1;
+
+            static Float load(const float* data) { return *data; }
+            static void store(float* data, Float value) { *data = value; }
+            static Float add(Float a, Float b) { return a + b; }
+            static Float min(Float a, Float b) { return b < a ? b : a; }
+        };
+
+        using DownsampleRowKernel = void (*)(float*, size_t, const float*, size_t, size_t, size_t, float*);
+
+        // exported for the tests, which compare every kernel the CPU supports with the scalar downsampling
+        LLASSETGEN_API void averageDownsampleRowSse2(float* out, size_t outWidth, const float* src, size_t srcPitch,
+                                                     size_t xScale, size_t yScale, float* accumulator);
+        LLASSETGEN_API void minDownsampleRowSse2(float* out, size_t outWidth, const float* src, size_t srcPitch,
+                                                 size_t xScale, size_t yScale, float* accumulator);
+        LLASSETGEN_API void averageDownsampleRowAvx2(float* out, size_t outWidth, const float* src, size_t srcPitch,
+                                                     size_t xScale, size_t yScale, float* accumulator);
+        LLASSETGEN_API void minDownsampleRowAvx2(float* out, size_t outWidth, const float* src, size_t srcPitch,
+                                                 size_t xScale, size_t yScale, float* accumulator);
+    }
+}
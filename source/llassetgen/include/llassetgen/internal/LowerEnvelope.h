@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include <llassetgen/internal/Cpu.h>
+
+namespace llassetgen {
+    namespace internal {
+        /**
+         * Largest line length for which the SIMD kernels compute the same squared distances as the scalar
+         * ParabolaEnvelope (the squares have to fit into the 32 bit integer lanes).
+         */
+        constexpr size_t lowerEnvelopeMaxLength = 46340;
+
+        /**
+         * Lower envelope and final distance computation for `Lanes::count` interleaved lines.
+         *
+         * `lines` holds the squared distances of the column pass (the element j * count + l belongs to pixel j of
+         * line l) and receives the signed distances. `signMasks` contains 0x80000000 for every pixel inside the
+         * shape. The parabola stacks `apexes`, `begins` and `values` are interleaved in the same way and need room for
+         * (length + 1) * count elements. The arithmetic matches ParabolaEnvelope::transformLine, so the results are
+         * bit-identical.
+         *
+         * `Lanes` wraps the intrinsics of one instruction set, it is instantiated in the translation units that are
+         * compiled for that instruction set.
+         */
+        template <class Lanes>
+        void lowerEnvelope(float* lines, const uint32_t* signMasks, size_t length, int32_t* apexes, float* begins,
+                           float* values) {
+            using Float = typename Lanes::Float;
+            using Int = typename Lanes::Int;
+            constexpr size_t count = Lanes::count;
+            const Int lane = Lanes::laneIndices();
+            const Int stride = Lanes::set(static_cast<int32_t>(count));
+            const Int one = Lanes::set(1);
+
+            for (size_t l = 0; l < count; ++l) {
+                apexes[l] = 0;
+                begins[l] = -std::numeric_limits<float>::infinity();
+                values[l] = lines[l];
+                begins[count + l] = std::numeric_limits<float>::infinity();
+            }
+
+            Int top = Lanes::set(0);
+            alignas(32) int32_t topOut[count];
+            alignas(32) float beginOut[count];
+            alignas(32) float valueOut[count];
+            for (size_t j = 1; j < length; ++j) {
+                Float value = Lanes::load(&lines[j * count]);
+                Float valuePlusSquare = Lanes::add(value, Lanes::set(static_cast<float>(j * j)));
+                Int position = Lanes::set(static_cast<int32_t>(j));
+                Float popped = Lanes::allOnes();
+                Float begin = Lanes::set(0.0F);
+                do {
+                    Int index = Lanes::add(Lanes::mul(top, stride), lane);
+                    Int apex = Lanes::gather(apexes, index);
+                    Float apexValue = Lanes::add(Lanes::gather(values, index), Lanes::toFloat(Lanes::mul(apex, apex)));
+                    Float distance = Lanes::toFloat(Lanes::add(Lanes::sub(position, apex), Lanes::sub(position, apex)));
+                    Float intersection = Lanes::div(Lanes::sub(valuePlusSquare, apexValue), distance);
+                    Float pop = Lanes::lessEqual(intersection, Lanes::gather(begins, index));
+                    begin = Lanes::select(Lanes::andNot(pop, popped), intersection, begin);
+                    popped = Lanes::bitAnd(popped, pop);
+                    top = Lanes::add(top, Lanes::maskToInt(popped));  // Lanes that popped their top parabola: -1
+                } while (Lanes::any(popped));
+                top = Lanes::add(top, one);
+
+                Lanes::store(topOut, top);
+                Lanes::store(beginOut, begin);
+                Lanes::store(valueOut, value);
+                for (size_t l = 0; l < count; ++l) {
+                    size_t index = topOut[l] * count + l;
+                    apexes[index] = static_cast<int32_t>(j);
+                    begins[index] = beginOut[l];
+                    values[index] = valueOut[l];
+                    begins[index + count] = std::numeric_limits<float>::infinity();
+                }
+            }
+
+            top = Lanes::set(0);
+            for (size_t j = 0; j < length; ++j) {
+                Float position = Lanes::set(static_cast<float>(j));
+                Float next;
+                do {
+                    Int index = Lanes::add(Lanes::mul(Lanes::add(top, one), stride), lane);
+                    next = Lanes::less(Lanes::gather(begins, index), position);
+                    top = Lanes::sub(top, Lanes::maskToInt(next));
+                } while (Lanes::any(next));
+
+                Int index = Lanes::add(Lanes::mul(top, stride), lane);
+                Int offset = Lanes::sub(Lanes::set(static_cast<int32_t>(j)), Lanes::gather(apexes, index));
+                Float distance =
+                    Lanes::sqrt(Lanes::add(Lanes::gather(values, index), Lanes::toFloat(Lanes::mul(offset, offset))));
+                Lanes::store(&lines[j * count], Lanes::bitXor(distance, Lanes::load(&signMasks[j * count])));
+            }
+        }
+
+        constexpr size_t sse41LowerEnvelopeLanes = 4;
+        constexpr size_t avx2LowerEnvelopeLanes = 8;
+
+        void lowerEnvelopeSse41(float* lines, const uint32_t* signMasks, size_t length, int32_t* apexes,
+                                float* begins, float* values);
+        void lowerEnvelopeAvx2(float* lines, const uint32_t* signMasks, size_t length, int32_t* apexes, float* begins,
+                               float* values);
+    }
+}
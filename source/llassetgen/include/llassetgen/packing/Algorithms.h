@@ -3,9 +3,12 @@
 #include <cassert>
 
 #include <llassetgen/packing/Types.h>
+#include <llassetgen/packing/internal/AutoPacking.h>
 #include <llassetgen/packing/internal/Common.h>
+#include <llassetgen/packing/internal/GuillotinePacker.h>
 #include <llassetgen/packing/internal/MaxRectsPacker.h>
 #include <llassetgen/packing/internal/ShelfPacker.h>
+#include <llassetgen/packing/internal/SkylinePacker.h>
 
 namespace llassetgen {
     /**
@@ -53,6 +56,107 @@ namespace llassetgen {
         return internal::packAtlas<internal::ShelfPacker>(sizesBegin, sizesEnd, allowRotations, fixedAtlasSize);
     }
 
+    /**
+     * Use the shelf next fit algorithm to pack a texture atlas onto as many pages as
+     * needed.
+     *
+     * See internal::packAtlasPages for how the pages are filled.
+     *
+     * @param sizesBegin
+     *   Begin iterator for the sizes of the input rectangles. This iterators
+     *   items must be convertible to `Vec2<PackingSizeType>`.
+     * @param sizesEnd
+     *   End iterator for the rectangle sizes.
+     * @param maxPageSize
+     *   Maximum size of a page.
+     * @param allowRotations
+     *   Whether to allow rotating rectangles by 90˚.
+     * @return
+     *   Resulting packing, with the page of each rectangle in `pages` if there
+     *   is more than one. If a rectangle doesn't fit onto a page, the list of
+     *   rectangles will be empty.
+     */
+    template <class InputIter>
+    Packing shelfPackAtlasPages(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> maxPageSize,
+                                bool allowRotations) {
+        return internal::packAtlasPages<internal::ShelfPacker>(sizesBegin, sizesEnd, allowRotations, maxPageSize);
+    }
+
+    /**
+     * Use the skyline bottom left algorithm to pack a texture atlas.
+     *
+     * See the fixed size overload for a description of the algorithm.
+     *
+     * @param sizesBegin
+     *   Begin iterator for the sizes of the input rectangles. This iterators
+     *   items must be convertible to `Vec2<PackingSizeType>`.
+     * @param sizesEnd
+     *   End iterator for the rectangle sizes.
+     * @param allowRotations
+     *   Whether to allow rotating rectangles by 90˚.
+     * @return
+     *   Resulting packing.
+     */
+    template <class InputIter>
+    Packing skylinePackAtlas(InputIter sizesBegin, InputIter sizesEnd, bool allowRotations) {
+        return internal::packAtlas<internal::SkylinePacker>(sizesBegin, sizesEnd, allowRotations);
+    }
+
+    /**
+     * Use the skyline bottom left algorithm to pack a fixed size texture atlas.
+     *
+     * Only the upper outline of the packed rectangles (the skyline) is kept,
+     * as a list of horizontal segments. Each rectangle is placed where its
+     * bottom edge is lowest, resting on the skyline, then leftmost. Space
+     * below the skyline is not reused, so the packings are a bit looser than
+     * with max rects, but the runtime is close to that of shelf packing
+     * (O(n * m), where m is the number of segments, which stays small).
+     *
+     * @param sizesBegin
+     *   Begin iterator for the sizes of the input rectangles. This iterators
+     *   items must be convertible to `Vec2<PackingSizeType>`.
+     * @param sizesEnd
+     *   End iterator for the rectangle sizes.
+     * @param fixedAtlasSize
+     *   Size of the atlas to pack into.
+     * @param allowRotations
+     *   Whether to allow rotating rectangles by 90˚.
+     * @return
+     *   Resulting packing. If the given rectangles can't be fit into the atlas
+     *   size, the list of rectangles will be empty.
+     */
+    template <class InputIter>
+    Packing skylinePackAtlas(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> fixedAtlasSize,
+                             bool allowRotations) {
+        return internal::packAtlas<internal::SkylinePacker>(sizesBegin, sizesEnd, allowRotations, fixedAtlasSize);
+    }
+
+    /**
+     * Use the skyline bottom left algorithm to pack a texture atlas onto as many pages as
+     * needed.
+     *
+     * See internal::packAtlasPages for how the pages are filled.
+     *
+     * @param sizesBegin
+     *   Begin iterator for the sizes of the input rectangles. This iterators
+     *   items must be convertible to `Vec2<PackingSizeType>`.
+     * @param sizesEnd
+     *   End iterator for the rectangle sizes.
+     * @param maxPageSize
+     *   Maximum size of a page.
+     * @param allowRotations
+     *   Whether to allow rotating rectangles by 90˚.
+     * @return
+     *   Resulting packing, with the page of each rectangle in `pages` if there
+     *   is more than one. If a rectangle doesn't fit onto a page, the list of
+     *   rectangles will be empty.
+     */
+    template <class InputIter>
+    Packing skylinePackAtlasPages(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> maxPageSize,
+                                  bool allowRotations) {
+        return internal::packAtlasPages<internal::SkylinePacker>(sizesBegin, sizesEnd, allowRotations, maxPageSize);
+    }
+
     /**
      * Use the max rects algorithm to pack a texture atlas.
      *
@@ -101,4 +205,177 @@ namespace llassetgen {
                               bool allowRotations) {
         return internal::packAtlas<internal::MaxRectsPacker>(sizesBegin, sizesEnd, allowRotations, fixedAtlasSize);
     }
+
+    /**
+     * Use the max rects algorithm to pack a texture atlas onto as many pages as
+     * needed.
+     *
+     * See internal::packAtlasPages for how the pages are filled.
+     *
+     * @param sizesBegin
+     *   Begin iterator for the sizes of the input rectangles. This iterators
+     *   items must be convertible to `Vec2<PackingSizeType>`.
+     * @param sizesEnd
+     *   End iterator for the rectangle sizes.
+     * @param maxPageSize
+     *   Maximum size of a page.
+     * @param allowRotations
+     *   Whether to allow rotating rectangles by 90˚.
+     * @return
+     *   Resulting packing, with the page of each rectangle in `pages` if there
+     *   is more than one. If a rectangle doesn't fit onto a page, the list of
+     *   rectangles will be empty.
+     */
+    template <class InputIter>
+    Packing maxRectsPackAtlasPages(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> maxPageSize,
+                                   bool allowRotations) {
+        return internal::packAtlasPages<internal::MaxRectsPacker>(sizesBegin, sizesEnd, allowRotations, maxPageSize);
+    }
+
+    /**
+     * Use the guillotine algorithm to pack a texture atlas.
+     *
+     * See the fixed size overload for a description of the algorithm.
+     *
+     * @param sizesBegin
+     *   Begin iterator for the sizes of the input rectangles. This iterators
+     *   items must be convertible to `Vec2<PackingSizeType>`.
+     * @param sizesEnd
+     *   End iterator for the rectangle sizes.
+     * @param allowRotations
+     *   Whether to allow rotating rectangles by 90˚.
+     * @param heuristics
+     *   How free rectangles are chosen, split and merged.
+     * @return
+     *   Resulting packing.
+     */
+    template <class InputIter>
+    Packing guillotinePackAtlas(InputIter sizesBegin, InputIter sizesEnd, bool allowRotations,
+                                const GuillotineHeuristics& heuristics) {
+        return internal::packAtlas<internal::GuillotinePacker>(sizesBegin, sizesEnd, allowRotations, heuristics);
+    }
+
+    template <class InputIter>
+    Packing guillotinePackAtlas(InputIter sizesBegin, InputIter sizesEnd, bool allowRotations) {
+        return guillotinePackAtlas(sizesBegin, sizesEnd, allowRotations, GuillotineHeuristics{});
+    }
+
+    /**
+     * Use the guillotine algorithm to pack a fixed size texture atlas.
+     *
+     * The free space is kept as a list of disjoint rectangles. A rectangle is
+     * placed in the corner of the free rectangle chosen by the heuristics, and
+     * the rest of that free rectangle is cut in two along one axis. Unlike
+     * with max rects, the free list stays linear in the number of packed
+     * rectangles, so packing is much faster, at a slightly worse density.
+     * Merging free rectangles that share an edge recovers some of the space
+     * lost to the cuts (Jylänki, 2010).
+     *
+     * @param sizesBegin
+     *   Begin iterator for the sizes of the input rectangles. This iterators
+     *   items must be convertible to `Vec2<PackingSizeType>`.
+     * @param sizesEnd
+     *   End iterator for the rectangle sizes.
+     * @param fixedAtlasSize
+     *   Size of the atlas to pack into.
+     * @param allowRotations
+     *   Whether to allow rotating rectangles by 90˚.
+     * @param heuristics
+     *   How free rectangles are chosen, split and merged.
+     * @return
+     *   Resulting packing. If the given rectangles can't be fit into the atlas
+     *   size, the list of rectangles will be empty.
+     */
+    template <class InputIter>
+    Packing guillotinePackAtlas(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> fixedAtlasSize,
+                                bool allowRotations, const GuillotineHeuristics& heuristics) {
+        return internal::packAtlas<internal::GuillotinePacker>(sizesBegin, sizesEnd, allowRotations, fixedAtlasSize,
+                                                               heuristics);
+    }
+
+    template <class InputIter>
+    Packing guillotinePackAtlas(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> fixedAtlasSize,
+                                bool allowRotations) {
+        return guillotinePackAtlas(sizesBegin, sizesEnd, fixedAtlasSize, allowRotations, GuillotineHeuristics{});
+    }
+
+    /**
+     * Use the guillotine algorithm to pack a texture atlas onto as many pages as
+     * needed.
+     *
+     * See internal::packAtlasPages for how the pages are filled.
+     *
+     * @param sizesBegin
+     *   Begin iterator for the sizes of the input rectangles. This iterators
+     *   items must be convertible to `Vec2<PackingSizeType>`.
+     * @param sizesEnd
+     *   End iterator for the rectangle sizes.
+     * @param maxPageSize
+     *   Maximum size of a page.
+     * @param allowRotations
+     *   Whether to allow rotating rectangles by 90˚.
+     * @param heuristics
+     *   How free rectangles are chosen, split and merged.
+     * @return
+     *   Resulting packing, with the page of each rectangle in `pages` if there
+     *   is more than one. If a rectangle doesn't fit onto a page, the list of
+     *   rectangles will be empty.
+     */
+    template <class InputIter>
+    Packing guillotinePackAtlasPages(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> maxPageSize,
+                                     bool allowRotations, const GuillotineHeuristics& heuristics) {
+        return internal::packAtlasPages<internal::GuillotinePacker>(sizesBegin, sizesEnd, allowRotations, maxPageSize,
+                                                                    heuristics);
+    }
+
+    template <class InputIter>
+    Packing guillotinePackAtlasPages(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> maxPageSize,
+                                     bool allowRotations) {
+        return guillotinePackAtlasPages(sizesBegin, sizesEnd, maxPageSize, allowRotations, GuillotineHeuristics{});
+    }
+
+    /**
+     * Try all packing algorithms, with several heuristics and input orders,
+     * and keep the smallest atlas.
+     *
+     * The strategies (see internal::packingStrategies) run concurrently, one
+     * per thread. The result is the packing with the least area, or of the
+     * same area with the most square atlas. The name of its strategy is in
+     * `strategy` of the packing.
+     *
+     * @param sizesBegin
+     *   Begin iterator for the sizes of the input rectangles. This iterators
+     *   items must be convertible to `Vec2<PackingSizeType>`.
+     * @param sizesEnd
+     *   End iterator for the rectangle sizes.
+     * @param allowRotations
+     *   Whether to allow rotating rectangles by 90˚.
+     * @return
+     *   Resulting packing.
+     */
+    template <class InputIter>
+    Packing autoPackAtlas(InputIter sizesBegin, InputIter sizesEnd, bool allowRotations) {
+        internal::checkIteratorType<InputIter>();
+        std::vector<Vec2<PackingSizeType>> sizes(sizesBegin, sizesEnd);
+        return internal::autoPackAtlas(sizes, allowRotations, nullptr);
+    }
+
+    /**
+     * Try all packing algorithms, like the single page overload, onto as many
+     * pages as needed. The area of a packing is that of all its pages.
+     *
+     * @param maxPageSize
+     *   Maximum size of a page.
+     * @return
+     *   Resulting packing, with the page of each rectangle in `pages` if there
+     *   is more than one. If a rectangle doesn't fit onto a page, the list of
+     *   rectangles will be empty.
+     */
+    template <class InputIter>
+    Packing autoPackAtlasPages(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> maxPageSize,
+                               bool allowRotations) {
+        internal::checkIteratorType<InputIter>();
+        std::vector<Vec2<PackingSizeType>> sizes(sizesBegin, sizesEnd);
+        return internal::autoPackAtlas(sizes, allowRotations, &maxPageSize);
+    }
 }
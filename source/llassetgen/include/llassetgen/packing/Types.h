@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <string>
 #include <vector>
 
 #include <llassetgen/Geometry.h>
@@ -14,9 +16,73 @@ namespace llassetgen {
      * position in the packing algorithms input.
      */
     struct Packing {
+        // the size of the atlas, or of each page if the rectangles are spread over several pages
         Vec2<PackingSizeType> atlasSize{};
         std::vector<Rect<PackingSizeType>> rects{};
+        /*
+         * The page of each rectangle, if the packing needs several pages
+         * (see e.g. maxRectsPackAtlasPages). Empty for a single page.
+         */
+        std::vector<size_t> pages{};
+        // the packer and input order chosen by autoPackAtlas, empty for the other algorithms
+        std::string strategy{};
 
         Packing() = default;
+
+        size_t pageCount() const {
+            size_t count = 1;
+            for (size_t page : pages) {
+                count = std::max(count, page + 1);
+            }
+            return count;
+        }
+
+        /*
+         * The indices of the rectangles on the given page, in input order.
+         */
+        std::vector<size_t> rectsOnPage(size_t page) const {
+            std::vector<size_t> indices;
+            for (size_t i = 0; i < rects.size(); i++) {
+                if (pages.empty() ? page == 0 : pages[i] == page) {
+                    indices.push_back(i);
+                }
+            }
+            return indices;
+        }
+
+        /*
+         * The single page packing of the rectangles on the given page, in
+         * input order.
+         */
+        Packing page(size_t page) const {
+            Packing result;
+            result.atlasSize = atlasSize;
+            for (size_t i : rectsOnPage(page)) {
+                result.rects.push_back(rects[i]);
+            }
+            return result;
+        }
+    };
+
+    /*
+     * Configures the guillotine packing algorithm, see guillotinePackAtlas.
+     */
+    struct GuillotineHeuristics {
+        /*
+         * Which free rectangle a rectangle is placed in: the one with the
+         * least area left over, or the one with the shortest side left over.
+         */
+        enum FreeRectChoice { BestAreaFit, BestShortSideFit };
+        /*
+         * Along which axis the rest of the free rectangle is cut in two,
+         * decided by the leftover sides, the areas of the two parts or the
+         * sides of the free rectangle.
+         */
+        enum SplitRule { ShorterLeftoverAxis, LongerLeftoverAxis, MinArea, MaxArea, ShorterAxis, LongerAxis };
+
+        FreeRectChoice choice = BestShortSideFit;
+        SplitRule split = ShorterAxis;
+        // merge free rectangles that share a whole edge
+        bool merge = true;
     };
 }
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <llassetgen/llassetgen_api.h>
+#include <llassetgen/packing/Types.h>
+
+namespace llassetgen {
+    namespace internal {
+        /**
+         * A way to pack an atlas: a packer with its heuristics and the order
+         * in which the rectangles are passed to it.
+         */
+        struct PackingStrategy {
+            // e.g. "skyline, by area"
+            std::string name;
+            // packs onto pages of at most `*maxPageSize`, or onto a single page of flexible size if it is null
+            std::function<Packing(const std::vector<Vec2<PackingSizeType>>& sizes, bool allowRotations,
+                                  const Vec2<PackingSizeType>* maxPageSize)>
+                pack;
+        };
+
+        /**
+         * All packers, the guillotine packer with several heuristics, each
+         * with its own input order and with the other input orders.
+         */
+        LLASSETGEN_API const std::vector<PackingStrategy>& packingStrategies();
+
+        /**
+         * Whether the first packing is smaller than the second one: it covers
+         * less area over all pages, or the same area with less of the last
+         * page used (by the bounding box of its rectangles), or both with a
+         * more square page. Failed packings (without rectangles for a
+         * non-empty input) are never smaller.
+         */
+        LLASSETGEN_API bool smallerPacking(const Packing& packing1, const Packing& packing2, size_t rectCount);
+
+        /**
+         * Whether all rectangles lie inside the atlas and no two on the same
+         * page overlap.
+         */
+        LLASSETGEN_API bool validPacking(const Packing& packing);
+
+        /**
+         * Pack with all strategies concurrently, one per thread, and return
+         * the smallest valid packing, with the name of its strategy. Ties go
+         * to the strategy listed first, such that the result does not depend
+         * on the scheduling of the threads.
+         */
+        LLASSETGEN_API Packing autoPackAtlas(const std::vector<Vec2<PackingSizeType>>& sizes, bool allowRotations,
+                                             const Vec2<PackingSizeType>* maxPageSize);
+    }
+}
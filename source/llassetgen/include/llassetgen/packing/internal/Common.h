@@ -5,6 +5,7 @@
 #include <iterator>
 #include <numeric>
 #include <type_traits>
+#include <vector>
 
 #include <llassetgen/llassetgen_api.h>
 #include <llassetgen/packing/Types.h>
@@ -78,23 +79,52 @@ namespace llassetgen {
             return packing;
         }
 
+        /**
+         * The indices of the rectangles of a packing, in the order in which
+         * the packer wants them.
+         */
         template <class Packer>
-        bool packAll(Packing& packing, Packer& packer) {
+        std::vector<size_t> packingOrder(const Packing& packing) {
             std::vector<size_t> indices(packing.rects.size());
             std::iota(indices.begin(), indices.end(), 0);
             std::sort(indices.begin(), indices.end(), [&packing](size_t i1, size_t i2) {
                 return Packer::inputSortingComparator(packing.rects[i1], packing.rects[i2]);
             });
+            return indices;
+        }
+
+        template <class Packer>
+        bool packAll(Packing& packing, Packer& packer) {
+            std::vector<size_t> indices = packingOrder<Packer>(packing);
             return std::all_of(std::begin(indices), std::end(indices),
                                [&](size_t i) { return packer.pack(packing.rects[i]); });
         }
 
+        /**
+         * Pack the rectangles of an initialized packing into an atlas that
+         * grows as needed.
+         */
+        template <class Packer, class... PackerArgs>
+        void packFlexible(Packing& packing, bool allowRotations, const PackerArgs&... packerArgs) {
+            packing.atlasSize = predictAtlasSize(packing);
+
+            Packer packer{packing.atlasSize, allowRotations, true, packerArgs...};
+            bool success = packAll(packing, packer);
+            // Only fails when a rectangle is wider (and higher, if rotations are enabled)
+            // than the width of the atlas texture, however this should be prevented
+            // by predictAtlasSize.
+            assert(success);
+
+            packing.atlasSize = packer.atlasSize();
+        }
+
         /**
          * Create a flexible size packing from given rectangle sizes.
          *
          * @tparam Packer
          *   Packer class. Must provide the following methods:
-         *    - `Packer(const Vec2<PackingSizeType>& initialAtlasSize, bool allowRotations, bool allowGrowth)`
+         *    - `Packer(const Vec2<PackingSizeType>& initialAtlasSize, bool allowRotations, bool allowGrowth,
+         *              const PackerArgs&... packerArgs)`
          *    - `static bool inputSortingComparator(const Rect<PackingSizeType>& rect1,
          *                                          const Rect<PackingSizeType>& * rect2)`:
          *      Used to sort the input rectangles before packing. The input
@@ -104,20 +134,14 @@ namespace llassetgen {
          *      is insufficient.
          *    - `Vec2<PackingSizeType> atlasSize() const`: Used to retrieve the
          *      final atlas size after packing (not used for fixed size packing).
+         * @param packerArgs
+         *   Further arguments of the packer constructor, e.g. its heuristics.
          */
-        template <class Packer, class InputIter>
-        Packing packAtlas(InputIter sizesBegin, InputIter sizesEnd, bool allowRotations) {
+        template <class Packer, class InputIter, class... PackerArgs>
+        Packing packAtlas(InputIter sizesBegin, InputIter sizesEnd, bool allowRotations,
+                          const PackerArgs&... packerArgs) {
             Packing packing = initPacking(sizesBegin, sizesEnd);
-            packing.atlasSize = predictAtlasSize(packing);
-
-            Packer packer{packing.atlasSize, allowRotations, true};
-            bool success = packAll(packing, packer);
-            // Only fails when a rectangle is wider (and higher, if rotations are enabled)
-            // than the width of the atlas texture, however this should be prevented
-            // by predictAtlasSize.
-            assert(success);
-
-            packing.atlasSize = packer.atlasSize();
+            packFlexible<Packer>(packing, allowRotations, packerArgs...);
             return packing;
         }
 
@@ -127,13 +151,13 @@ namespace llassetgen {
          * @tparam Packer
          *   Refer to flexible size overload.
          */
-        template <class Packer, class InputIter>
+        template <class Packer, class InputIter, class... PackerArgs>
         Packing packAtlas(InputIter sizesBegin, InputIter sizesEnd, bool allowRotations,
-                          const Vec2<PackingSizeType>& fixedAtlasSize) {
+                          const Vec2<PackingSizeType>& fixedAtlasSize, const PackerArgs&... packerArgs) {
             Packing packing = initPacking(sizesBegin, sizesEnd);
             packing.atlasSize = fixedAtlasSize;
 
-            Packer packer{packing.atlasSize, allowRotations, false};
+            Packer packer{packing.atlasSize, allowRotations, false, packerArgs...};
             bool success = packAll(packing, packer);
             if (!success) {
                 packing.rects.clear();
@@ -142,6 +166,61 @@ namespace llassetgen {
             return packing;
         }
 
+        /**
+         * Create a packing onto as many pages of at most the given size as
+         * needed.
+         *
+         * If a flexible size packing fits into one page, it is returned as
+         * is. Otherwise, the pages have exactly the maximum size and are
+         * filled one after the other: each page is offered all rectangles
+         * that did not fit onto the previous ones, in the order of the packer.
+         *
+         * @tparam Packer
+         *   Refer to flexible size overload of packAtlas.
+         * @return
+         *   Resulting packing, with the page of each rectangle in `pages` if
+         *   there is more than one. If a rectangle does not even fit onto an
+         *   empty page, the list of rectangles will be empty.
+         */
+        template <class Packer, class InputIter, class... PackerArgs>
+        Packing packAtlasPages(InputIter sizesBegin, InputIter sizesEnd, bool allowRotations,
+                               const Vec2<PackingSizeType>& maxPageSize, const PackerArgs&... packerArgs) {
+            Packing packing = initPacking(sizesBegin, sizesEnd);
+            Packing singlePage = packing;
+            packFlexible<Packer>(singlePage, allowRotations, packerArgs...);
+            if (singlePage.atlasSize.x <= maxPageSize.x && singlePage.atlasSize.y <= maxPageSize.y) {
+                return singlePage;
+            }
+
+            packing.atlasSize = maxPageSize;
+            packing.pages.assign(packing.rects.size(), 0);
+            std::vector<size_t> remaining = packingOrder<Packer>(packing);
+            for (size_t page = 0; !remaining.empty(); page++) {
+                Packer packer{maxPageSize, allowRotations, false, packerArgs...};
+                std::vector<size_t> rejected;
+                for (size_t i : remaining) {
+                    Rect<PackingSizeType>& rect = packing.rects[i];
+                    Vec2<PackingSizeType> size = rect.size;
+                    if (packer.pack(rect)) {
+                        packing.pages[i] = page;
+                    } else {
+                        // the packer may have tried a rotation
+                        rect.size = size;
+                        rejected.push_back(i);
+                    }
+                }
+
+                if (rejected.size() == remaining.size()) {
+                    packing.rects.clear();
+                    packing.pages.clear();
+                    break;
+                }
+                remaining.swap(rejected);
+            }
+
+            return packing;
+        }
+
         class LLASSETGEN_API BasePacker {
            public:
             Vec2<PackingSizeType> atlasSize() const { return atlasSize_; }
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <llassetgen/packing/Types.h>
+
+namespace llassetgen {
+    namespace internal {
+        /**
+         * Largest value per key, for keys at or above a bound.
+         *
+         * Keeps a multiset of values per key in [0, keyCount) and a max
+         * segment tree over the largest value of each key.
+         */
+        class SuffixMax {
+           public:
+            void reset(size_t keyCount);
+            void insert(PackingSizeType key, PackingSizeType value);
+            void erase(PackingSizeType key, PackingSizeType value);
+
+            /**
+             * The largest value of all keys >= `key`, 0 if there is none.
+             */
+            PackingSizeType maxFrom(PackingSizeType key) const;
+
+           private:
+            void update(size_t key);
+
+            size_t leafCount = 0;
+            std::vector<std::multiset<PackingSizeType>> values;
+            std::vector<PackingSizeType> tree;
+        };
+
+        /**
+         * The free rectangles of a MaxRectsPacker in list order, with the
+         * indices needed to answer its queries without scanning the list.
+         *
+         * The MaxRectsPacker breaks ties between free rectangles by their
+         * position in the list, so the list order is part of its output. The
+         * index keeps that order exactly (including the swaps by which
+         * rectangles are removed) and identifies rectangles by stable ids:
+         *  - a hierarchical grid finds the rectangles overlapping a given one,
+         *  - rectangles of the same width (height) are ordered by position,
+         *  - SuffixMax trees give the widest rectangle of at least a height
+         *    and the highest one of at least a width,
+         *  - each rectangle knows the rectangles it contains or is contained
+         *    in, so pruning only visits those pairs.
+         *
+         * The relations of split rectangles are found in updateRelations: the
+         * rectangles containing a part overlap its corner and are looked up
+         * on the grid levels of at least its size, the ones contained in it
+         * were contained in the split rectangle or are parts themselves.
+         */
+        class FreeRectIndex {
+           public:
+            using Id = size_t;
+            static constexpr Id none = static_cast<Id>(-1);
+
+            /**
+             * Replace the contents by `rects` in an atlas of the given size.
+             */
+            void reset(const Vec2<PackingSizeType>& atlasSize, const std::vector<Rect<PackingSizeType>>& rects);
+            std::vector<Rect<PackingSizeType>> rects() const;
+
+            size_t size() const { return order.size(); }
+            bool empty() const { return order.empty(); }
+            Id idAt(size_t position) const { return order[position]; }
+            size_t position(Id id) const { return slots[id].position; }
+            const Rect<PackingSizeType>& rect(Id id) const { return slots[id].rect; }
+            /**
+             * The ids of the rectangles which contain or are contained in the
+             * given one.
+             */
+            const std::vector<Id>& related(Id id) const { return slots[id].related; }
+            /**
+             * The positions of all rectangles with related ones.
+             */
+            std::vector<size_t> relatedPositions() const;
+
+            /**
+             * Replace the rectangle by the first of `parts` and append the
+             * others, all of which must lie within it. Their relations are
+             * only known after the next updateRelations.
+             */
+            void split(Id id, const std::vector<Rect<PackingSizeType>>& parts);
+            void updateRelations();
+            void swap(size_t position1, size_t position2);
+            void pop();
+
+            /**
+             * The ids of the rectangles overlapping `rect` with a non-zero area.
+             */
+            std::vector<Id> overlapping(const Rect<PackingSizeType>& rect) const;
+
+            /**
+             * The first rectangle in list order with the least score for a
+             * rectangle of the given size, and that score. The score is the
+             * smaller component of (size - free size) in unsigned arithmetic,
+             * the maximum if the rectangle does not fit. Returns `none` if it
+             * fits nowhere. A leftover of 1 on both sides also scores the
+             * maximum, then all rectangles tie and the first one in list order
+             * is returned if the size fits into it, `none` otherwise.
+             */
+            Id bestFit(const Vec2<PackingSizeType>& size, PackingSizeType& score) const;
+
+           private:
+            struct Slot {
+                Rect<PackingSizeType> rect;
+                size_t position;
+                std::vector<Id> related;
+                size_t level, indexInLevel;
+                // split since the last updateRelations, with the ids that may be contained in it
+                bool changed;
+                std::vector<Id> candidates;
+            };
+
+            /**
+             * Rectangles up to the cell size, each in the cell of its
+             * position, so it only reaches into the next cell of either axis.
+             * There is a level for each combination of cell width and height,
+             * so long and thin rectangles get cells of their shape. The cells
+             * are allocated with the first rectangle.
+             */
+            struct GridLevel {
+                Vec2<PackingSizeType> cellSize;
+                Vec2<size_t> cellCount;
+                std::vector<std::vector<Id>> cells;
+                std::vector<Id> ids;
+            };
+
+            Id insert(const Rect<PackingSizeType>& rect);
+            void add(Id id);
+            void remove(Id id);
+            void relate(Id id1, Id id2);
+            std::vector<Id> containees(Id id) const;
+            std::vector<Id> containers(const Rect<PackingSizeType>& rect) const;
+            void move(Id id, size_t position);
+            Id firstWithSide(const std::vector<std::set<std::pair<size_t, Id>>>& groups, PackingSizeType side,
+                             PackingSizeType minOther, bool otherIsHeight) const;
+            std::vector<Id>& cell(Id id);
+
+            std::vector<Slot> slots;
+            std::vector<Id> unusedIds;
+            std::vector<Id> order;
+            std::set<Id> withRelations;
+            std::vector<Id> changedIds;
+
+            // (position, id) of the rectangles by width and by height
+            std::vector<std::set<std::pair<size_t, Id>>> byWidth, byHeight;
+            // key height, value width and vice versa
+            SuffixMax widestFrom, highestFrom;
+
+            std::vector<GridLevel> levels;
+            Vec2<size_t> levelCount;
+        };
+    }
+}
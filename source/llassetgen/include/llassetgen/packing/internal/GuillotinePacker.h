@@ -0,0 +1,43 @@
+#pragma once
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include <llassetgen/llassetgen_api.h>
+#include <llassetgen/packing/Types.h>
+#include <llassetgen/packing/internal/Common.h>
+
+namespace llassetgen {
+    namespace internal {
+        class LLASSETGEN_API GuillotinePacker : public BasePacker {
+           public:
+            GuillotinePacker(const Vec2<PackingSizeType>& initialAtlasSize, bool _allowRotations, bool _allowGrowth,
+                             const GuillotineHeuristics& _heuristics = GuillotineHeuristics{});
+
+            static bool inputSortingComparator(const Rect<PackingSizeType>& rect1, const Rect<PackingSizeType>& rect2);
+
+            bool pack(Rect<PackingSizeType>& rect);
+
+           private:
+            // an edge of a free rectangle: its coordinate, where it starts along the other axis and its length
+            using Edge = std::tuple<PackingSizeType, PackingSizeType, PackingSizeType>;
+
+            LLASSETGEN_NO_EXPORT size_t findFreeRect(Rect<PackingSizeType>& rect) const;
+            LLASSETGEN_NO_EXPORT bool splitHorizontally(const Vec2<PackingSizeType>& freeSize,
+                                                        const Vec2<PackingSizeType>& size) const;
+            LLASSETGEN_NO_EXPORT void grow();
+            LLASSETGEN_NO_EXPORT void addFreeRect(Rect<PackingSizeType> rect);
+            LLASSETGEN_NO_EXPORT void removeFreeRect(size_t index);
+            LLASSETGEN_NO_EXPORT bool takeNeighbour(const std::map<Edge, size_t>& edges, const Edge& edge,
+                                                    Rect<PackingSizeType>& neighbour);
+            LLASSETGEN_NO_EXPORT void indexEdges(size_t index, bool insert);
+
+            GuillotineHeuristics heuristics;
+            // disjoint, together they cover the free space
+            std::vector<Rect<PackingSizeType>> freeList;
+            // the free rectangles by their left, right, top and bottom edges, only used for merging
+            std::map<Edge, size_t> leftEdges, rightEdges, topEdges, bottomEdges;
+        };
+    }
+}
@@ -6,26 +6,25 @@
 #include <llassetgen/llassetgen_api.h>
 #include <llassetgen/packing/Types.h>
 #include <llassetgen/packing/internal/Common.h>
+#include <llassetgen/packing/internal/FreeRectIndex.h>
 
 namespace llassetgen {
     namespace internal {
         class LLASSETGEN_API MaxRectsPacker : public BasePacker {
            public:
-            MaxRectsPacker(const Vec2<PackingSizeType>& initialAtlasSize, bool _allowRotations, bool _allowGrowth)
-                : BasePacker{initialAtlasSize, _allowRotations, _allowGrowth}, freeList{{{0, 0}, initialAtlasSize}} {}
+            MaxRectsPacker(const Vec2<PackingSizeType>& initialAtlasSize, bool _allowRotations, bool _allowGrowth);
 
             static bool inputSortingComparator(const Rect<PackingSizeType>& rect1, const Rect<PackingSizeType>& rect2);
 
             bool pack(Rect<PackingSizeType>& rect);
 
            private:
-            LLASSETGEN_NO_EXPORT std::vector<Rect<PackingSizeType>>::const_iterator findFreeRect(
-                Rect<PackingSizeType>& rect) const;
-            LLASSETGEN_NO_EXPORT void grow();
+            LLASSETGEN_NO_EXPORT FreeRectIndex::Id findFreeRect(Rect<PackingSizeType>& rect) const;
+            LLASSETGEN_NO_EXPORT bool grow();
             LLASSETGEN_NO_EXPORT void cropRects(const Rect<PackingSizeType>& placedRect);
             LLASSETGEN_NO_EXPORT void pruneFreeList();
 
-            std::vector<Rect<PackingSizeType>> freeList;
+            FreeRectIndex freeList;
         };
     }
 }
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+#include <llassetgen/llassetgen_api.h>
+#include <llassetgen/packing/Types.h>
+#include <llassetgen/packing/internal/Common.h>
+
+namespace llassetgen {
+    namespace internal {
+        class LLASSETGEN_API SkylinePacker : public BasePacker {
+           public:
+            SkylinePacker(const Vec2<PackingSizeType>& initialAtlasSize, bool _allowRotations, bool _allowGrowth);
+
+            static bool inputSortingComparator(const Rect<PackingSizeType>& rect1, const Rect<PackingSizeType>& rect2);
+
+            bool pack(Rect<PackingSizeType>& rect);
+
+           private:
+            /**
+             * A horizontal part of the skyline: the atlas is used from the
+             * top down to `y` for the columns [x, x + width).
+             */
+            struct Segment {
+                PackingSizeType x, y, width;
+            };
+
+            LLASSETGEN_NO_EXPORT bool fit(size_t segmentIndex, const Vec2<PackingSizeType>& size,
+                                          PackingSizeType& y) const;
+            LLASSETGEN_NO_EXPORT bool findPosition(Rect<PackingSizeType>& rect, size_t& segmentIndex) const;
+            LLASSETGEN_NO_EXPORT void grow();
+            LLASSETGEN_NO_EXPORT void place(const Rect<PackingSizeType>& rect, size_t segmentIndex);
+
+            std::vector<Segment> skyline;
+        };
+    }
+}
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <llassetgen/Atlas.h>
+
+namespace llassetgen {
+    namespace {
+        /*
+         * The glyphs of a GlyphRenderer are rendered after packing, a glyph that is not an integer multiple of its
+         * Rect (or not the same size, if `exact`) would be written out of bounds, so unlike the assertions of the
+         * image functions, this is checked in release builds too.
+         */
+        void checkGlyphSize(const Image& glyph, const Rect<PackingSizeType>& rect, bool exact) {
+            Vec2<size_t> size = glyph.getSize();
+            bool matches = exact ? size == rect.size
+                                 : rect.size.x > 0 && rect.size.y > 0 && size.x % rect.size.x == 0 &&
+                                       size.y % rect.size.y == 0 && size.x / rect.size.x == size.y / rect.size.y;
+            if (!matches) {
+                throw std::runtime_error("glyph size does not match its packed size");
+            }
+        }
+    }
+
+    Image fontAtlas(const GlyphRenderer& renderGlyphs, Packing packing, uint8_t bitDepth) {
+        Image atlas{packing.atlasSize.x, packing.atlasSize.y, bitDepth};
+        atlas.clear();
+
+        renderGlyphs([&](size_t i, Image& glyph) {
+            assert(i < packing.rects.size());
+            auto& rect = packing.rects[i];
+            checkGlyphSize(glyph, rect, true);
+            if (glyph.getBitDepth() != bitDepth && !(bitDepth == 8 && glyph.getBitDepth() < 8)) {
+                throw std::runtime_error("glyph bit depth does not match the atlas");
+            }
+            Image view = atlas.view(rect.position, rect.position + rect.size);
+            view.copyDataFrom(glyph);
+        });
+        return atlas;
+    }
+
+    namespace {
+        void transformIntoAtlas(const GlyphRenderer& renderGlyphs, const Packing& packing, Image& atlas,
+                                const ImageTransform& distanceTransform, const ImageTransform& downSampling) {
+            renderGlyphs([&](size_t i, Image& glyph) {
+                assert(i < packing.rects.size());
+                auto& rect = packing.rects[i];
+                checkGlyphSize(glyph, rect, false);
+                Image distField =
+                    DistanceTransformWorkspace::local().distanceField(glyph.getWidth(), glyph.getHeight());
+                distanceTransform(glyph, distField);
+
+                Image output = atlas.view(rect.position, rect.position + rect.size);
+                downSampling(output, distField);
+            });
+        }
+
+        void transformIntoAtlas(const GlyphRenderer& renderGlyphs, const Packing& packing, Image& atlas,
+                                const ImageTransform& distanceTransform) {
+            renderGlyphs([&](size_t i, Image& glyph) {
+                assert(i < packing.rects.size());
+                auto& rect = packing.rects[i];
+                checkGlyphSize(glyph, rect, false);
+                Image output = atlas.view(rect.position, rect.position + rect.size);
+                distanceTransform(glyph, output);
+            });
+        }
+
+        void streamAtlas(const GlyphChunkRenderer& renderGlyphs, const Packing& packing,
+                         const std::function<void(Image&, Image&)>& transformGlyph, size_t bandHeight,
+                         const std::function<void(const Image&)>& writeRows) {
+            assert(bandHeight > 0);
+            const auto& rects = packing.rects;
+            std::vector<size_t> order(rects.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(),
+                             [&](size_t a, size_t b) { return rects[a].position.y < rects[b].position.y; });
+            size_t maxRectHeight = 0;
+            for (const auto& rect : rects) {
+                maxRectHeight = std::max<size_t>(maxRectHeight, rect.size.y);
+            }
+
+            // a glyph starting in the current band reaches at most maxRectHeight rows into the following ones
+            const size_t width = packing.atlasSize.x, height = packing.atlasSize.y;
+            Image window{width, bandHeight + maxRectHeight, DistanceTransform::bitDepth};
+            window.fillRect({0, 0}, window.getSize(), DistanceTransform::backgroundVal);
+
+            auto next = order.begin();
+            for (size_t top = 0; top < height; top += bandHeight) {
+                size_t bottom = std::min(top + bandHeight, height);
+                std::vector<size_t> chunk;
+                for (; next != order.end() && rects[*next].position.y < bottom; ++next) {
+                    chunk.push_back(*next);
+                }
+                renderGlyphs(chunk, [&](size_t i, Image& glyph) {
+                    const auto& rect = rects[i];
+                    checkGlyphSize(glyph, rect, false);
+                    Vec2<size_t> position{rect.position.x, rect.position.y - top};
+                    Image output = window.view(position, position + rect.size);
+                    transformGlyph(glyph, output);
+                });
+
+                writeRows(window.view({0, 0}, {width, bottom - top}));
+
+                // move the parts of the glyphs below the band up and clear the rest
+                using OutputType = DistanceTransform::OutputType;
+                for (size_t y = 0; y < maxRectHeight; y++) {
+                    const OutputType* source = window.getRowData<OutputType>(y + bandHeight);
+                    std::copy(source, source + width, window.getRowData<OutputType>(y));
+                }
+                window.fillRect({0, maxRectHeight}, window.getSize(), DistanceTransform::backgroundVal);
+            }
+        }
+    }
+
+    Image Quantization::atlas(Vec2<size_t> size) const {
+        assert(bitDepth == 8 || bitDepth == 16);
+        Image background{1, 1, DistanceTransform::bitDepth};
+        background.setPixel<DistanceTransform::OutputType>({0, 0}, DistanceTransform::backgroundVal);
+        Image quantizedBackground{1, 1, bitDepth};
+        store(background, quantizedBackground);
+
+        Image result{size.x, size.y, bitDepth};
+        if (bitDepth == 8) {
+            result.fillRect<uint8_t>({0, 0}, size, quantizedBackground.getPixel<uint8_t>({0, 0}));
+        } else {
+            result.fillRect<uint16_t>({0, 0}, size, quantizedBackground.getPixel<uint16_t>({0, 0}));
+        }
+        return result;
+    }
+
+    void Quantization::store(const Image& distances, const Image& output) const {
+        using OutputType = DistanceTransform::OutputType;
+        if (!halfFloat) {
+            output.quantize<OutputType>(distances, black, white);
+            return;
+        }
+        assert(bitDepth == 16 && output.getSize() == distances.getSize());
+        for (size_t y = 0; y < output.getHeight(); y++) {
+            const OutputType* source = distances.getRowData<OutputType>(y);
+            std::copy(source, source + output.getWidth(), output.getRowData<Half>(y));
+        }
+    }
+
+    ImageTransform Quantization::distanceTransform(ImageTransform transform) const {
+        Quantization quantization = *this;
+        return [quantization, transform](Image& input, Image& output) {
+            Image distances = DistanceTransformWorkspace::local().sampledField(output.getWidth(), output.getHeight());
+            transform(input, distances);
+            quantization.store(distances, output);
+        };
+    }
+
+    ImageTransform Quantization::downSampling(ImageTransform downSampling) const {
+        Quantization quantization = *this;
+        return [quantization, downSampling](Image& output, Image& input) {
+            Image distances = DistanceTransformWorkspace::local().sampledField(output.getWidth(), output.getHeight());
+            downSampling(distances, input);
+            quantization.store(distances, output);
+        };
+    }
+
+    Image distanceFieldAtlas(const GlyphRenderer& renderGlyphs, Packing packing, ImageTransform distanceTransform,
+                             ImageTransform downSampling) {
+        Image atlas{packing.atlasSize.x, packing.atlasSize.y, DistanceTransform::bitDepth};
+        atlas.fillRect({0, 0}, atlas.getSize(), DistanceTransform::backgroundVal);
+        transformIntoAtlas(renderGlyphs, packing, atlas, distanceTransform, downSampling);
+        return atlas;
+    }
+
+    Image distanceFieldAtlas(const GlyphRenderer& renderGlyphs, Packing packing, ImageTransform distanceTransform) {
+        Image atlas{packing.atlasSize.x, packing.atlasSize.y, DistanceTransform::bitDepth};
+        atlas.fillRect({0, 0}, atlas.getSize(), DistanceTransform::backgroundVal);
+        transformIntoAtlas(renderGlyphs, packing, atlas, distanceTransform);
+        return atlas;
+    }
+
+    Image distanceFieldAtlas(const GlyphRenderer& renderGlyphs, Packing packing, ImageTransform distanceTransform,
+                             ImageTransform downSampling, const Quantization& quantization) {
+        Image atlas = quantization.atlas(packing.atlasSize);
+        transformIntoAtlas(renderGlyphs, packing, atlas, distanceTransform, quantization.downSampling(downSampling));
+        return atlas;
+    }
+
+    Image distanceFieldAtlas(const GlyphRenderer& renderGlyphs, Packing packing, ImageTransform distanceTransform,
+                             const Quantization& quantization) {
+        Image atlas = quantization.atlas(packing.atlasSize);
+        transformIntoAtlas(renderGlyphs, packing, atlas, quantization.distanceTransform(distanceTransform));
+        return atlas;
+    }
+
+    void streamDistanceFieldAtlas(const GlyphChunkRenderer& renderGlyphs, Packing packing,
+                                  ImageTransform distanceTransform, ImageTransform downSampling, size_t bandHeight,
+                                  const std::function<void(const Image&)>& writeRows) {
+        streamAtlas(renderGlyphs, packing,
+                    [&](Image& glyph, Image& output) {
+                        Image distField =
+                            DistanceTransformWorkspace::local().distanceField(glyph.getWidth(), glyph.getHeight());
+                        distanceTransform(glyph, distField);
+                        downSampling(output, distField);
+                    },
+                    bandHeight, writeRows);
+    }
+
+    void streamDistanceFieldAtlas(const GlyphChunkRenderer& renderGlyphs, Packing packing,
+                                  ImageTransform distanceTransform, size_t bandHeight,
+                                  const std::function<void(const Image&)>& writeRows) {
+        streamAtlas(renderGlyphs, packing, distanceTransform, bandHeight, writeRows);
+    }
+
+    size_t streamingBandHeight(const Packing& packing, size_t glyphBytes, size_t maxMemory) {
+        size_t threads = 1;
+#ifdef _OPENMP
+        threads = static_cast<size_t>(omp_get_max_threads());
+#endif
+        size_t maxRectHeight = 0;
+        for (const auto& rect : packing.rects) {
+            maxRectHeight = std::max<size_t>(maxRectHeight, rect.size.y);
+        }
+        const size_t rowBytes = packing.atlasSize.x * sizeof(DistanceTransform::OutputType);
+        const size_t fixedBytes = threads * glyphBytes + maxRectHeight * rowBytes;
+        if (rowBytes == 0 || maxMemory < fixedBytes + rowBytes) {
+            return 0;
+        }
+        return std::min<size_t>((maxMemory - fixedBytes) / rowBytes, std::max<size_t>(packing.atlasSize.y, 1));
+    }
+}
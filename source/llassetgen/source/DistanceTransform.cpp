@@ -1,63 +1,311 @@
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <memory>
+#include <new>
+#include <thread>
 
 #include <llassetgen/DistanceTransform.h>
+#include <llassetgen/internal/Cpu.h>
+#include <llassetgen/internal/LowerEnvelope.h>
+
+namespace {
+    constexpr size_t wavefrontChunkWidth = 64;
+
+    /*
+     * Call `func(x, y)` for every pixel in raster order, where each pixel may depend on the previous pixel of its
+     * row and on the previous row up to one column to its right. The rows are distributed over the threads and
+     * each row waits until the previous one is far enough ahead, so the result is the same as that of a sequential
+     * raster scan.
+     */
+    template <class Func>
+    void rasterWavefront(size_t width, size_t height, Func func) {
+        auto progress = llassetgen::DistanceTransformWorkspace::local().get<std::atomic<size_t>>(
+            llassetgen::DistanceTransformWorkspace::Progress, height);
+        for (size_t y = 0; y < height; ++y) {
+            new (&progress[y]) std::atomic<size_t>(0);
+        }
+
+        const int rows = static_cast<int>(height);
+#pragma omp parallel for schedule(static, 1)
+        for (int row = 0; row < rows; ++row) {
+            auto y = static_cast<size_t>(row);
+            for (size_t chunkBegin = 0; chunkBegin < width; chunkBegin += wavefrontChunkWidth) {
+                size_t chunkEnd = std::min(chunkBegin + wavefrontChunkWidth, width);
+                if (y > 0) {
+                    size_t required = std::min(chunkEnd + 1, width);
+                    while (progress[y - 1].load(std::memory_order_acquire) < required) {
+                        std::this_thread::yield();
+                    }
+                }
+                for (size_t x = chunkBegin; x < chunkEnd; ++x) {
+                    func(x, y);
+                }
+                progress[y].store(chunkEnd, std::memory_order_release);
+            }
+        }
+    }
+}
+
+namespace {
+    /*
+     * Helpers of the anti-aliased Euclidean distance transform, following edtaa3 by Stefan Gustavson.
+     */
+    constexpr double unsetDistance = 1000000.0;
+
+    /*
+     * Distance from the center of an edge pixel with the given coverage to the edge, which is approximated by a line
+     * with the gradient (gx, gy) as its normal.
+     */
+    double edgeDistance(double gx, double gy, double coverage) {
+        if (gx == 0 || gy == 0) {
+            return 0.5 - coverage;
+        }
+        double length = std::sqrt(gx * gx + gy * gy);
+        gx = std::abs(gx / length);
+        gy = std::abs(gy / length);
+        if (gx < gy) {
+            std::swap(gx, gy);
+        }
+        double a1 = 0.5 * gy / gx;
+        if (coverage < a1) {
+            return 0.5 * (gx + gy) - std::sqrt(2.0 * gx * gy * coverage);
+        }
+        if (coverage < 1.0 - a1) {
+            return (0.5 - coverage) * gx;
+        }
+        return -0.5 * (gx + gy) + std::sqrt(2.0 * gx * gy * (1.0 - coverage));
+    }
+
+    /*
+     * Gradient of the coverage at edge pixels (0 < coverage < 1) with a Sobel-like filter, zero everywhere else.
+     */
+    void coverageGradient(const double* coverage, long width, long height, double* gradientX, double* gradientY) {
+        const double sqrt2 = std::sqrt(2.0);
+        std::fill(gradientX, gradientX + width * height, 0.0);
+        std::fill(gradientY, gradientY + width * height, 0.0);
+        for (long y = 1; y < height - 1; ++y) {
+            for (long x = 1; x < width - 1; ++x) {
+                long i = y * width + x;
+                if (coverage[i] <= 0.0 || coverage[i] >= 1.0) {
+                    continue;
+                }
+                double gx = -coverage[i - width - 1] - sqrt2 * coverage[i - 1] - coverage[i + width - 1] +
+                            coverage[i - width + 1] + sqrt2 * coverage[i + 1] + coverage[i + width + 1];
+                double gy = -coverage[i - width - 1] - sqrt2 * coverage[i - width] - coverage[i - width + 1] +
+                            coverage[i + width - 1] + sqrt2 * coverage[i + width] + coverage[i + width + 1];
+                double length = std::sqrt(gx * gx + gy * gy);
+                if (length > 0.0) {
+                    gradientX[i] = gx / length;
+                    gradientY[i] = gy / length;
+                }
+            }
+        }
+    }
+
+    /*
+     * Vector propagation of the distances to the closest edge pixel, which are corrected by the sub-pixel edge
+     * position of that pixel. For the inside distances the coverage is inverted, the gradients stay the same up to
+     * their sign, which edgeDistance ignores.
+     */
+    class CoveragePropagation {
+        const double* coverage;
+        const double* gradientX;
+        const double* gradientY;
+        int32_t* offsetX;
+        int32_t* offsetY;
+        double* distances;
+        long width, height;
+        bool inverted;
+        bool changed = false;
+
+        double coverageAt(long i) const {
+            double value = std::min(std::max(coverage[i], 0.0), 1.0);
+            return inverted ? 1.0 - value : value;
+        }
+
+        void propagate(long x, long y, long dx, long dy) {
+            long neighborX = x + dx, neighborY = y + dy;
+            if (neighborX < 0 || neighborX >= width || neighborY < 0 || neighborY >= height) {
+                return;
+            }
+            long i = y * width + x, neighbor = neighborY * width + neighborX;
+            int32_t candidateX = offsetX[neighbor] - static_cast<int32_t>(dx);
+            int32_t candidateY = offsetY[neighbor] - static_cast<int32_t>(dy);
+            long closest = (y - candidateY) * width + (x - candidateX);
+            double a = coverageAt(closest);
+            if (a == 0.0) {
+                return;
+            }
+            double distance = std::sqrt(double(candidateX) * candidateX + double(candidateY) * candidateY);
+            distance += distance == 0 ? edgeDistance(gradientX[closest], gradientY[closest], a)
+                                      : edgeDistance(candidateX, candidateY, a);
+            const double epsilon = 1e-3;
+            if (distance < distances[i] - epsilon) {
+                offsetX[i] = candidateX;
+                offsetY[i] = candidateY;
+                distances[i] = distance;
+                changed = true;
+            }
+        }
+
+       public:
+        CoveragePropagation(const double* _coverage, const double* _gradientX, const double* _gradientY,
+                            int32_t* _offsetX, int32_t* _offsetY, double* _distances, long _width, long _height,
+                            bool _inverted)
+            : coverage(_coverage),
+              gradientX(_gradientX),
+              gradientY(_gradientY),
+              offsetX(_offsetX),
+              offsetY(_offsetY),
+              distances(_distances),
+              width(_width),
+              height(_height),
+              inverted(_inverted) {}
+
+        void run() {
+            for (long i = 0; i < width * height; ++i) {
+                offsetX[i] = 0;
+                offsetY[i] = 0;
+                double a = coverageAt(i);
+                distances[i] = a <= 0.0 ? unsetDistance : a < 1.0 ? edgeDistance(gradientX[i], gradientY[i], a) : 0.0;
+            }
+
+            do {
+                changed = false;
+                for (long y = 1; y < height; ++y) {
+                    for (long x = 0; x < width; ++x) {
+                        if (distances[y * width + x] > 0) {
+                            propagate(x, y, -1, 0);
+                            propagate(x, y, -1, -1);
+                            propagate(x, y, 0, -1);
+                            propagate(x, y, 1, -1);
+                        }
+                    }
+                    for (long x = width - 2; x >= 0; --x) {
+                        if (distances[y * width + x] > 0) {
+                            propagate(x, y, 1, 0);
+                        }
+                    }
+                }
+                for (long y = height - 2; y >= 0; --y) {
+                    for (long x = width - 1; x >= 0; --x) {
+                        if (distances[y * width + x] > 0) {
+                            propagate(x, y, 1, 0);
+                            propagate(x, y, 1, 1);
+                            propagate(x, y, 0, 1);
+                            propagate(x, y, -1, 1);
+                        }
+                    }
+                    for (long x = 1; x < width; ++x) {
+                        if (distances[y * width + x] > 0) {
+                            propagate(x, y, -1, 0);
+                        }
+                    }
+                }
+            } while (changed);
+        }
+    };
+}
 
 namespace llassetgen {
-    template <typename PixelType, bool flipped, bool invalidBounds>
-    PixelType DistanceTransform::getPixel(PositionType pos) {
-        const Image& image = std::is_same<PixelType, InputType>::value ? input : output;
-        if (invalidBounds && !image.isValid(pos)) {
-            return 0;
+    DistanceTransformWorkspace::DistanceTransformWorkspace()
+        : field(0, 0, DistanceTransform::bitDepth), sampled(0, 0, DistanceTransform::bitDepth), canvas(0, 0, 1) {}
+
+    DistanceTransformWorkspace& DistanceTransformWorkspace::local() {
+        static thread_local DistanceTransformWorkspace workspace;
+        return workspace;
+    }
+
+    void* DistanceTransformWorkspace::reserve(Buffer buffer, size_t bytes) {
+        if (bytes > capacities[buffer]) {
+            buffers[buffer].reset(new uint8_t[bytes]);
+            capacities[buffer] = bytes;
+        }
+        return buffers[buffer].get();
+    }
+
+    Image DistanceTransformWorkspace::distanceField(size_t width, size_t height) {
+        if (width > field.getWidth() || height > field.getHeight()) {
+            field = Image(std::max(width, field.getWidth()), std::max(height, field.getHeight()),
+                          DistanceTransform::bitDepth);
         }
-        if (flipped) {
-            std::swap(pos.x, pos.y);
+        return field.view({0, 0}, {width, height});
+    }
+
+    Image DistanceTransformWorkspace::sampledField(size_t width, size_t height) {
+        if (width > sampled.getWidth() || height > sampled.getHeight()) {
+            sampled = Image(std::max(width, sampled.getWidth()), std::max(height, sampled.getHeight()),
+                            DistanceTransform::bitDepth);
         }
-        return image.getPixel<PixelType>(pos);
+        return sampled.view({0, 0}, {width, height});
     }
 
-    template <typename PixelType, bool flipped>
-    void DistanceTransform::setPixel(PositionType pos, PixelType value) {
-        const Image& image = std::is_same<PixelType, InputType>::value ? input : output;
-        if (flipped) {
-            std::swap(pos.x, pos.y);
+    Image DistanceTransformWorkspace::glyphCanvas(size_t width, size_t height, size_t bitDepth) {
+        if (width > canvas.getWidth() || height > canvas.getHeight() || bitDepth != canvas.getBitDepth()) {
+            canvas = Image(std::max(width, canvas.getWidth()), std::max(height, canvas.getHeight()), bitDepth);
         }
-        image.setPixel<PixelType>(pos, value);
+        return canvas.view({0, 0}, {width, height});
+    }
+
+    void DistanceTransformWorkspace::release() {
+        for (size_t buffer = 0; buffer < BufferCount; ++buffer) {
+            buffers[buffer].reset();
+            capacities[buffer] = 0;
+        }
+        field = Image(0, 0, DistanceTransform::bitDepth);
+        sampled = Image(0, 0, DistanceTransform::bitDepth);
+        canvas = Image(0, 0, 1);
     }
 
     DistanceTransform::DistanceTransform(const Image& _input, const Image& _output) : input(_input), output(_output) {
-        assert(input.getWidth() == output.getWidth() && input.getHeight() == output.getHeight() &&
-               input.getBitDepth() == 1);
+        assert(output.getWidth() > 0 && output.getHeight() > 0 && input.getWidth() % output.getWidth() == 0 &&
+               input.getHeight() % output.getHeight() == 0 && input.getBitDepth() <= 8);
+    }
+
+    void DistanceTransform::setBandLimit(OutputType limit) {
+        assert(limit > 0);
+        bandLimit = limit;
     }
 
     DeadReckoning::PositionType& DeadReckoning::posAt(PositionType pos) {
-        assert(pos.x < input.getWidth() && pos.y < input.getHeight() && posBuffer.get());
+        assert(pos.x < input.getWidth() && pos.y < input.getHeight() && posBuffer);
         return posBuffer[pos.y * input.getWidth() + pos.x];
     }
 
-    void DeadReckoning::transformAt(PositionType pos, PositionType target, OutputType distance) {
+    void DeadReckoning::transformAt(const ImageView<OutputType>& distances, PositionType pos, PositionType target,
+                                    OutputType distance) {
         target += pos;
-        if (output.isValid(target) && getPixel<OutputType>(target) + distance < getPixel<OutputType>(pos)) {
+        if (target.x < distances.getWidth() && target.y < distances.getHeight() &&
+            distances.getPixel(target) + distance < distances.getPixel(pos)) {
             posAt(pos) = target = posAt(target);
-            setPixel<OutputType>(pos, std::sqrt(square(pos.x - target.x) + square(pos.y - target.y)));
+            distances.setPixel(pos, std::sqrt(square(pos.x - target.x) + square(pos.y - target.y)));
         }
     }
 
     void DeadReckoning::transform() {
-        assert(input.getWidth() > 0 && input.getHeight() > 0);
-        posBuffer.reset(new PositionType[input.getWidth() * input.getHeight()]);
+        assert(input.getWidth() > 0 && input.getHeight() > 0 && input.getSize() == output.getSize() &&
+               input.getBitDepth() == 1);
+        const DimensionType width = input.getWidth(), height = input.getHeight();
+        posBuffer = DistanceTransformWorkspace::local().get<PositionType>(DistanceTransformWorkspace::Positions,
+                                                                          width * height);
+        const ImageView<InputType, 1> inside(input);
+        const ImageView<OutputType> distances(output);
 
-        for (DimensionType y = 0; y < input.getHeight(); ++y) {
-            for (DimensionType x = 0; x < input.getWidth(); ++x) {
-                PositionType pos = {x, y};
-                bool center = getPixel<InputType, false>(pos);
-                posAt(pos) = pos;
-                setPixel<OutputType>(pos, (center && (getPixel<InputType, false, true>({x - 1, y}) != center ||
-                                                      getPixel<InputType, false, true>({x + 1, y}) != center ||
-                                                      getPixel<InputType, false, true>({x, y - 1}) != center ||
-                                                      getPixel<InputType, false, true>({x, y + 1}) != center))
-                                              ? 0
-                                              : backgroundVal);
+        const int rows = static_cast<int>(height);
+#pragma omp parallel for
+        for (int row = 0; row < rows; ++row) {
+            auto y = static_cast<DimensionType>(row);
+            auto insideRow = inside.row(y);
+            for (DimensionType x = 0; x < width; ++x) {
+                bool center = insideRow[x];
+                posAt({x, y}) = {x, y};
+                // pixels outside of the input count as background
+                bool edge = center && (x == 0 || !insideRow[x - 1] || x + 1 == width || !insideRow[x + 1] ||
+                                       y == 0 || !inside.getPixel({x, y - 1}) || y + 1 == height ||
+                                       !inside.getPixel({x, y + 1}));
+                distances.setPixel({x, y}, edge ? 0 : backgroundVal);
             }
         }
 
@@ -67,61 +315,66 @@ namespace llassetgen {
                                        {static_cast<DimensionType>(+1), static_cast<DimensionType>(-1)},
                                        {static_cast<DimensionType>(-1), static_cast<DimensionType>( 0)}};
 
-        for (DimensionType y = 0; y < input.getHeight(); ++y) {
-            for (DimensionType x = 0; x < input.getWidth(); ++x) {
-                for (DimensionType i = 0; i < 4; ++i) {
-                    transformAt({x, y}, target[i], distance[i]);
-                }
+        // Both passes only look at the previous pixel and the three neighbors in the previous row (in scan order),
+        // so they can be parallelized as a wavefront over the rows.
+        rasterWavefront(width, height, [&](DimensionType x, DimensionType y) {
+            for (DimensionType i = 0; i < 4; ++i) {
+                transformAt(distances, {x, y}, target[i], distance[i]);
             }
-        }
+        });
 
-        for (DimensionType y = 0; y < input.getHeight(); ++y) {
-            for (DimensionType x = 0; x < input.getWidth(); ++x) {
-                for (DimensionType i = 0; i < 4; ++i) {
-                    transformAt({input.getWidth() - x - 1, input.getHeight() - y - 1}, -(target[3 - i]),
-                                distance[3 - i]);
-                }
+        rasterWavefront(width, height, [&](DimensionType x, DimensionType y) {
+            for (DimensionType i = 0; i < 4; ++i) {
+                transformAt(distances, {width - x - 1, height - y - 1}, -(target[3 - i]), distance[3 - i]);
             }
-        }
+        });
 
-        for (DimensionType y = 0; y < input.getHeight(); ++y) {
-            for (DimensionType x = 0; x < input.getWidth(); ++x) {
-                Vec2<DimensionType> pos(x, y);
-                if (getPixel<InputType, false>(pos)) {
-                    setPixel<OutputType>(pos, -getPixel<OutputType>(pos));
+#pragma omp parallel for
+        for (int row = 0; row < rows; ++row) {
+            auto y = static_cast<DimensionType>(row);
+            auto insideRow = inside.row(y);
+            auto distanceRow = distances.row(y);
+            for (DimensionType x = 0; x < width; ++x) {
+                if (insideRow[x]) {
+                    distanceRow[x] = -distanceRow[x];
                 }
             }
         }
     }
 
-    template <bool flipped, bool fill>
-    void ParabolaEnvelope::edgeDetection(DimensionType offset, DimensionType length) {
+    /*
+     * The ParabolaEnvelope works on raw lines instead of going through Image::getPixel/setPixel: The input is
+     * unpacked to one byte per pixel once, the column pass transposes blocks of columns into the contiguous
+     * columnBuffer and lineBuffer and scatters the results back into the output rows, and the row pass runs in place
+     * on the contiguous output rows. Column blocks and rows are independent of each other and distributed over the
+     * threads, each thread using its own buffers.
+     */
+    template <bool fill>
+    void ParabolaEnvelope::edgeDetection(const InputType* inputLine, DimensionType inputStride,
+                                         OutputType* outputLine, DimensionType length) {
         InputType prevInput = 0;
         DimensionType fillBegin = 0;
         for (DimensionType j = 0; j < length; ++j) {
-            InputType nextInput = getPixel<InputType, flipped>({j, offset});
+            InputType nextInput = inputLine[j * inputStride];
             if (nextInput == prevInput) {
                 continue;
             }
             prevInput = nextInput;
             DimensionType fillEnd = (nextInput) ? j : j - 1;
-            setPixel<OutputType, flipped>({fillEnd, offset}, 0);  // Mark edge
+            outputLine[fillEnd] = 0;  // Mark edge
             if (fill) {
                 for (DimensionType i = fillBegin; i < fillEnd; ++i)
-                    setPixel<OutputType, flipped>(
-                        {i, offset},
+                    outputLine[i] =
                         square(fillBegin == 0
                             ? (fillEnd - i)  // Falling slope
                             : ((i < (fillEnd + fillBegin) / 2) ? i - fillBegin + 1 : fillEnd - i)  // Rising and falling slope
-                        )
-                    );
+                        );
                 fillBegin = fillEnd + 1;
             }
         }
         if (fill) {
             for (DimensionType i = fillBegin; i < length; ++i) {
-                setPixel<OutputType, flipped>(
-                    {i, offset},
+                outputLine[i] =
                     (fillBegin == 0)
                     ? std::numeric_limits<OutputType>::max()  // Empty
                     : square(prevInput
@@ -129,61 +382,334 @@ namespace llassetgen {
                             ? i - fillBegin + 1
                             : length - 1 - i)  // Rising and falling slope
                         : (i - fillBegin + 1)  // Rising slope
-                    )
-                );
+                    );
             }
         }
         if (prevInput) {
-            setPixel<OutputType, flipped>({length - 1, offset}, 0);  // Mark edge
+            outputLine[length - 1] = 0;  // Mark edge
         }
     }
 
-    template <bool flipped>
-    void ParabolaEnvelope::transformLine(DimensionType offset, DimensionType length) {
+    void ParabolaEnvelope::transformLine(const InputType* inputLine, OutputType* outputLine, DimensionType length,
+                                         Parabola* parabolas, DimensionType sampleStep, OutputType* samples) {
+        if (bandLimit < backgroundVal) {
+            transformLineInBand(inputLine, outputLine, length, parabolas, sampleStep, samples);
+            return;
+        }
         parabolas[0].apex = 0;
         parabolas[0].begin = -backgroundVal;
-        parabolas[0].value = getPixel<OutputType, flipped>({0, offset});
+        parabolas[0].value = outputLine[0];
         parabolas[1].begin = +backgroundVal;
         for (DimensionType parabolaIndex = 0, j = 1; j < length; ++j) {
+            OutputType value = outputLine[j];
             OutputType parabolaBegin;
             do {
                 DimensionType apex = parabolas[parabolaIndex].apex;
-                OutputType value = getPixel<OutputType, flipped>({j, offset});
                 parabolaBegin =
                     (value + square(j) - (parabolas[parabolaIndex].value + square(apex))) / (2 * (j - apex));
             } while (parabolaBegin <= parabolas[parabolaIndex--].begin);
             parabolaIndex += 2;
             parabolas[parabolaIndex].apex = j;
             parabolas[parabolaIndex].begin = parabolaBegin;
-            parabolas[parabolaIndex].value = getPixel<OutputType, flipped>({j, offset});
+            parabolas[parabolaIndex].value = value;
             parabolas[parabolaIndex + 1].begin = std::numeric_limits<OutputType>::infinity();
         }
-        for (DimensionType parabolaIndex = 0, j = 0; j < length; ++j) {
+        for (DimensionType parabolaIndex = 0, j = sampleStep / 2; j < length; j += sampleStep) {
             while (parabolas[++parabolaIndex].begin < j)
                 ;
             --parabolaIndex;
-            InputType signMask = getPixel<InputType, flipped>({j, offset});
-            setPixel<OutputType, flipped>(
-                {j, offset},
-                std::sqrt(parabolas[parabolaIndex].value + square(j - parabolas[parabolaIndex].apex))
-                    * (signMask ? -1 : 1)
-            );
+            *samples++ = std::sqrt(parabolas[parabolaIndex].value + square(j - parabolas[parabolaIndex].apex))
+                         * (inputLine[j] ? -1 : 1);
+        }
+    }
+
+    /*
+     * Samples whose squared column distance is beyond the band can not be the closest one for any pixel inside the
+     * band, so they are left out of the envelope. Lines without any samples in the band are filled without building
+     * an envelope, and the sqrt is skipped for pixels outside the band. Inside the band, the results are the same as
+     * those of transformLine.
+     */
+    void ParabolaEnvelope::transformLineInBand(const InputType* inputLine, OutputType* outputLine,
+                                               DimensionType length, Parabola* parabolas, DimensionType sampleStep,
+                                               OutputType* samples) {
+        const OutputType squaredLimit = square(bandLimit);
+        DimensionType parabolaIndex = 0, j = 0;
+        while (j < length && outputLine[j] >= squaredLimit) {
+            ++j;
+        }
+        if (j == length) {
+            for (j = sampleStep / 2; j < length; j += sampleStep) {
+                *samples++ = bandLimit * (inputLine[j] ? -1 : 1);
+            }
+            return;
+        }
+
+        parabolas[0].apex = j;
+        parabolas[0].begin = -backgroundVal;
+        parabolas[0].value = outputLine[j];
+        parabolas[1].begin = +backgroundVal;
+        for (++j; j < length; ++j) {
+            OutputType value = outputLine[j];
+            if (value >= squaredLimit) {
+                continue;
+            }
+            OutputType parabolaBegin;
+            do {
+                DimensionType apex = parabolas[parabolaIndex].apex;
+                parabolaBegin =
+                    (value + square(j) - (parabolas[parabolaIndex].value + square(apex))) / (2 * (j - apex));
+            } while (parabolaBegin <= parabolas[parabolaIndex--].begin);
+            parabolaIndex += 2;
+            parabolas[parabolaIndex].apex = j;
+            parabolas[parabolaIndex].begin = parabolaBegin;
+            parabolas[parabolaIndex].value = value;
+            parabolas[parabolaIndex + 1].begin = std::numeric_limits<OutputType>::infinity();
+        }
+        for (parabolaIndex = 0, j = sampleStep / 2; j < length; j += sampleStep) {
+            while (parabolas[++parabolaIndex].begin < j)
+                ;
+            --parabolaIndex;
+            OutputType squaredDistance = parabolas[parabolaIndex].value + square(j - parabolas[parabolaIndex].apex);
+            *samples++ = (squaredDistance < squaredLimit ? std::sqrt(squaredDistance) : bandLimit)
+                         * (inputLine[j] ? -1 : 1);
+        }
+    }
+
+    constexpr DistanceTransform::DimensionType ParabolaEnvelope::defaultColumnBlockWidth;
+
+    void ParabolaEnvelope::transformColumns(const InputType* inputBuffer, OutputType* rows, DimensionType rowPitch,
+                                            DimensionType rowStep) {
+        const DimensionType width = input.getWidth(), height = input.getHeight();
+        const DimensionType blockWidth = std::min(columnBlockWidth, width);
+
+        const int blocks = static_cast<int>((width + blockWidth - 1) / blockWidth);
+#pragma omp parallel
+        {
+            DistanceTransformWorkspace& workspace = DistanceTransformWorkspace::local();
+            auto columnBuffer = workspace.get<InputType>(DistanceTransformWorkspace::ColumnBuffer, blockWidth * height);
+            auto lineBuffer = workspace.get<OutputType>(DistanceTransformWorkspace::LineBuffer, blockWidth * height);
+
+#pragma omp for
+            for (int block = 0; block < blocks; ++block) {
+                DimensionType blockBegin = block * blockWidth;
+                DimensionType blockEnd = std::min(blockBegin + blockWidth, width);
+                for (DimensionType y = 0; y < height; ++y) {
+                    const InputType* inputRow = &inputBuffer[y * width];
+                    for (DimensionType x = blockBegin; x < blockEnd; ++x) {
+                        columnBuffer[(x - blockBegin) * height + y] = inputRow[x];
+                    }
+                }
+                for (DimensionType x = blockBegin; x < blockEnd; ++x) {
+                    DimensionType lineOffset = (x - blockBegin) * height;
+                    edgeDetection<true>(&columnBuffer[lineOffset], 1, &lineBuffer[lineOffset], height);
+                }
+                for (DimensionType y = rowStep / 2, row = 0; y < height; y += rowStep, ++row) {
+                    OutputType* outputRow = &rows[row * rowPitch];
+                    for (DimensionType x = blockBegin; x < blockEnd; ++x) {
+                        outputRow[x] = lineBuffer[(x - blockBegin) * height + y];
+                    }
+                }
+            }
+        }
+    }
+
+    void ParabolaEnvelope::transformRows(const InputType* inputBuffer) {
+        const DimensionType width = input.getWidth(), height = input.getHeight();
+        OutputType* outputData = output.getRowData<OutputType>(0);
+        const DimensionType outputPitch = output.getRowPitch<OutputType>();
+
+        const int rows = static_cast<int>(height);
+#pragma omp parallel
+        {
+            auto parabolas =
+                DistanceTransformWorkspace::local().get<Parabola>(DistanceTransformWorkspace::Parabolas, width + 1);
+
+#pragma omp for
+            for (int row = 0; row < rows; ++row) {
+                auto y = static_cast<DimensionType>(row);
+                const InputType* inputRow = &inputBuffer[y * width];
+                OutputType* outputRow = &outputData[y * outputPitch];
+                edgeDetection<false>(inputRow, 1, outputRow, width);
+                transformLine(inputRow, outputRow, width, parabolas, 1, outputRow);
+            }
+        }
+    }
+
+    /*
+     * Center downsampling fused into the transform: The column pass only keeps the rows that contain sample points,
+     * and the row pass builds the envelope over the whole row but only evaluates it at the sampled columns.
+     */
+    void ParabolaEnvelope::transformSampled(const InputType* inputBuffer) {
+        const DimensionType width = input.getWidth();
+        const DimensionType xStep = width / output.getWidth(), yStep = input.getHeight() / output.getHeight();
+        OutputType* outputData = output.getRowData<OutputType>(0);
+        const DimensionType outputPitch = output.getRowPitch<OutputType>();
+        auto sampledRows = DistanceTransformWorkspace::local().get<OutputType>(DistanceTransformWorkspace::SampledRows,
+                                                                              width * output.getHeight());
+        transformColumns(inputBuffer, sampledRows, width, yStep);
+
+        const int rows = static_cast<int>(output.getHeight());
+#pragma omp parallel
+        {
+            auto parabolas =
+                DistanceTransformWorkspace::local().get<Parabola>(DistanceTransformWorkspace::Parabolas, width + 1);
+
+#pragma omp for
+            for (int row = 0; row < rows; ++row) {
+                auto y = static_cast<DimensionType>(row);
+                const InputType* inputRow = &inputBuffer[(y * yStep + yStep / 2) * width];
+                OutputType* sampledRow = &sampledRows[y * width];
+                edgeDetection<false>(inputRow, 1, sampledRow, width);
+                transformLine(inputRow, sampledRow, width, parabolas, xStep, &outputData[y * outputPitch]);
+            }
         }
     }
 
     void ParabolaEnvelope::transform() {
-        assert(input.getWidth() > 0 && input.getHeight() > 0);
-        DimensionType length = std::max(input.getWidth(), input.getHeight());
-        parabolas.reset(new Parabola[length + 1]);
-        lineBuffer.reset(new OutputType[length]);
+        assert(input.getWidth() > 0 && input.getHeight() > 0 && input.getBitDepth() == 1 && columnBlockWidth > 0);
+        const DimensionType width = input.getWidth(), height = input.getHeight();
+        auto inputBuffer =
+            DistanceTransformWorkspace::local().get<InputType>(DistanceTransformWorkspace::InputBuffer, width * height);
+
+        const int rows = static_cast<int>(height);
+#pragma omp parallel for
+        for (int row = 0; row < rows; ++row) {
+            auto y = static_cast<DimensionType>(row);
+            input.unpackRow(y, &inputBuffer[y * width]);
+        }
+
+        if (input.getSize() == output.getSize()) {
+            transformColumns(inputBuffer, output.getRowData<OutputType>(0), output.getRowPitch<OutputType>(), 1);
+            transformRows(inputBuffer);
+        } else {
+            transformSampled(inputBuffer);
+        }
+    }
+
+    void AntiAliasedEuclidean::transform() {
+        assert(input.getWidth() > 0 && input.getHeight() > 0 && input.getSize() == output.getSize() &&
+               input.getBitDepth() <= 8);
+        const DimensionType width = input.getWidth(), height = input.getHeight(), size = width * height;
+        DistanceTransformWorkspace& workspace = DistanceTransformWorkspace::local();
+        auto inputBuffer = workspace.get<InputType>(DistanceTransformWorkspace::InputBuffer, size);
+        auto coverage = workspace.get<double>(DistanceTransformWorkspace::Coverage, size);
+        auto gradientX = workspace.get<double>(DistanceTransformWorkspace::GradientX, size);
+        auto gradientY = workspace.get<double>(DistanceTransformWorkspace::GradientY, size);
+        auto offsetX = workspace.get<int32_t>(DistanceTransformWorkspace::OffsetX, size);
+        auto offsetY = workspace.get<int32_t>(DistanceTransformWorkspace::OffsetY, size);
+        auto outside = workspace.get<double>(DistanceTransformWorkspace::Outside, size);
+        auto inside = workspace.get<double>(DistanceTransformWorkspace::Inside, size);
+
+        const double maxCoverage = (1 << input.getBitDepth()) - 1;
+        for (DimensionType y = 0; y < height; ++y) {
+            input.unpackRow(y, &inputBuffer[y * width]);
+            for (DimensionType x = 0; x < width; ++x) {
+                coverage[y * width + x] = inputBuffer[y * width + x] / maxCoverage;
+            }
+        }
+        auto w = static_cast<long>(width), h = static_cast<long>(height);
+        coverageGradient(coverage, w, h, gradientX, gradientY);
+        CoveragePropagation(coverage, gradientX, gradientY, offsetX, offsetY, outside, w, h, false).run();
+        CoveragePropagation(coverage, gradientX, gradientY, offsetX, offsetY, inside, w, h, true).run();
+
+        OutputType* outputData = output.getRowData<OutputType>(0);
+        const DimensionType outputPitch = output.getRowPitch<OutputType>();
+        for (DimensionType y = 0; y < height; ++y) {
+            for (DimensionType x = 0; x < width; ++x) {
+                DimensionType i = y * width + x;
+                outputData[y * outputPitch + x] =
+                    outside[i] >= unsetDistance
+                        ? backgroundVal
+                        : static_cast<OutputType>(std::max(outside[i], 0.0) - std::max(inside[i], 0.0));
+            }
+        }
+    }
 
-        for (DimensionType x = 0; x < input.getWidth(); ++x) {
-            edgeDetection<true, true>(x, input.getHeight());
+    /*
+     * The SimdParabolaEnvelope interleaves groups of rows (pixel j of row l at j * lanes + l), so that the kernels
+     * can load the same pixel of all rows at once. Rows that do not fill a whole group use the scalar row pass.
+     */
+    namespace {
+        using LowerEnvelopeKernel = void (*)(float*, const uint32_t*, size_t, int32_t*, float*, float*);
+
+        struct SimdKernel {
+            LowerEnvelopeKernel kernel;
+            size_t lanes;
+        };
+
+        SimdKernel selectSimdKernel() {
+#ifdef LLASSETGEN_X86
+            if (internal::cpuFeatures().avx2) {
+                return {internal::lowerEnvelopeAvx2, internal::avx2LowerEnvelopeLanes};
+            }
+            if (internal::cpuFeatures().sse41) {
+                return {internal::lowerEnvelopeSse41, internal::sse41LowerEnvelopeLanes};
+            }
+#endif
+            return {nullptr, 1};
         }
 
-        for (DimensionType y = 0; y < input.getHeight(); ++y) {
-            edgeDetection<false, false>(y, input.getWidth());
-            transformLine<false>(y, input.getWidth());
+        const SimdKernel& simdKernel() {
+            static const SimdKernel kernel = selectSimdKernel();
+            return kernel;
+        }
+    }
+
+    DistanceTransform::DimensionType SimdParabolaEnvelope::laneCount() { return simdKernel().lanes; }
+
+    void SimdParabolaEnvelope::transformRows(const InputType* inputBuffer) {
+        const DimensionType width = input.getWidth(), height = input.getHeight();
+        const SimdKernel& simd = simdKernel();
+        if (!simd.kernel || width > internal::lowerEnvelopeMaxLength || bandLimit < backgroundVal) {
+            ParabolaEnvelope::transformRows(inputBuffer);
+            return;
+        }
+
+        const DimensionType lanes = simd.lanes;
+        OutputType* outputData = output.getRowData<OutputType>(0);
+        const DimensionType outputPitch = output.getRowPitch<OutputType>();
+
+        const int groups = static_cast<int>(height / lanes);
+        const int rows = static_cast<int>(height);
+#pragma omp parallel
+        {
+            DistanceTransformWorkspace& workspace = DistanceTransformWorkspace::local();
+            auto lines = workspace.get<OutputType>(DistanceTransformWorkspace::SimdLines, width * lanes);
+            auto signMasks = workspace.get<uint32_t>(DistanceTransformWorkspace::SimdSignMasks, width * lanes);
+            auto apexes = workspace.get<int32_t>(DistanceTransformWorkspace::SimdApexes, (width + 1) * lanes);
+            auto begins = workspace.get<OutputType>(DistanceTransformWorkspace::SimdBegins, (width + 1) * lanes);
+            auto values = workspace.get<OutputType>(DistanceTransformWorkspace::SimdValues, (width + 1) * lanes);
+            auto parabolas = workspace.get<Parabola>(DistanceTransformWorkspace::Parabolas, width + 1);
+
+#pragma omp for
+            for (int group = 0; group < groups; ++group) {
+                for (DimensionType l = 0; l < lanes; ++l) {
+                    DimensionType y = group * lanes + l;
+                    const InputType* inputRow = &inputBuffer[y * width];
+                    OutputType* outputRow = &outputData[y * outputPitch];
+                    edgeDetection<false>(inputRow, 1, outputRow, width);
+                    for (DimensionType j = 0; j < width; ++j) {
+                        lines[j * lanes + l] = outputRow[j];
+                        signMasks[j * lanes + l] = inputRow[j] ? 0x80000000u : 0;
+                    }
+                }
+                simd.kernel(lines, signMasks, width, apexes, begins, values);
+                for (DimensionType l = 0; l < lanes; ++l) {
+                    OutputType* outputRow = &outputData[(group * lanes + l) * outputPitch];
+                    for (DimensionType j = 0; j < width; ++j) {
+                        outputRow[j] = lines[j * lanes + l];
+                    }
+                }
+            }
+
+#pragma omp for
+            for (int row = groups * static_cast<int>(lanes); row < rows; ++row) {
+                auto y = static_cast<DimensionType>(row);
+                const InputType* inputRow = &inputBuffer[y * width];
+                OutputType* outputRow = &outputData[y * outputPitch];
+                edgeDetection<false>(inputRow, 1, outputRow, width);
+                transformLine(inputRow, outputRow, width, parabolas, 1, outputRow);
+            }
         }
     }
 }
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <llassetgen/FntWriter.h>
@@ -44,6 +45,7 @@ namespace llassetgen {
         maxYBearing = 0;
         scalingFactor = _scalingFactor;
         padding = _padding;
+        channels = 15;
     }
 
     void FntWriter::setFontInfo() {
@@ -91,7 +93,8 @@ namespace llassetgen {
      * Returns a bool, stating wether the charArea was used (true) or ignored (false). This makes it easier to use
      * this function while iterating over charcodes and charAreas.
      */
-    bool FntWriter::setCharInfo(FT_ULong charcode, Rect<PackingSizeType> charArea, std::set<FT_ULong> charsWithoutRect) {
+    bool FntWriter::setCharInfo(FT_ULong charcode, Rect<PackingSizeType> charArea, std::set<FT_ULong> charsWithoutRect,
+                                int page) {
 
         size_t charAreaPosX;
         size_t charAreaPosY;
@@ -131,14 +134,14 @@ namespace llassetgen {
         charInfo.xAdvance = from_16_16_fixed_precision(face->glyph->linearHoriAdvance);
         charInfo.xOffset = from_26_6_fixed_precision(face->glyph->metrics.horiBearingX);
         charInfo.yOffset = yBearing;
-        charInfo.page = 1;
-        charInfo.chnl = 15;
+        charInfo.page = page;
+        charInfo.chnl = channels;
         charInfos.push_back(charInfo);
 
         return charIsDepictable;
     }
 
-    void FntWriter::setCharInfo(FT_ULong charcode, Rect<PackingSizeType> charArea) {
+    void FntWriter::setCharInfo(FT_ULong charcode, Rect<PackingSizeType> charArea, int page) {
         FT_UInt gindex = FT_Get_Char_Index(face, charcode);
         FT_Load_Glyph(face, gindex, FT_LOAD_DEFAULT);
 
@@ -155,8 +158,8 @@ namespace llassetgen {
         charInfo.xAdvance = from_16_16_fixed_precision(face->glyph->linearHoriAdvance);
         charInfo.xOffset = from_26_6_fixed_precision(face->glyph->metrics.horiBearingX);
         charInfo.yOffset = yBearing;
-        charInfo.page = 1;
-        charInfo.chnl = 15;
+        charInfo.page = page;
+        charInfo.chnl = channels;
         charInfos.push_back(charInfo);
     }
 
@@ -187,13 +190,20 @@ namespace llassetgen {
     }
 
     void FntWriter::setAtlasProperties(Vec2<PackingSizeType> size) {
+        setAtlasProperties(size, {faceName + ".png"});
+    }
+
+    void FntWriter::setAtlasProperties(Vec2<PackingSizeType> size, std::vector<std::string> _pageFiles) {
         // collect commonInfo
         fontCommon.scaleW = size.x;
         fontCommon.scaleH = size.y;
-        fontCommon.pages = 1;
+        fontCommon.pages = _pageFiles.size();
         fontCommon.isPacked = 0;
+        pageFiles = std::move(_pageFiles);
     }
 
+    void FntWriter::setChannels(uint8_t _channels) { channels = _channels; }
+
     void FntWriter::saveFnt(std::string filepath) {
         // ascent is defined as "The distance from the baseline to the highest or upper grid coordinate used to
         // place an outline point." So set the maximum bearing over all glyphs as the overall ascent.
@@ -244,7 +254,7 @@ namespace llassetgen {
         for (int i = 0; i < fontCommon.pages; i++) {
             fntFile << "page "
                     << "id=" << i << " "
-                    << "file=\"" << faceName << ".png" << "\"" << std::endl;
+                    << "file=\"" << pageFiles[i] << "\"" << std::endl;
         }
 
         // write char count
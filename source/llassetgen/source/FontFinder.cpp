@@ -6,17 +6,88 @@
 #include <wingdi.h>
 #endif
 
+#include <cassert>
+#include <exception>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <numeric>
 
 #include <llassetgen/FontFinder.h>
+#include <llassetgen/Schedule.h>
 
 namespace llassetgen {
+    namespace {
+        enum class GlyphStatus { Rendered, Missing, Failed, NotDepictable };
+
+        /*
+         * Load (and render) a glyph into the glyph slot of the face.
+         */
+        GlyphStatus loadGlyph(FT_Face face, unsigned long glyph, FT_Int32 loadFlags, FT_Error& err) {
+            FT_UInt charIndex = FT_Get_Char_Index(face, static_cast<FT_ULong>(glyph));
+            if (charIndex == 0) {
+                return GlyphStatus::Missing;
+            }
+            err = FT_Load_Glyph(face, charIndex, loadFlags);
+            if (err) {
+                return GlyphStatus::Failed;
+            }
+            // without rendering, FT_Load_Glyph presets the metrics of the bitmap that rendering would produce
+            const FT_Bitmap& bitmap = face->glyph->bitmap;
+            bool depictable =
+                (loadFlags & FT_LOAD_RENDER) ? bitmap.buffer != nullptr : bitmap.width > 0 && bitmap.rows > 0;
+            return depictable ? GlyphStatus::Rendered : GlyphStatus::NotDepictable;
+        }
+
+        /*
+         * A face of its own for the calling thread, FreeType objects must not be shared between threads.
+         */
+        class ThreadFace {
+            FT_Library library = nullptr;
+
+           public:
+            FT_Face face = nullptr;
+            bool ready;
+
+            ThreadFace(const std::vector<FT_Byte>& fontData, int size) {
+                ready = FT_Init_FreeType(&library) == 0 &&
+                        FT_New_Memory_Face(library, fontData.data(), static_cast<FT_Long>(fontData.size()), 0,
+                                           &face) == 0 &&
+                        FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(size)) == 0;
+            }
+
+            ~ThreadFace() {
+                if (face) {
+                    FT_Done_Face(face);
+                }
+                if (library) {
+                    FT_Done_FreeType(library);
+                }
+            }
+        };
+
+        void reportGlyph(unsigned long glyph, GlyphStatus status, FT_Error err) {
+            if (status == GlyphStatus::Missing) {
+                std::cerr << "Omitting glyph with code " << glyph << ", because the Font does not contain that glyph."
+                          << std::endl;
+            } else if (status == GlyphStatus::Failed) {
+                std::cerr << "Omitting glyph with code  " << glyph << "because of Error : " << err << std::endl;
+            } else if (status == GlyphStatus::NotDepictable) {
+                // standard behaviour for space char
+                std::cerr << "Note: Glyph with code " << glyph << " is not depictable, but will appear in the fnt-File."
+                          << std::endl;
+            }
+        }
+    }
+
     FontFinder FontFinder::fromPath(const std::string& fontPath) {
         FontFinder fontFinder{};
         FT_Error err = FT_New_Face(freetype, fontPath.c_str(), 0, &fontFinder.fontFace);
         if (err) {
             throw std::runtime_error("font could not be loaded");
         }
+        fontFinder.fontPath = fontPath;
         return fontFinder;
     }
 
@@ -104,36 +175,205 @@ namespace llassetgen {
     }
 
     std::vector<Image> FontFinder::renderGlyphs(const std::set<unsigned long>& glyphs, int size, size_t padding,
-                                                size_t divisibleBy) {
+                                                size_t divisibleBy, bool antiAliased) {
         setFontSize(size);
+        const FT_Int32 loadFlags = FT_LOAD_RENDER | (antiAliased ? FT_LOAD_TARGET_NORMAL : FT_LOAD_TARGET_MONO);
 
         std::vector<Image> v;
         v.reserve(glyphs.size());
         for (const auto glyph : glyphs) {
+            FT_Error err = 0;
+            GlyphStatus status = loadGlyph(fontFace, glyph, loadFlags, err);
+            reportGlyph(glyph, status, err);
+            if (status == GlyphStatus::NotDepictable) {
+                nonDepictableChars.insert(static_cast<FT_ULong>(glyph));
+            } else if (status == GlyphStatus::Rendered) {
+                Image img = {fontFace->glyph->bitmap, padding, divisibleBy};
+                v.push_back(std::move(img));
+            }
+        }
+        return v;
+    }
 
-            FT_UInt charIndex = FT_Get_Char_Index(fontFace, static_cast<FT_ULong>(glyph));
-            if (charIndex == 0) {
-                std::cerr << "Omitting glyph with code " << glyph << ", because the Font does not contain that glyph." << std::endl;
-                continue;
+    void FontFinder::loadFontData() {
+        std::ifstream file(fontPath, std::ifstream::binary | std::ifstream::ate);
+        if (!file.good()) {
+            throw std::runtime_error("font could not be loaded");
+        }
+        fontData.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(fontData.data()), fontData.size());
+    }
+
+    std::vector<Image> FontFinder::renderGlyphsParallel(const std::set<unsigned long>& glyphs, int size,
+                                                        size_t padding, size_t divisibleBy, bool antiAliased) {
+        setFontSize(size);
+        if (fontData.empty()) {
+            loadFontData();
+        }
+        const FT_Int32 loadFlags = FT_LOAD_RENDER | (antiAliased ? FT_LOAD_TARGET_NORMAL : FT_LOAD_TARGET_MONO);
+
+        const std::vector<unsigned long> glyphCodes(glyphs.begin(), glyphs.end());
+        const int glyphCount = static_cast<int>(glyphCodes.size());
+        std::vector<std::unique_ptr<Image>> images(glyphCodes.size());
+        std::vector<GlyphStatus> statuses(glyphCodes.size());
+        std::vector<FT_Error> errors(glyphCodes.size(), 0);
+        bool faceFailed = false;
+
+        internal::LoopTimer timer;
+#pragma omp parallel
+        {
+            ThreadFace threadFace(fontData, size);
+            if (!threadFace.ready) {
+#pragma omp atomic write
+                faceFailed = true;
             }
 
-            FT_Error err = FT_Load_Glyph(fontFace, charIndex, FT_LOAD_RENDER | FT_LOAD_TARGET_MONO);
-            if (err) {
-                std::cerr << "Omitting glyph with code  " << glyph << "because of Error : " << err << std::endl;
-                continue;
+            // the sizes are not known before rendering, the dynamic schedule balances them anyway
+#pragma omp for schedule(dynamic)
+            for (int i = 0; i < glyphCount; i++) {
+                if (!threadFace.ready) {
+                    continue;
+                }
+                double startTime = timer.start();
+                statuses[i] = loadGlyph(threadFace.face, glyphCodes[i], loadFlags, errors[i]);
+                if (statuses[i] == GlyphStatus::Rendered) {
+                    images[i].reset(new Image(threadFace.face->glyph->bitmap, padding, divisibleBy));
+                }
+                timer.done(startTime);
             }
+        }
+        if (faceFailed) {
+            throw std::runtime_error("font could not be loaded");
+        }
 
-            FT_Bitmap& bitmap = fontFace->glyph->bitmap;
-            if (bitmap.buffer == nullptr) {
-                // standard behaviour for space char
-                std::cerr << "Note: Glyph with code " << glyph << " is not depictable, but will appear in the fnt-File."
-                          << std::endl;
+        // report and collect in glyph order, like renderGlyphs
+        std::vector<Image> v;
+        v.reserve(glyphCodes.size());
+        for (size_t i = 0; i < glyphCodes.size(); i++) {
+            reportGlyph(glyphCodes[i], statuses[i], errors[i]);
+            if (statuses[i] == GlyphStatus::NotDepictable) {
+                nonDepictableChars.insert(static_cast<FT_ULong>(glyphCodes[i]));
+            } else if (statuses[i] == GlyphStatus::Rendered) {
+                v.push_back(std::move(*images[i]));
+            }
+        }
+        return v;
+    }
+
+    std::vector<GlyphOutline> FontFinder::loadOutlines(const std::set<unsigned long>& glyphs, int size,
+                                                       size_t padding, size_t divisibleBy) {
+        setFontSize(size);
+        const FT_Int32 loadFlags = FT_LOAD_NO_BITMAP | FT_LOAD_TARGET_MONO;
+
+        std::vector<GlyphOutline> v;
+        v.reserve(glyphs.size());
+        for (const auto glyph : glyphs) {
+            FT_Error err = 0;
+            GlyphStatus status = loadGlyph(fontFace, glyph, loadFlags, err);
+            if (status == GlyphStatus::Rendered && fontFace->glyph->format != FT_GLYPH_FORMAT_OUTLINE) {
+                status = GlyphStatus::Failed;
+            }
+            reportGlyph(glyph, status, err);
+            if (status == GlyphStatus::NotDepictable) {
                 nonDepictableChars.insert(static_cast<FT_ULong>(glyph));
-            } else {
-                Image img = {bitmap, padding, divisibleBy};
-                v.push_back(std::move(img));
+            } else if (status == GlyphStatus::Rendered) {
+                FT_GlyphSlot slot = fontFace->glyph;
+                GlyphOutline glyphOutline{Outline(slot->outline),
+                                          {static_cast<double>(slot->bitmap_left) - padding,
+                                           static_cast<double>(slot->bitmap_top) + padding},
+                                          {Image::divisiblePadding(slot->bitmap.width, padding, divisibleBy),
+                                           Image::divisiblePadding(slot->bitmap.rows, padding, divisibleBy)}};
+                v.push_back(std::move(glyphOutline));
             }
         }
         return v;
     }
+
+    std::map<unsigned long, Vec2<size_t>> FontFinder::glyphSizes(const std::set<unsigned long>& glyphs, int size,
+                                                                 size_t padding, size_t divisibleBy,
+                                                                 bool antiAliased) {
+        setFontSize(size);
+        // the same flags as for rendering (without FT_LOAD_RENDER), such that embedded bitmaps are measured as well
+        const FT_Int32 loadFlags = antiAliased ? FT_LOAD_TARGET_NORMAL : FT_LOAD_TARGET_MONO;
+
+        std::map<unsigned long, Vec2<size_t>> sizes;
+        for (const auto glyph : glyphs) {
+            FT_Error err = 0;
+            GlyphStatus status = loadGlyph(fontFace, glyph, loadFlags, err);
+            reportGlyph(glyph, status, err);
+            if (status == GlyphStatus::NotDepictable) {
+                nonDepictableChars.insert(static_cast<FT_ULong>(glyph));
+            } else if (status == GlyphStatus::Rendered) {
+                const FT_Bitmap& bitmap = fontFace->glyph->bitmap;
+                sizes[glyph] = {Image::divisiblePadding(bitmap.width, padding, divisibleBy),
+                                Image::divisiblePadding(bitmap.rows, padding, divisibleBy)};
+            }
+        }
+        return sizes;
+    }
+
+    void FontFinder::renderGlyphs(const std::vector<unsigned long>& glyphs, int size, size_t padding,
+                                  size_t divisibleBy, bool antiAliased,
+                                  const std::function<void(size_t, Image&)>& consumer,
+                                  const std::vector<size_t>& costs) {
+        assert(costs.empty() || costs.size() == glyphs.size());
+        if (fontData.empty()) {
+            loadFontData();
+        }
+        const FT_Int32 loadFlags = FT_LOAD_RENDER | (antiAliased ? FT_LOAD_TARGET_NORMAL : FT_LOAD_TARGET_MONO);
+
+        std::vector<size_t> order = largestFirst(costs);
+        if (costs.empty()) {
+            order.resize(glyphs.size());
+            std::iota(order.begin(), order.end(), 0);
+        }
+        const int glyphCount = static_cast<int>(glyphs.size());
+        const unsigned char pixelMode = antiAliased ? FT_PIXEL_MODE_GRAY : FT_PIXEL_MODE_MONO;
+        bool failed = false;
+        // exceptions must not leave the parallel region, the first one is rethrown after it
+        std::exception_ptr error;
+        internal::LoopTimer timer;
+#pragma omp parallel
+        {
+            ThreadFace threadFace(fontData, size);
+#pragma omp for schedule(dynamic)
+            for (int k = 0; k < glyphCount; k++) {
+                const size_t i = order[k];
+                double startTime = timer.start();
+                FT_Error err = 0;
+                if (!threadFace.ready ||
+                    loadGlyph(threadFace.face, glyphs[i], loadFlags, err) != GlyphStatus::Rendered) {
+#pragma omp atomic write
+                    failed = true;
+                    continue;
+                }
+                const FT_Bitmap& bitmap = threadFace.face->glyph->bitmap;
+                try {
+                    // e.g. an embedded 1 bit bitmap when rendering anti-aliased
+                    if (bitmap.pixel_mode != pixelMode) {
+                        throw std::runtime_error("glyph " + std::to_string(glyphs[i]) +
+                                                 " was rendered with an unexpected pixel mode");
+                    }
+                    Image canvas = DistanceTransformWorkspace::local().glyphCanvas(
+                        Image::divisiblePadding(bitmap.width, padding, divisibleBy),
+                        Image::divisiblePadding(bitmap.rows, padding, divisibleBy), antiAliased ? 8 : 1);
+                    canvas.loadPadded(bitmap, padding);
+                    consumer(i, canvas);
+                } catch (...) {
+#pragma omp critical(renderGlyphsError)
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+                timer.done(startTime);
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if (failed) {
+            throw std::runtime_error("glyph could not be rendered");
+        }
+    }
 }
@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -22,8 +25,304 @@
 // clang-format on
 
 #include <llassetgen/Image.h>
+#include <llassetgen/ImageView.h>
+#include <llassetgen/internal/Downsampling.h>
 
 namespace llassetgen {
+    namespace {
+        /*
+         * The type to sum up pixels in, half floats are summed as floats.
+         */
+        template <typename pixelType>
+        struct Accumulator {
+            using type = pixelType;
+        };
+
+        template <>
+        struct Accumulator<Half> {
+            using type = float;
+        };
+
+        uint64_t fromBigEndian(uint64_t word) {
+#if defined(_MSC_VER)
+            return _byteswap_uint64(word);
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            return word;
+#else
+            return __builtin_bswap64(word);
+#endif
+        }
+
+        /*
+         * Packed rows store the first pixel in the most significant bits, so a run of bits reads like a big endian
+         * number. These load 8 bytes into a word and store the top 7 bytes of a word back, a single unaligned
+         * memory access each.
+         */
+        uint64_t loadWord(const uint8_t* bytes) {
+            uint64_t word;
+            memcpy(&word, bytes, sizeof(word));
+            return fromBigEndian(word);
+        }
+
+        void storeSevenBytes(uint8_t* bytes, uint64_t word) {
+            word = fromBigEndian(word);
+            memcpy(bytes, &word, 7);
+        }
+
+        /*
+         * Like loadWord and storeSevenBytes, but for up to 8 bytes one by one, for the ends of a run.
+         */
+        uint64_t loadWord(const uint8_t* bytes, size_t count) {
+            uint64_t word = 0;
+            for (size_t i = 0; i < count; i++) {
+                word |= static_cast<uint64_t>(bytes[i]) << (56 - 8 * i);
+            }
+            return word;
+        }
+
+        void storeWord(uint8_t* bytes, size_t count, uint64_t word) {
+            for (size_t i = 0; i < count; i++) {
+                bytes[i] = static_cast<uint8_t>(word >> (56 - 8 * i));
+            }
+        }
+
+        /*
+         * Replace the bits of `mask` in a byte which other threads may be writing to at the same time, e.g. the
+         * first byte of a glyph row in a packed atlas that also holds the last pixels of its left neighbour. The
+         * bits of the other threads are not touched, so two atomic updates suffice.
+         */
+        void mergeByte(uint8_t& byte, uint8_t mask, uint8_t bits) {
+            auto keep = static_cast<uint8_t>(~mask), set = static_cast<uint8_t>(bits & mask);
+#pragma omp atomic
+            byte &= keep;
+#pragma omp atomic
+            byte |= set;
+        }
+
+        /*
+         * Copy `length` bits from `src` starting at bit `srcOffset` to `dst` starting at bit `dstOffset`. The bits
+         * around the destination range are kept, only the bytes holding source bits are read.
+         *
+         * The partially covered bytes at both ends of the destination range are merged atomically, the bytes in
+         * between belong to the destination range only. Hence, non-overlapping ranges may be written concurrently
+         * even when they share bytes. The bytes in between are moved 56 bits at a time when the offsets differ: one
+         * unaligned 8 byte load, shifted by the bit offset, covers 7 destination bytes. The source bits of those 7
+         * bytes span exactly 8 source bytes, so nothing outside the source range is read.
+         */
+        void blitBits(uint8_t* dst, size_t dstOffset, const uint8_t* src, size_t srcOffset, size_t length) {
+            dst += dstOffset / 8;
+            dstOffset %= 8;
+            src += srcOffset / 8;
+            srcOffset %= 8;
+            auto readBits = [&](size_t bit, size_t bits) {
+                return loadWord(src + bit / 8, (bit % 8 + bits + 7) / 8) << (bit % 8);
+            };
+
+            if (dstOffset != 0) {
+                size_t bits = std::min(8 - dstOffset, length);
+                auto mask = static_cast<uint8_t>(static_cast<uint8_t>(0xFF00 >> bits) >> dstOffset);
+                mergeByte(*dst, mask, static_cast<uint8_t>(readBits(srcOffset, bits) >> (56 + dstOffset)));
+                dst++;
+                srcOffset += bits;
+                length -= bits;
+            }
+
+            size_t bytes = length / 8;
+            if (srcOffset % 8 == 0) {
+                memcpy(dst, src + srcOffset / 8, bytes);
+            } else {
+                // with a bit offset, the 7 bytes of a chunk are spread over 8 source bytes
+                const uint8_t* chunkSrc = src + srcOffset / 8;
+                const size_t shift = srcOffset % 8;
+                size_t done = 0;
+                for (; done + 7 <= bytes; done += 7) {
+                    storeSevenBytes(dst + done, loadWord(chunkSrc + done) << shift);
+                }
+                if (done < bytes) {
+                    storeWord(dst + done, bytes - done, readBits(srcOffset + 8 * done, 8 * (bytes - done)));
+                }
+            }
+
+            if (length % 8 != 0) {
+                auto mask = static_cast<uint8_t>(0xFF << (8 - length % 8));
+                mergeByte(dst[bytes], mask, static_cast<uint8_t>(readBits(srcOffset + 8 * bytes, length % 8) >> 56));
+            }
+        }
+
+        /*
+         * Set `length` bits starting at bit `offset` to `pattern`, a byte of repeated pixel values. Like blitBits,
+         * the bytes at both ends are merged atomically.
+         */
+        void fillBits(uint8_t* dst, size_t offset, size_t length, uint8_t pattern) {
+            dst += offset / 8;
+            offset %= 8;
+            if (offset != 0) {
+                size_t bits = std::min(8 - offset, length);
+                mergeByte(*dst, static_cast<uint8_t>(static_cast<uint8_t>(0xFF00 >> bits) >> offset), pattern);
+                dst++;
+                length -= bits;
+            }
+            memset(dst, pattern, length / 8);
+            if (length % 8 != 0) {
+                mergeByte(dst[length / 8], static_cast<uint8_t>(0xFF << (8 - length % 8)), pattern);
+            }
+        }
+
+        /*
+         * Stand-in for an ImageView when the bit depth of the image differs from the pixel type (e.g. reading a
+         * packed 1 bit image as uint8_t), goes through the bit depth checks of Image::getPixel and Image::setPixel.
+         */
+        template <typename pixelType>
+        struct DynamicView {
+            const Image& image;
+
+            Vec2<size_t> getSize() const { return image.getSize(); }
+            pixelType getPixel(Vec2<size_t> pos) const { return image.getPixel<pixelType>(pos); }
+            void setPixel(Vec2<size_t> pos, pixelType value) const { image.setPixel<pixelType>(pos, value); }
+        };
+
+        /*
+         * The downsamplings are written against views, so that the common case of matching bit depths gets the
+         * pixel access inlined and only mismatched formats pay for the dynamic dispatch.
+         */
+        template <typename pixelType>
+        struct CenterDownsampling {
+            template <typename DstView, typename SrcView>
+            void operator()(const DstView& dst, const SrcView& src) const {
+                size_t x_scale = src.getSize().x / dst.getSize().x, y_scale = src.getSize().y / dst.getSize().y;
+                for (size_t y = 0; y < dst.getSize().y; y++) {
+                    for (size_t x = 0; x < dst.getSize().x; x++) {
+                        dst.setPixel({x, y}, src.getPixel({x * x_scale + x_scale / 2, y * y_scale + y_scale / 2}));
+                    }
+                }
+            }
+        };
+
+        template <typename pixelType>
+        struct AverageDownsampling {
+            template <typename DstView, typename SrcView>
+            void operator()(const DstView& dst, const SrcView& src) const {
+                size_t x_scale = src.getSize().x / dst.getSize().x, y_scale = src.getSize().y / dst.getSize().y;
+                for (size_t y = 0; y < dst.getSize().y; y++) {
+                    for (size_t x = 0; x < dst.getSize().x; x++) {
+                        typename Accumulator<pixelType>::type value = 0;
+                        for (size_t j = 0; j < y_scale; j++) {
+                            for (size_t i = 0; i < x_scale; i++) {
+                                value += src.getPixel({x * x_scale + i, y * y_scale + j});
+                            }
+                        }
+                        dst.setPixel({x, y}, static_cast<pixelType>(value / (x_scale * y_scale)));
+                    }
+                }
+            }
+        };
+
+        template <typename pixelType>
+        struct MinDownsampling {
+            template <typename DstView, typename SrcView>
+            void operator()(const DstView& dst, const SrcView& src) const {
+                size_t x_scale = src.getSize().x / dst.getSize().x, y_scale = src.getSize().y / dst.getSize().y;
+                for (size_t y = 0; y < dst.getSize().y; y++) {
+                    for (size_t x = 0; x < dst.getSize().x; x++) {
+                        // not numeric_limits::max, which is less than an infinite float
+                        auto value = static_cast<pixelType>(src.getPixel({x * x_scale, y * y_scale}));
+                        for (size_t j = 0; j < y_scale; j++) {
+                            for (size_t i = 0; i < x_scale; i++) {
+                                value = std::min<pixelType>(value, src.getPixel({x * x_scale + i, y * y_scale + j}));
+                            }
+                        }
+                        dst.setPixel({x, y}, value);
+                    }
+                }
+            }
+        };
+
+        template <typename pixelType, typename Downsampling, typename DstView>
+        void downsample(const DstView& dst, const Image& src, const Downsampling& downsampling) {
+            if (src.getBitDepth() == 8 * sizeof(pixelType)) {
+                downsampling(dst, ImageView<pixelType>(src));
+            } else {
+                downsampling(dst, DynamicView<pixelType>{src});
+            }
+        }
+
+        template <typename pixelType, typename Downsampling>
+        void downsample(const Image& dst, const Image& src, const Downsampling& downsampling) {
+            if (dst.getBitDepth() == 8 * sizeof(pixelType)) {
+                downsample<pixelType>(ImageView<pixelType>(dst), src, downsampling);
+            } else {
+                downsample<pixelType>(DynamicView<pixelType>{dst}, src, downsampling);
+            }
+        }
+
+        struct DownsamplingKernels {
+            internal::DownsampleRowKernel average, minimum;
+        };
+
+        DownsamplingKernels selectDownsamplingKernels() {
+#ifdef LLASSETGEN_X86
+            if (internal::cpuFeatures().avx2) {
+                return {internal::averageDownsampleRowAvx2, internal::minDownsampleRowAvx2};
+            }
+            if (internal::cpuFeatures().sse2) {
+                return {internal::averageDownsampleRowSse2, internal::minDownsampleRowSse2};
+            }
+#endif
+            return {internal::downsampleRow<internal::ScalarLanes, false>,
+                    internal::downsampleRow<internal::ScalarLanes, true>};
+        }
+
+        const DownsamplingKernels& downsamplingKernels() {
+            static const DownsamplingKernels kernels = selectDownsamplingKernels();
+            return kernels;
+        }
+
+        void simdDownsample(const Image& dst, const Image& src, internal::DownsampleRowKernel kernel) {
+            assert(src.getWidth() % dst.getWidth() == 0 && src.getHeight() % dst.getHeight() == 0);
+            size_t x_scale = src.getWidth() / dst.getWidth(),
+                   y_scale = src.getHeight() / dst.getHeight();
+            // called once per glyph in the atlas loops, the buffer of each thread only grows
+            static thread_local std::vector<float> accumulator;
+            if (accumulator.size() < src.getWidth()) {
+                accumulator.resize(src.getWidth());
+            }
+            for (size_t y = 0; y < dst.getHeight(); y++) {
+                kernel(dst.getRowData<float>(y), dst.getWidth(), src.getRowData<float>(y * y_scale),
+                       src.getRowPitch<float>(), x_scale, y_scale, accumulator.data());
+            }
+        }
+
+        /*
+         * OpenGL type and sized internal format of a single channel KTX texture.
+         */
+        template <typename pixelType>
+        struct KtxFormat;
+
+        template <>
+        struct KtxFormat<uint8_t> {
+            static constexpr uint32_t type = 0x1401;            // GL_UNSIGNED_BYTE
+            static constexpr uint32_t internalFormat = 0x8229;  // GL_R8
+        };
+
+        template <>
+        struct KtxFormat<uint16_t> {
+            static constexpr uint32_t type = 0x1403;            // GL_UNSIGNED_SHORT
+            static constexpr uint32_t internalFormat = 0x822A;  // GL_R16
+        };
+
+        template <>
+        struct KtxFormat<Half> {
+            static constexpr uint32_t type = 0x140B;            // GL_HALF_FLOAT
+            static constexpr uint32_t internalFormat = 0x822D;  // GL_R16F
+        };
+
+        template <>
+        struct KtxFormat<float> {
+            static constexpr uint32_t type = 0x1406;            // GL_FLOAT
+            static constexpr uint32_t internalFormat = 0x822E;  // GL_R32F
+        };
+    }
+
     Image::~Image() {
         if (isOwnerOfData) {
             delete[] data;
@@ -41,6 +340,12 @@ namespace llassetgen {
     }
 
     Image& Image::operator=(Image&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        if (isOwnerOfData) {
+            delete[] data;
+        }
         min = other.min;
         max = other.max;
         stride = other.stride;
@@ -70,18 +375,22 @@ namespace llassetgen {
     Image::Image(FT_Bitmap bitmap, size_t padding, size_t divisibleBy)
         : Image(divisiblePadding(bitmap.width, padding, divisibleBy),
                 divisiblePadding(bitmap.rows, padding, divisibleBy),
-                1) {
+                getFtBitdepth(bitmap)) {
         if (padding > 0 || bitmap.width % divisibleBy != 0 || bitmap.rows % divisibleBy != 0) {
-            Vec2<size_t> paddingVec{padding, padding},
-                         imgSize{bitmap.width, bitmap.rows};
-            Image&& paddedView = view(paddingVec, imgSize + paddingVec);
-            paddedView.load(bitmap);
-            fillPadding({paddingVec, imgSize});
+            loadPadded(bitmap, padding);
         } else {
             load(bitmap);
         }
     }
 
+    void Image::loadPadded(const FT_Bitmap& bitmap, size_t padding) {
+        Vec2<size_t> paddingVec{padding, padding},
+                     imgSize{bitmap.width, bitmap.rows};
+        Image&& paddedView = view(paddingVec, imgSize + paddingVec);
+        paddedView.load(bitmap);
+        fillPadding({paddingVec, imgSize});
+    }
+
     void Image::fillPadding(Rect<size_t> image) {
         Vec2<size_t> innerMin = image.position,
                      innerMax = image.position + image.size;
@@ -115,6 +424,7 @@ namespace llassetgen {
     template LLASSETGEN_API uint32_t Image::getPixel<uint32_t>(Vec2<size_t> pos) const;
     template LLASSETGEN_API uint16_t Image::getPixel<uint16_t>(Vec2<size_t> pos) const;
     template LLASSETGEN_API uint8_t Image::getPixel<uint8_t>(Vec2<size_t> pos) const;
+    template LLASSETGEN_API Half Image::getPixel<Half>(Vec2<size_t> pos) const;
     template <typename pixelType>
     pixelType Image::getPixel(Vec2<size_t> pos) const {
         assert(isValid(pos));
@@ -134,6 +444,7 @@ namespace llassetgen {
     template LLASSETGEN_API void Image::setPixel<uint32_t>(Vec2<size_t> pos, uint32_t in) const;
     template LLASSETGEN_API void Image::setPixel<uint16_t>(Vec2<size_t> pos, uint16_t in) const;
     template LLASSETGEN_API void Image::setPixel<uint8_t>(Vec2<size_t> pos, uint8_t in) const;
+    template LLASSETGEN_API void Image::setPixel<Half>(Vec2<size_t> pos, Half in) const;
     template <typename pixelType>
     void Image::setPixel(Vec2<size_t> pos, pixelType in) const {
         assert(isValid(pos));
@@ -150,15 +461,63 @@ namespace llassetgen {
         }
     }
 
+    template LLASSETGEN_API float* Image::getRowData<float>(size_t y) const;
+    template LLASSETGEN_API uint32_t* Image::getRowData<uint32_t>(size_t y) const;
+    template LLASSETGEN_API uint16_t* Image::getRowData<uint16_t>(size_t y) const;
+    template LLASSETGEN_API uint8_t* Image::getRowData<uint8_t>(size_t y) const;
+    template LLASSETGEN_API Half* Image::getRowData<Half>(size_t y) const;
+    template <typename pixelType>
+    pixelType* Image::getRowData(size_t y) const {
+        assert(bitDepth == sizeof(pixelType) * 8 && y < getHeight());
+        return reinterpret_cast<pixelType*>(&data[(min.y + y) * stride]) + min.x;
+    }
+
+    template LLASSETGEN_API size_t Image::getRowPitch<float>() const;
+    template LLASSETGEN_API size_t Image::getRowPitch<uint32_t>() const;
+    template LLASSETGEN_API size_t Image::getRowPitch<uint16_t>() const;
+    template LLASSETGEN_API size_t Image::getRowPitch<uint8_t>() const;
+    template LLASSETGEN_API size_t Image::getRowPitch<Half>() const;
+    template <typename pixelType>
+    size_t Image::getRowPitch() const {
+        assert(bitDepth == sizeof(pixelType) * 8);
+        return stride / sizeof(pixelType);
+    }
+
+    void Image::unpackRow(size_t y, uint8_t* out) const {
+        assert(bitDepth <= 8 && y < getHeight());
+        const uint8_t* row = &data[(min.y + y) * stride];
+        const uint8_t mask = (1 << bitDepth) - 1;
+        for (size_t x = min.x; x < max.x; x++) {
+            size_t bitOffset = x * bitDepth;
+            *out++ = (row[bitOffset / 8] >> (8 - bitDepth - bitOffset % 8)) & mask;
+        }
+    }
+
     template LLASSETGEN_API void Image::fillRect<float>(Vec2<size_t> _min, Vec2<size_t> _max, float in) const;
     template LLASSETGEN_API void Image::fillRect<uint32_t>(Vec2<size_t> _min, Vec2<size_t> _max, uint32_t in) const;
     template LLASSETGEN_API void Image::fillRect<uint16_t>(Vec2<size_t> _min, Vec2<size_t> _max, uint16_t in) const;
     template LLASSETGEN_API void Image::fillRect<uint8_t>(Vec2<size_t> _min, Vec2<size_t> _max, uint8_t in) const;
+    template LLASSETGEN_API void Image::fillRect<Half>(Vec2<size_t> _min, Vec2<size_t> _max, Half in) const;
     template <typename pixelType>
     void Image::fillRect(Vec2<size_t> _min, Vec2<size_t> _max, pixelType in) const {
-        for (size_t y = _min.y; y < _max.y; y++) {
-            for (size_t x = _min.x; x < _max.x; x++) {
-                setPixel<pixelType>({x, y}, in);
+        assert(_max.x <= getWidth() && _max.y <= getHeight());
+        if (_min.x >= _max.x) {
+            return;
+        }
+        if (bitDepth <= 8) {
+            // repeat the pixel value over a whole byte, rows are then filled bytewise
+            auto pattern = static_cast<uint8_t>(static_cast<uint8_t>(in) & ((1 << bitDepth) - 1));
+            for (size_t shift = bitDepth; shift < 8; shift *= 2) {
+                pattern = static_cast<uint8_t>(pattern | (pattern << shift));
+            }
+            for (size_t y = _min.y; y < _max.y; y++) {
+                fillBits(&data[(min.y + y) * stride], (min.x + _min.x) * bitDepth, (_max.x - _min.x) * bitDepth,
+                         pattern);
+            }
+        } else {
+            for (size_t y = _min.y; y < _max.y; y++) {
+                pixelType* row = getRowData<pixelType>(y);
+                std::fill(row + _min.x, row + _max.x, in);
             }
         }
     }
@@ -167,7 +526,9 @@ namespace llassetgen {
         if (isOwnerOfData) {
             memset(data, 0, stride * getHeight());
         } else {
-            fillRect(min, max, 0);
+            for (size_t y = 0; y < getHeight(); y++) {
+                fillBits(&data[(min.y + y) * stride], min.x * bitDepth, getWidth() * bitDepth, 0);
+            }
         }
     }
 
@@ -175,59 +536,60 @@ namespace llassetgen {
     template LLASSETGEN_API void Image::centerDownsampling<uint32_t>(const Image& src) const;
     template LLASSETGEN_API void Image::centerDownsampling<uint16_t>(const Image& src) const;
     template LLASSETGEN_API void Image::centerDownsampling<uint8_t>(const Image& src) const;
+    template LLASSETGEN_API void Image::centerDownsampling<Half>(const Image& src) const;
     template <typename pixelType>
     void Image::centerDownsampling(const Image& src) const {
         assert(src.getWidth() % getWidth() == 0 && src.getHeight() % getHeight() == 0);
-        size_t x_scale = src.getWidth() / getWidth(),
-               y_scale = src.getHeight() / getHeight();
-        for (size_t y = 0; y < getHeight(); y++) {
-            for (size_t x = 0; x < getWidth(); x++) {
-                setPixel<pixelType>({x, y},
-                                    src.getPixel<pixelType>({x * x_scale + x_scale / 2, y * y_scale + y_scale / 2}));
-            }
-        }
+        downsample<pixelType>(*this, src, CenterDownsampling<pixelType>());
     }
 
     template LLASSETGEN_API void Image::averageDownsampling<float>(const Image& src) const;
     template LLASSETGEN_API void Image::averageDownsampling<uint32_t>(const Image& src) const;
     template LLASSETGEN_API void Image::averageDownsampling<uint16_t>(const Image& src) const;
     template LLASSETGEN_API void Image::averageDownsampling<uint8_t>(const Image& src) const;
+    template LLASSETGEN_API void Image::averageDownsampling<Half>(const Image& src) const;
     template <typename pixelType>
     void Image::averageDownsampling(const Image& src) const {
         assert(src.getWidth() % getWidth() == 0 && src.getHeight() % getHeight() == 0);
-        size_t x_scale = src.getWidth() / getWidth(),
-               y_scale = src.getHeight() / getHeight();
-        for (size_t y = 0; y < getHeight(); y++) {
-            for (size_t x = 0; x < getWidth(); x++) {
-                pixelType value = 0;
-                for (size_t j = 0; j < y_scale; j++) {
-                    for (size_t i = 0; i < x_scale; i++) {
-                        value += src.getPixel<pixelType>({x * x_scale + i, y * y_scale + j});
-                    }
-                }
-                setPixel<pixelType>({x, y}, value / (x_scale * y_scale));
-            }
-        }
+        downsample<pixelType>(*this, src, AverageDownsampling<pixelType>());
     }
 
     template LLASSETGEN_API void Image::minDownsampling<float>(const Image& src) const;
     template LLASSETGEN_API void Image::minDownsampling<uint32_t>(const Image& src) const;
     template LLASSETGEN_API void Image::minDownsampling<uint16_t>(const Image& src) const;
     template LLASSETGEN_API void Image::minDownsampling<uint8_t>(const Image& src) const;
+    template LLASSETGEN_API void Image::minDownsampling<Half>(const Image& src) const;
     template <typename pixelType>
     void Image::minDownsampling(const Image& src) const {
         assert(src.getWidth() % getWidth() == 0 && src.getHeight() % getHeight() == 0);
-        size_t x_scale = src.getWidth() / getWidth(),
-               y_scale = src.getHeight() / getHeight();
+        downsample<pixelType>(*this, src, MinDownsampling<pixelType>());
+    }
+
+    void Image::simdAverageDownsampling(const Image& src) const {
+        simdDownsample(*this, src, downsamplingKernels().average);
+    }
+
+    void Image::simdMinDownsampling(const Image& src) const {
+        simdDownsample(*this, src, downsamplingKernels().minimum);
+    }
+
+    template LLASSETGEN_API void Image::quantize<float>(const Image& src, float black, float white) const;
+    template <typename pixelType>
+    void Image::quantize(const Image& src, pixelType black, pixelType white) const {
+        assert(getSize() == src.getSize() && (bitDepth == 8 || bitDepth == 16));
+        const float scale = bitDepth == 8 ? std::numeric_limits<uint8_t>::max() : std::numeric_limits<uint16_t>::max();
         for (size_t y = 0; y < getHeight(); y++) {
+            const pixelType* srcRow = src.getRowData<pixelType>(y);
+            uint8_t* row8 = bitDepth == 8 ? getRowData<uint8_t>(y) : nullptr;
+            uint16_t* row16 = bitDepth == 16 ? getRowData<uint16_t>(y) : nullptr;
             for (size_t x = 0; x < getWidth(); x++) {
-                pixelType value = std::numeric_limits<pixelType>::max();
-                for (size_t j = 0; j < y_scale; j++) {
-                    for (size_t i = 0; i < x_scale; i++) {
-                        value = std::min(value, src.getPixel<pixelType>({x * x_scale + i, y * y_scale + j}));
-                    }
+                auto value = static_cast<float>(srcRow[x] - black) / static_cast<float>(white - black);
+                auto quantized = static_cast<uint16_t>(clamp(value, 0.0F, 1.0F) * scale);
+                if (row8) {
+                    row8[x] = static_cast<uint8_t>(quantized);
+                } else {
+                    row16[x] = quantized;
                 }
-                setPixel<pixelType>({x, y}, value);
             }
         }
     }
@@ -237,17 +599,14 @@ namespace llassetgen {
         auto pitch = static_cast<size_t>(ft_bitmap.pitch);
         if (min.x == 0 && min.y == 0 && pitch == stride) {
             memcpy(data, ft_bitmap.buffer, ft_bitmap.pitch * ft_bitmap.rows);
-        } else if (min.x % 8 == 0) {
-            assert(bitDepth == 1);
-            size_t rowLength = std::min(pitch, stride);
+        } else if (bitDepth == 8) {
             for (size_t y = 0; y < ft_bitmap.rows; y++) {
-                memcpy(&data[(min.y + y) * stride + min.x / 8], &ft_bitmap.buffer[y * ft_bitmap.pitch], rowLength);
+                memcpy(&data[(min.y + y) * stride + min.x], &ft_bitmap.buffer[y * ft_bitmap.pitch], ft_bitmap.width);
             }
         } else {
             for (size_t y = 0; y < ft_bitmap.rows; y++) {
-                for (size_t x = 0; x < ft_bitmap.width; x++) {
-                    setPixel<uint8_t>({x, y}, (ft_bitmap.buffer[y * ft_bitmap.pitch + x / 8] >> (7 - (x % 8))) & 1);
-                }
+                blitBits(&data[(min.y + y) * stride], min.x * bitDepth, &ft_bitmap.buffer[y * pitch], 0,
+                         ft_bitmap.width * bitDepth);
             }
         }
     }
@@ -388,8 +747,29 @@ namespace llassetgen {
     template LLASSETGEN_API void Image::exportPng<float>(const std::string& filepath, float min, float max);
     template <typename pixelType>
     void Image::exportPng(const std::string& filepath, pixelType black, pixelType white) {
-        std::ofstream out_file(filepath, std::ofstream::out | std::ofstream::binary);
-        if (!out_file.good()) {
+        PngRowWriter writer(filepath, getWidth(), getHeight(), bitDepth);
+        writer.writeRows<pixelType>(*this, black, white);
+        writer.finish();
+    }
+
+    struct PngRowWriter::State {
+        std::string filepath;
+        std::ofstream out_file;
+        png_structp png = nullptr;
+        png_infop info = nullptr;
+        uint8_t bitDepth;
+        size_t rowsLeft;
+        std::unique_ptr<uint16_t[]> row;
+    };
+
+    PngRowWriter::PngRowWriter(const std::string& filepath, size_t width, size_t height, uint8_t bitDepth)
+        : state(new State) {
+        state->filepath = filepath;
+        state->bitDepth = bitDepth;
+        state->rowsLeft = height;
+
+        state->out_file.open(filepath, std::ofstream::out | std::ofstream::binary);
+        if (!state->out_file.good()) {
             std::cerr << "could not open file " << filepath;
             abort();
         }
@@ -406,6 +786,8 @@ namespace llassetgen {
             std::cerr << "failed to create png info struct";
             abort();
         }
+        state->png = png;
+        state->info = info;
 
         if (setjmp(png_jmpbuf(png))) {
             std::cerr << "pnglib caused a longjump due to an error" << std::endl;
@@ -413,12 +795,12 @@ namespace llassetgen {
             abort();
         }
 
-        png_set_write_fn(png, (png_voidp)&out_file, writeData, flushData);
+        png_set_write_fn(png, (png_voidp)&state->out_file, Image::writeData, Image::flushData);
 
         png_set_IHDR(png,
             info,
-            getWidth(),
-            getHeight(),
+            width,
+            height,
             (bitDepth < 16) ? bitDepth : 16,
             PNG_COLOR_TYPE_GRAY,
             PNG_INTERLACE_NONE,
@@ -432,24 +814,198 @@ namespace llassetgen {
         }
 
         if (bitDepth >= 24) {
-            std::unique_ptr<uint16_t[]> row(new uint16_t[getWidth()]);
+            state->row.reset(new uint16_t[width]);
+        }
+    }
+
+    PngRowWriter::~PngRowWriter() {
+        if (state->png) {
+            finish();
+        }
+    }
+
+    template LLASSETGEN_API void PngRowWriter::writeRows<uint32_t>(const Image& rows, uint32_t min, uint32_t max);
+    template LLASSETGEN_API void PngRowWriter::writeRows<uint16_t>(const Image& rows, uint16_t min, uint16_t max);
+    template LLASSETGEN_API void PngRowWriter::writeRows<uint8_t>(const Image& rows, uint8_t min, uint8_t max);
+    template LLASSETGEN_API void PngRowWriter::writeRows<float>(const Image& rows, float min, float max);
+    template <typename pixelType>
+    void PngRowWriter::writeRows(const Image& rows, pixelType black, pixelType white) {
+        assert(rows.bitDepth == state->bitDepth && rows.getHeight() <= state->rowsLeft);
+        png_structp png = state->png;
+        if (setjmp(png_jmpbuf(png))) {
+            std::cerr << "pnglib caused a longjump due to an error" << std::endl;
+            std::cerr << "could not write file " << state->filepath;
+            abort();
+        }
+
+        if (state->bitDepth >= 24) {
+            uint16_t* row = state->row.get();
             // possible 32 float or 32 or 24 bit int data
             // scale down to 16 bit int grayscale
 
-            for (size_t y = 0; y < getHeight(); y++) {
-                for (size_t x = 0; x < getWidth(); x++) {
-                    auto value =
-                        static_cast<float>(getPixel<pixelType>({x, y}) - black) / static_cast<float>(white - black);
+            for (size_t y = 0; y < rows.getHeight(); y++) {
+                for (size_t x = 0; x < rows.getWidth(); x++) {
+                    auto value = static_cast<float>(rows.getPixel<pixelType>({x, y}) - black) /
+                                 static_cast<float>(white - black);
                     row[x] = clamp(value, 0.0F, 1.0F) * std::numeric_limits<uint16_t>::max();
                 }
-                png_write_row(png, reinterpret_cast<png_bytep>(row.get()));
+                png_write_row(png, reinterpret_cast<png_bytep>(row));
             }
         } else {
             // TODO: Use black and white params here as well
-            for (size_t y = 0; y < getHeight(); y++) {
-                png_write_row(png, reinterpret_cast<png_bytep>(&data[y * stride]));
+            for (size_t y = 0; y < rows.getHeight(); y++) {
+                png_write_row(png, reinterpret_cast<png_bytep>(&rows.data[(rows.min.y + y) * rows.stride]));
             }
         }
+        state->rowsLeft -= rows.getHeight();
+    }
+
+    void PngRowWriter::finish() {
+        assert(state->rowsLeft == 0);
+        png_structp png = state->png;
+        if (setjmp(png_jmpbuf(png))) {
+            std::cerr << "pnglib caused a longjump due to an error" << std::endl;
+            std::cerr << "could not write file " << state->filepath;
+            abort();
+        }
+
+        png_write_end(png, nullptr);
+
+        png_destroy_write_struct(&state->png, &state->info);
+        state->png = nullptr;
+        state->out_file.close();
+    }
+
+    void Image::exportRaw(const std::string& filepath) const {
+        assert(bitDepth >= 8);
+        std::ofstream out_file(filepath, std::ofstream::out | std::ofstream::binary);
+        if (!out_file.good()) {
+            std::cerr << "could not open file " << filepath;
+            abort();
+        }
+        const size_t rowBytes = getWidth() * bitDepth / 8;
+        for (size_t y = 0; y < getHeight(); y++) {
+            out_file.write(reinterpret_cast<const char*>(&data[(min.y + y) * stride + min.x * bitDepth / 8]),
+                           static_cast<std::streamsize>(rowBytes));
+        }
+    }
+
+    template LLASSETGEN_API void Image::exportKtx<float>(const std::string& filepath) const;
+    template LLASSETGEN_API void Image::exportKtx<Half>(const std::string& filepath) const;
+    template LLASSETGEN_API void Image::exportKtx<uint16_t>(const std::string& filepath) const;
+    template LLASSETGEN_API void Image::exportKtx<uint8_t>(const std::string& filepath) const;
+    template <typename pixelType>
+    void Image::exportKtx(const std::string& filepath) const {
+        assert(bitDepth == sizeof(pixelType) * 8);
+        std::ofstream out_file(filepath, std::ofstream::out | std::ofstream::binary);
+        if (!out_file.good()) {
+            std::cerr << "could not open file " << filepath;
+            abort();
+        }
+
+        auto writeUint32 = [&out_file](uint32_t value) {
+            out_file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        const uint8_t identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+        out_file.write(reinterpret_cast<const char*>(identifier), sizeof(identifier));
+        writeUint32(0x04030201);  // endianness, the reader swaps if it reads 0x01020304
+        writeUint32(KtxFormat<pixelType>::type);
+        writeUint32(sizeof(pixelType));
+        writeUint32(0x1903);  // GL_RED
+        writeUint32(KtxFormat<pixelType>::internalFormat);
+        writeUint32(0x1903);  // base internal format GL_RED
+        writeUint32(static_cast<uint32_t>(getWidth()));
+        writeUint32(static_cast<uint32_t>(getHeight()));
+        writeUint32(0);  // depth
+        writeUint32(0);  // array elements
+        writeUint32(1);  // faces
+        writeUint32(1);  // mipmap levels
+
+        // key and value are null terminated, padded to 4 bytes
+        const char orientation[] = "KTXorientation\0S=r,T=d";
+        const uint32_t keyValueSize = sizeof(orientation), keyValuePadding = (4 - keyValueSize % 4) % 4;
+        writeUint32(sizeof(uint32_t) + keyValueSize + keyValuePadding);
+        writeUint32(keyValueSize);
+        out_file.write(orientation, keyValueSize);
+        const char zeros[4] = {};
+        out_file.write(zeros, keyValuePadding);
+
+        // rows are aligned to 4 bytes
+        const size_t rowBytes = getWidth() * sizeof(pixelType), rowPadding = (4 - rowBytes % 4) % 4;
+        writeUint32(static_cast<uint32_t>((rowBytes + rowPadding) * getHeight()));
+        for (size_t y = 0; y < getHeight(); y++) {
+            out_file.write(reinterpret_cast<const char*>(getRowData<pixelType>(y)),
+                           static_cast<std::streamsize>(rowBytes));
+            out_file.write(zeros, static_cast<std::streamsize>(rowPadding));
+        }
+    }
+
+    template LLASSETGEN_API void Image::exportMultiChannelPng<float>(const std::string& filepath,
+                                                                     const std::vector<Image>& channels, float black,
+                                                                     float white);
+    template <typename pixelType>
+    void Image::exportMultiChannelPng(const std::string& filepath, const std::vector<Image>& channels,
+                                      pixelType black, pixelType white) {
+        assert(channels.size() == 3 || channels.size() == 4);
+#ifndef NDEBUG
+        for (const auto& channel : channels) {
+            assert(channel.getSize() == channels[0].getSize());
+        }
+#endif
+
+        std::ofstream out_file(filepath, std::ofstream::out | std::ofstream::binary);
+        if (!out_file.good()) {
+            std::cerr << "could not open file " << filepath;
+            abort();
+        }
+
+        png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+        if (!png) {
+            std::cerr << "failed to create png write struct";
+            abort();
+        }
+
+        png_infop info = png_create_info_struct(png);
+        if (!info) {
+            png_destroy_write_struct(&png, (png_infopp)0);
+            std::cerr << "failed to create png info struct";
+            abort();
+        }
+
+        if (setjmp(png_jmpbuf(png))) {
+            std::cerr << "pnglib caused a longjump due to an error" << std::endl;
+            std::cerr << "could not write file " << filepath;
+            abort();
+        }
+
+        png_set_write_fn(png, (png_voidp)&out_file, writeData, flushData);
+
+        const size_t width = channels[0].getWidth(), height = channels[0].getHeight();
+        png_set_IHDR(png,
+            info,
+            width,
+            height,
+            8,
+            channels.size() == 4 ? PNG_COLOR_TYPE_RGB_ALPHA : PNG_COLOR_TYPE_RGB,
+            PNG_INTERLACE_NONE,
+            PNG_COMPRESSION_TYPE_BASE,
+            PNG_FILTER_TYPE_BASE);
+
+        png_write_info(png, info);
+
+        // interleave the channels, scaled down to 8 bit
+        std::unique_ptr<uint8_t[]> row(new uint8_t[width * channels.size()]);
+        for (size_t y = 0; y < height; y++) {
+            for (size_t c = 0; c < channels.size(); c++) {
+                const pixelType* channelRow = channels[c].getRowData<pixelType>(y);
+                for (size_t x = 0; x < width; x++) {
+                    auto value = static_cast<float>(channelRow[x] - black) / static_cast<float>(white - black);
+                    row[x * channels.size() + c] =
+                        static_cast<uint8_t>(clamp(value, 0.0F, 1.0F) * std::numeric_limits<uint8_t>::max() + 0.5F);
+                }
+            }
+            png_write_row(png, reinterpret_cast<png_bytep>(row.get()));
+        }
 
         png_write_end(png, nullptr);
 
@@ -462,13 +1018,23 @@ namespace llassetgen {
     void Image::copyDataFrom(const Image& src) {
         assert(getHeight() == src.getHeight() &&
                getWidth() == src.getWidth() &&
-               getBitDepth() == src.getBitDepth());
+               (getBitDepth() == src.getBitDepth() || (getBitDepth() == 8 && src.getBitDepth() < 8)));
 
-        for (size_t y = 0; y < getHeight(); y++) {
-            for (size_t x = 0; x < getWidth(); x++) {
-                Vec2<size_t> pos{x, y};
-                setPixel<uint8_t>(pos, src.getPixel<uint8_t>(pos));
+        if (bitDepth != src.bitDepth) {
+            // scale e.g. 1 to 255 or 3 to 255 (2 bits), exact since 2^bitDepth - 1 divides 255
+            auto scale = static_cast<uint8_t>(255 / ((1 << src.bitDepth) - 1));
+            for (size_t y = 0; y < getHeight(); y++) {
+                uint8_t* row = getRowData<uint8_t>(y);
+                src.unpackRow(y, row);
+                for (size_t x = 0; x < getWidth(); x++) {
+                    row[x] = static_cast<uint8_t>(row[x] * scale);
+                }
             }
+            return;
+        }
+        for (size_t y = 0; y < getHeight(); y++) {
+            blitBits(&data[(min.y + y) * stride], min.x * bitDepth, &src.data[(src.min.y + y) * src.stride],
+                     src.min.x * bitDepth, getWidth() * bitDepth);
         }
     }
 
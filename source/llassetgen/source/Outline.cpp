@@ -0,0 +1,650 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include <ft2build.h>
+#include FT_OUTLINE_H
+
+#include <llassetgen/Outline.h>
+
+namespace llassetgen {
+    namespace {
+        using Point = Vec2<double>;
+
+        Point scaled(Point p, double factor) { return {p.x * factor, p.y * factor}; }
+
+        double dot(Point a, Point b) { return a.x * b.x + a.y * b.y; }
+
+        double cross(Point a, Point b) { return a.x * b.y - a.y * b.x; }
+
+        double length(Point p) { return std::sqrt(dot(p, p)); }
+
+        Point lerp(Point a, Point b, double t) { return scaled(a, 1 - t) + scaled(b, t); }
+
+        Point fromFt(const FT_Vector* vector) { return {vector->x / 64., vector->y / 64.}; }
+
+        /*
+         * Real roots of a * x^2 + b * x + c, degrading to the linear case for a (relatively) vanishing a.
+         */
+        int solveQuadratic(double x[2], double a, double b, double c) {
+            if (a == 0 || std::abs(b) > 1e12 * std::abs(a)) {
+                if (b == 0) {
+                    return 0;
+                }
+                x[0] = -c / b;
+                return 1;
+            }
+            double discriminant = b * b - 4 * a * c;
+            if (discriminant < 0) {
+                return 0;
+            }
+            discriminant = std::sqrt(discriminant);
+            x[0] = (-b + discriminant) / (2 * a);
+            x[1] = (-b - discriminant) / (2 * a);
+            return 2;
+        }
+
+        /*
+         * Real roots of a * x^3 + b * x^2 + c * x + d, after Numerical Recipes 5.6.
+         */
+        int solveCubic(double x[3], double a, double b, double c, double d) {
+            if (a == 0 || std::abs(b / a) > 1e6) {
+                return solveQuadratic(x, b, c, d);
+            }
+            b /= a;
+            c /= a;
+            d /= a;
+            double q = (b * b - 3 * c) / 9;
+            double r = (b * (2 * b * b - 9 * c) + 27 * d) / 54;
+            double q3 = q * q * q;
+            b /= 3;
+            if (r * r < q3) {
+                const double pi = 3.14159265358979323846;
+                double theta = std::acos(clamp(r / std::sqrt(q3), -1., 1.));
+                double factor = -2 * std::sqrt(q);
+                x[0] = factor * std::cos(theta / 3) - b;
+                x[1] = factor * std::cos((theta + 2 * pi) / 3) - b;
+                x[2] = factor * std::cos((theta - 2 * pi) / 3) - b;
+                return 3;
+            }
+            double u = -std::cbrt(std::abs(r) + std::sqrt(r * r - q3));
+            if (r < 0) {
+                u = -u;
+            }
+            double v = u == 0 ? 0 : q / u;
+            x[0] = u + v - b;
+            return 1;
+        }
+
+        /*
+         * The polygon with which the outline is approximated for the inside test.
+         */
+        struct Edge {
+            Point a, b;
+        };
+
+        void flatten(const Outline::Segment& segment, double tolerance, std::vector<Edge>& edges) {
+            const Point* p = segment.points;
+            // the chord error of n uniform steps is at most max|B''| / (8 * n^2)
+            double curvature = 0;
+            if (segment.type == Outline::Segment::Conic) {
+                curvature = 2 * length(p[0] - scaled(p[1], 2) + p[2]);
+            } else if (segment.type == Outline::Segment::Cubic) {
+                curvature = 6 * std::max(length(p[0] - scaled(p[1], 2) + p[2]), length(p[1] - scaled(p[2], 2) + p[3]));
+            }
+            int steps = std::max(1, static_cast<int>(std::ceil(std::sqrt(curvature / (8 * tolerance)))));
+            Point previous = p[0];
+            for (int i = 1; i <= steps; i++) {
+                Point next = i == steps ? p[segment.type] : segment.point(double(i) / steps);
+                edges.push_back({previous, next});
+                previous = next;
+            }
+        }
+
+        std::vector<Edge> flatten(const Outline& outline, double tolerance) {
+            std::vector<Edge> edges;
+            for (const auto& contour : outline.contours) {
+                if (contour.empty()) {
+                    continue;
+                }
+                for (const auto& segment : contour) {
+                    flatten(segment, tolerance, edges);
+                }
+                Point first = contour.front().points[0], last = contour.back().points[contour.back().type];
+                if (first != last) {
+                    edges.push_back({last, first});
+                }
+            }
+            return edges;
+        }
+
+        /*
+         * The segments of an outline sorted into a grid of square cells over an output image: a segment belongs to
+         * every cell which its bounding box, grown by `reach`, overlaps. With an infinite reach there is only one cell
+         * containing all segments.
+         */
+        class SegmentGrid {
+            size_t cellSize, gridWidth;
+            std::vector<size_t> cellBegins;
+            std::vector<const Outline::Segment*> cellSegments;
+
+            size_t cell(size_t x, size_t y) const { return (y / cellSize) * gridWidth + x / cellSize; }
+
+           public:
+            using Iterator = std::vector<const Outline::Segment*>::const_iterator;
+
+            SegmentGrid(const Outline& outline, double reach, size_t width, size_t height, Point origin, double scale) {
+                std::vector<const Outline::Segment*> segments;
+                for (const auto& contour : outline.contours) {
+                    for (const auto& segment : contour) {
+                        segments.push_back(&segment);
+                    }
+                }
+
+                const bool banded = std::isfinite(reach);
+                const size_t maxGridSize = 64;
+                cellSize = banded ? std::max<size_t>(1, static_cast<size_t>(std::ceil(reach / scale))) : 1;
+                cellSize = banded ? std::max(cellSize, (std::max(width, height) + maxGridSize - 1) / maxGridSize)
+                                  : std::max<size_t>(1, std::max(width, height));
+                gridWidth = (width + cellSize - 1) / cellSize;
+                const size_t gridHeight = (height + cellSize - 1) / cellSize;
+                cellBegins.assign(gridWidth * gridHeight + 1, 0);
+                if (gridWidth == 0 || gridHeight == 0) {
+                    return;
+                }
+
+                // counting sort of the segments into the cells
+                std::vector<Vec2<size_t>> cellMins(segments.size()), cellMaxs(segments.size());
+                for (size_t i = 0; i < segments.size(); i++) {
+                    Vec2<size_t>& cellMin = cellMins[i];
+                    Vec2<size_t>& cellMax = cellMaxs[i];
+                    if (banded) {
+                        // pixel coordinates of the grown bounding box, the y axis flips
+                        Point boxMin = segments[i]->min(), boxMax = segments[i]->max();
+                        double left = (boxMin.x - reach - origin.x) / scale - 0.5;
+                        double right = (boxMax.x + reach - origin.x) / scale - 0.5;
+                        double top = (origin.y - boxMax.y - reach) / scale - 0.5;
+                        double bottom = (origin.y - boxMin.y + reach) / scale - 0.5;
+                        if (right < 0 || bottom < 0 || left >= width || top >= height) {
+                            cellMin = {1, 1};
+                            cellMax = {0, 0};
+                            continue;
+                        }
+                        cellMin = {static_cast<size_t>(std::max(0., std::floor(left))) / cellSize,
+                                   static_cast<size_t>(std::max(0., std::floor(top))) / cellSize};
+                        cellMax = {std::min(static_cast<size_t>(std::ceil(right)) / cellSize, gridWidth - 1),
+                                   std::min(static_cast<size_t>(std::ceil(bottom)) / cellSize, gridHeight - 1)};
+                    } else {
+                        cellMin = cellMax = {0, 0};
+                    }
+                    for (size_t cy = cellMin.y; cy <= cellMax.y; cy++) {
+                        for (size_t cx = cellMin.x; cx <= cellMax.x; cx++) {
+                            cellBegins[cy * gridWidth + cx + 1]++;
+                        }
+                    }
+                }
+                for (size_t i = 0; i < gridWidth * gridHeight; i++) {
+                    cellBegins[i + 1] += cellBegins[i];
+                }
+                std::vector<size_t> cellEnds(cellBegins.begin(), cellBegins.end() - 1);
+                cellSegments.resize(cellBegins.back());
+                for (size_t i = 0; i < segments.size(); i++) {
+                    for (size_t cy = cellMins[i].y; cy <= cellMaxs[i].y; cy++) {
+                        for (size_t cx = cellMins[i].x; cx <= cellMaxs[i].x; cx++) {
+                            cellSegments[cellEnds[cy * gridWidth + cx]++] = segments[i];
+                        }
+                    }
+                }
+            }
+
+            /*
+             * The segments in reach of pixel (x, y).
+             */
+            Iterator begin(size_t x, size_t y) const { return cellSegments.begin() + cellBegins[cell(x, y)]; }
+            Iterator end(size_t x, size_t y) const { return cellSegments.begin() + cellBegins[cell(x, y) + 1]; }
+        };
+
+        /*
+         * Signed pseudo-distance from `p` to the segment, positive on the left of it: beyond the end points, the
+         * distance to the tangent there is used if it is closer.
+         */
+        double signedPseudoDistance(const Outline::Segment& segment, double t, Point p) {
+            Point closest = segment.point(t);
+            double distance = length(p - closest);
+            if (t <= 0 || t >= 1) {
+                Point endPoint = segment.points[t <= 0 ? 0 : segment.type];
+                Point tangent = segment.direction(t <= 0 ? 0 : 1);
+                tangent = tangent / length(tangent);
+                double along = dot(p - endPoint, tangent);
+                if (t <= 0 ? along < 0 : along > 0) {
+                    double pseudoDistance = cross(tangent, p - endPoint);
+                    if (std::abs(pseudoDistance) <= distance) {
+                        return pseudoDistance;
+                    }
+                }
+            }
+            return cross(segment.direction(t), p - closest) >= 0 ? distance : -distance;
+        }
+
+        double median(double a, double b, double c) { return std::max(std::min(a, b), std::min(std::max(a, b), c)); }
+
+        int moveToFt(const FT_Vector* to, void* user) {
+            static_cast<Outline*>(user)->moveTo(fromFt(to));
+            return 0;
+        }
+
+        int lineToFt(const FT_Vector* to, void* user) {
+            static_cast<Outline*>(user)->lineTo(fromFt(to));
+            return 0;
+        }
+
+        int conicToFt(const FT_Vector* control, const FT_Vector* to, void* user) {
+            static_cast<Outline*>(user)->conicTo(fromFt(control), fromFt(to));
+            return 0;
+        }
+
+        int cubicToFt(const FT_Vector* control1, const FT_Vector* control2, const FT_Vector* to, void* user) {
+            static_cast<Outline*>(user)->cubicTo(fromFt(control1), fromFt(control2), fromFt(to));
+            return 0;
+        }
+    }
+
+    Vec2<double> Outline::Segment::point(double t) const {
+        double s = 1 - t;
+        switch (type) {
+            case Line:
+                return scaled(points[0], s) + scaled(points[1], t);
+            case Conic:
+                return scaled(points[0], s * s) + scaled(points[1], 2 * s * t) + scaled(points[2], t * t);
+            default:
+                return scaled(points[0], s * s * s) + scaled(points[1], 3 * s * s * t) +
+                       scaled(points[2], 3 * s * t * t) + scaled(points[3], t * t * t);
+        }
+    }
+
+    Vec2<double> Outline::Segment::direction(double t) const {
+        double s = 1 - t;
+        Point derivative;
+        switch (type) {
+            case Line:
+                derivative = points[1] - points[0];
+                break;
+            case Conic:
+                derivative = scaled(points[1] - points[0], 2 * s) + scaled(points[2] - points[1], 2 * t);
+                break;
+            default:
+                derivative = scaled(points[1] - points[0], 3 * s * s) + scaled(points[2] - points[1], 6 * s * t) +
+                             scaled(points[3] - points[2], 3 * t * t);
+                if (derivative == Point{0, 0}) {
+                    derivative = t < 0.5 ? points[2] - points[0] : points[3] - points[1];
+                }
+        }
+        if (derivative == Point{0, 0}) {
+            derivative = points[type] - points[0];
+        }
+        return derivative;
+    }
+
+    double Outline::Segment::closestParameter(Vec2<double> p) const {
+        switch (type) {
+            case Line: {
+                Point direction = points[1] - points[0];
+                double lengthSquared = dot(direction, direction);
+                return lengthSquared > 0 ? clamp(dot(p - points[0], direction) / lengthSquared, 0., 1.) : 0;
+            }
+            case Conic: {
+                // the closest point is a root of dot(B(t) - p, B'(t)), a cubic polynomial in t
+                Point a = points[1] - points[0];
+                Point b = points[2] - scaled(points[1], 2) + points[0];
+                Point offset = points[0] - p;
+                double roots[3];
+                int count = solveCubic(roots, dot(b, b), 3 * dot(a, b), 2 * dot(a, a) + dot(offset, b), dot(offset, a));
+                double closest = 0, distance = length(points[0] - p);
+                if (length(points[2] - p) < distance) {
+                    closest = 1;
+                    distance = length(points[2] - p);
+                }
+                for (int i = 0; i < count; i++) {
+                    if (roots[i] > 0 && roots[i] < 1 && length(point(roots[i]) - p) < distance) {
+                        closest = roots[i];
+                        distance = length(point(roots[i]) - p);
+                    }
+                }
+                return closest;
+            }
+            default: {
+                // the quintic has no closed form solution, refine a few evenly spaced starting points with Newton's
+                // method instead
+                const int startingPoints = 8, iterations = 4;
+                Point d1[3] = {scaled(points[1] - points[0], 3), scaled(points[2] - points[1], 3),
+                               scaled(points[3] - points[2], 3)};
+                Point d2[2] = {scaled(d1[1] - d1[0], 2), scaled(d1[2] - d1[1], 2)};
+                double closest = 0, distance = length(points[0] - p);
+                if (length(points[3] - p) < distance) {
+                    closest = 1;
+                    distance = length(points[3] - p);
+                }
+                for (int i = 0; i <= startingPoints; i++) {
+                    double t = double(i) / startingPoints;
+                    for (int j = 0; j < iterations; j++) {
+                        double s = 1 - t;
+                        Point offset = point(t) - p;
+                        Point derivative = scaled(d1[0], s * s) + scaled(d1[1], 2 * s * t) + scaled(d1[2], t * t);
+                        Point secondDerivative = scaled(d2[0], s) + scaled(d2[1], t);
+                        double slope = dot(derivative, derivative) + dot(offset, secondDerivative);
+                        if (slope == 0) {
+                            break;
+                        }
+                        t = clamp(t - dot(offset, derivative) / slope, 0., 1.);
+                    }
+                    if (length(point(t) - p) < distance) {
+                        closest = t;
+                        distance = length(point(t) - p);
+                    }
+                }
+                return closest;
+            }
+        }
+    }
+
+    double Outline::Segment::distance(Vec2<double> p) const { return length(point(closestParameter(p)) - p); }
+
+    void Outline::Segment::split(double t, Segment& first, Segment& second) const {
+        first = second = *this;
+        Point a = lerp(points[0], points[1], t);
+        if (type == Line) {
+            first.points[1] = second.points[0] = a;
+            return;
+        }
+        Point b = lerp(points[1], points[2], t), ab = lerp(a, b, t);
+        if (type == Conic) {
+            first.points[1] = a;
+            first.points[2] = second.points[0] = ab;
+            second.points[1] = b;
+            return;
+        }
+        Point c = lerp(points[2], points[3], t), bc = lerp(b, c, t), middle = lerp(ab, bc, t);
+        first.points[1] = a;
+        first.points[2] = ab;
+        first.points[3] = second.points[0] = middle;
+        second.points[1] = bc;
+        second.points[2] = c;
+    }
+
+    Vec2<double> Outline::Segment::min() const {
+        Point result = points[0];
+        for (int i = 1; i <= type; i++) {
+            result = {std::min(result.x, points[i].x), std::min(result.y, points[i].y)};
+        }
+        return result;
+    }
+
+    Vec2<double> Outline::Segment::max() const {
+        Point result = points[0];
+        for (int i = 1; i <= type; i++) {
+            result = {std::max(result.x, points[i].x), std::max(result.y, points[i].y)};
+        }
+        return result;
+    }
+
+    Outline::Outline(const FT_Outline_& outline) {
+        FT_Outline_Funcs funcs;
+        funcs.move_to = moveToFt;
+        funcs.line_to = lineToFt;
+        funcs.conic_to = conicToFt;
+        funcs.cubic_to = cubicToFt;
+        funcs.shift = 0;
+        funcs.delta = 0;
+        FT_Outline_Decompose(const_cast<FT_Outline*>(&outline), &funcs, this);
+        evenOddFill = (outline.flags & FT_OUTLINE_EVEN_ODD_FILL) != 0;
+    }
+
+    void Outline::moveTo(Vec2<double> to) {
+        contours.emplace_back();
+        cursor = to;
+    }
+
+    void Outline::lineTo(Vec2<double> to) {
+        assert(!contours.empty());
+        contours.back().push_back({Segment::Line, {cursor, to}, Segment::White});
+        cursor = to;
+    }
+
+    void Outline::conicTo(Vec2<double> control, Vec2<double> to) {
+        assert(!contours.empty());
+        contours.back().push_back({Segment::Conic, {cursor, control, to}, Segment::White});
+        cursor = to;
+    }
+
+    void Outline::cubicTo(Vec2<double> control1, Vec2<double> control2, Vec2<double> to) {
+        assert(!contours.empty());
+        contours.back().push_back({Segment::Cubic, {cursor, control1, control2, to}, Segment::White});
+        cursor = to;
+    }
+
+    bool Outline::empty() const {
+        for (const auto& contour : contours) {
+            if (!contour.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Vec2<double> Outline::min() const {
+        Point result{std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+        for (const auto& contour : contours) {
+            for (const auto& segment : contour) {
+                Point segmentMin = segment.min();
+                result = {std::min(result.x, segmentMin.x), std::min(result.y, segmentMin.y)};
+            }
+        }
+        return result;
+    }
+
+    Vec2<double> Outline::max() const {
+        Point result{-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+        for (const auto& contour : contours) {
+            for (const auto& segment : contour) {
+                Point segmentMax = segment.max();
+                result = {std::max(result.x, segmentMax.x), std::max(result.y, segmentMax.y)};
+            }
+        }
+        return result;
+    }
+
+    void Outline::colorEdges(double angleThreshold) {
+        const double crossThreshold = std::sin(angleThreshold);
+        for (auto& contour : contours) {
+            if (contour.empty()) {
+                continue;
+            }
+
+            // a corner lies between the previous segment and the segment at its index
+            std::vector<size_t> corners;
+            for (size_t i = 0; i < contour.size(); i++) {
+                Point previous = contour[(i + contour.size() - 1) % contour.size()].direction(1);
+                Point current = contour[i].direction(0);
+                previous = previous / length(previous);
+                current = current / length(current);
+                if (dot(previous, current) <= 0 || std::abs(cross(previous, current)) > crossThreshold) {
+                    corners.push_back(i);
+                }
+            }
+
+            if (corners.empty()) {
+                // smooth contour, all channels agree
+                for (auto& segment : contour) {
+                    segment.channels = Segment::White;
+                }
+            } else if (corners.size() == 1) {
+                // teardrop, split it into three parts with the corner between the first and the last one
+                std::rotate(contour.begin(), contour.begin() + corners[0], contour.end());
+                if (contour.size() == 1) {
+                    Segment first, rest, second, third;
+                    contour[0].split(1 / 3., first, rest);
+                    rest.split(1 / 2., second, third);
+                    contour = {first, second, third};
+                } else if (contour.size() == 2) {
+                    Contour halves(4);
+                    contour[0].split(1 / 2., halves[0], halves[1]);
+                    contour[1].split(1 / 2., halves[2], halves[3]);
+                    contour = halves;
+                }
+                const uint8_t parts[3] = {Segment::Cyan, Segment::White, Segment::Magenta};
+                for (size_t i = 0; i < contour.size(); i++) {
+                    double position = 2.875 * i / (contour.size() - 1) - 1.4375;
+                    contour[i].channels = parts[static_cast<int>(std::floor(position + 0.5)) + 1];
+                }
+            } else {
+                // cycle through cyan, magenta and yellow at the corners, the last switch must also differ from the
+                // first color
+                uint8_t channels = Segment::Cyan;
+                const uint8_t initialChannels = channels;
+                size_t corner = 0;
+                for (size_t i = 0; i < contour.size(); i++) {
+                    size_t index = (corners[0] + i) % contour.size();
+                    if (corner + 1 < corners.size() && corners[corner + 1] == index) {
+                        ++corner;
+                        uint8_t shared = channels & (corner == corners.size() - 1 ? initialChannels : 0);
+                        if (shared == Segment::Red || shared == Segment::Green || shared == Segment::Blue) {
+                            channels = shared ^ Segment::White;
+                        } else {
+                            uint8_t shifted = channels << 1;
+                            channels = (shifted | shifted >> 3) & Segment::White;
+                        }
+                    }
+                    contour[index].channels = channels;
+                }
+            }
+        }
+    }
+
+    OutlineDistanceField::OutlineDistanceField(const Outline& _outline, DistanceTransform::OutputType _bandLimit)
+        : outline(_outline), bandLimit(_bandLimit) {}
+
+    void OutlineDistanceField::render(const Image& output, Vec2<double> origin, double scale) const {
+        assert(output.getBitDepth() == DistanceTransform::bitDepth);
+        using OutputType = DistanceTransform::OutputType;
+        const size_t width = output.getWidth(), height = output.getHeight();
+
+        const double reach = bandLimit;
+        SegmentGrid grid(outline, reach, width, height, origin, scale);
+
+        // The sign comes from the winding number of the flattened outline along each row, so it does not depend on
+        // the orientation of the closest segment.
+        std::vector<Edge> edges = flatten(outline, scale / 64);
+        std::vector<std::pair<double, int>> crossings;
+        for (size_t y = 0; y < height; y++) {
+            double sampleY = origin.y - (y + 0.5) * scale;
+            crossings.clear();
+            for (const auto& edge : edges) {
+                if ((edge.a.y <= sampleY) != (edge.b.y <= sampleY)) {
+                    double t = (sampleY - edge.a.y) / (edge.b.y - edge.a.y);
+                    crossings.emplace_back(edge.a.x + t * (edge.b.x - edge.a.x), edge.b.y > edge.a.y ? 1 : -1);
+                }
+            }
+            std::sort(crossings.begin(), crossings.end());
+
+            int winding = 0;
+            auto crossing = crossings.begin();
+            OutputType* row = output.getRowData<OutputType>(y);
+            for (size_t x = 0; x < width; x++) {
+                Point sample{origin.x + (x + 0.5) * scale, sampleY};
+                for (; crossing != crossings.end() && crossing->first < sample.x; ++crossing) {
+                    winding += crossing->second;
+                }
+                bool inside = outline.evenOddFill ? (winding & 1) != 0 : winding != 0;
+
+                double distance = reach;
+                for (auto segment = grid.begin(x, y); segment != grid.end(x, y); ++segment) {
+                    distance = std::min(distance, (*segment)->distance(sample));
+                }
+                row[x] = static_cast<OutputType>(inside ? -distance : distance);
+            }
+        }
+    }
+
+    MultiChannelDistanceField::MultiChannelDistanceField(const Outline& _outline,
+                                                         DistanceTransform::OutputType _bandLimit,
+                                                         double angleThreshold)
+        : outline(_outline), bandLimit(_bandLimit) {
+        outline.colorEdges(angleThreshold);
+    }
+
+    void MultiChannelDistanceField::render(const Image& red, const Image& green, const Image& blue,
+                                           const Image& trueDistance, Vec2<double> origin, double scale) const {
+        using OutputType = DistanceTransform::OutputType;
+        const size_t width = trueDistance.getWidth(), height = trueDistance.getHeight();
+#ifndef NDEBUG
+        const Image* channels[3] = {&red, &green, &blue};
+        for (const Image* channel : channels) {
+            assert(channel->getBitDepth() == DistanceTransform::bitDepth &&
+                   channel->getSize() == trueDistance.getSize());
+        }
+#endif
+
+        OutlineDistanceField(outline, bandLimit).render(trueDistance, origin, scale);
+
+        // the pseudo-distances are positive on the left of the segments, i.e. inside of counterclockwise contours
+        double area = 0;
+        for (const auto& edge : flatten(outline, scale)) {
+            area += cross(edge.a, edge.b);
+        }
+        const double orientation = area > 0 ? -1 : 1;
+
+        const double reach = bandLimit;
+        SegmentGrid grid(outline, reach, width, height, origin, scale);
+
+        struct Closest {
+            const Outline::Segment* segment;
+            double t, distance, alignment;
+        };
+        for (size_t y = 0; y < height; y++) {
+            OutputType* rows[3] = {red.getRowData<OutputType>(y), green.getRowData<OutputType>(y),
+                                   blue.getRowData<OutputType>(y)};
+            const OutputType* trueRow = trueDistance.getRowData<OutputType>(y);
+            for (size_t x = 0; x < width; x++) {
+                Point sample{origin.x + (x + 0.5) * scale, origin.y - (y + 0.5) * scale};
+
+                // the closest segment per channel, ties (at corners) go to the segment more orthogonal to the sample
+                Closest closest[3];
+                for (auto& channel : closest) {
+                    channel = {nullptr, 0, std::numeric_limits<double>::infinity(), 0};
+                }
+                for (auto segment = grid.begin(x, y); segment != grid.end(x, y); ++segment) {
+                    double t = (*segment)->closestParameter(sample);
+                    Point offset = sample - (*segment)->point(t);
+                    double distance = length(offset);
+                    Point direction = (*segment)->direction(t);
+                    double alignment =
+                        distance > 0 ? std::abs(dot(direction, offset)) / length(direction) / distance : 0;
+                    for (int c = 0; c < 3; c++) {
+                        if (((*segment)->channels & (1 << c)) &&
+                            (distance < closest[c].distance ||
+                             (distance == closest[c].distance && alignment < closest[c].alignment))) {
+                            closest[c] = {*segment, t, distance, alignment};
+                        }
+                    }
+                }
+
+                double values[3];
+                for (int c = 0; c < 3; c++) {
+                    if (closest[c].segment) {
+                        double value = orientation * signedPseudoDistance(*closest[c].segment, closest[c].t, sample);
+                        values[c] = clamp(value, -reach, reach);
+                    } else {
+                        values[c] = trueRow[x];
+                    }
+                }
+                // a median on the wrong side of the outline would show up as an artifact
+                if (trueRow[x] != 0 && (median(values[0], values[1], values[2]) < 0) != (trueRow[x] < 0)) {
+                    values[0] = values[1] = values[2] = trueRow[x];
+                }
+                for (int c = 0; c < 3; c++) {
+                    rows[c][x] = static_cast<OutputType>(values[c]);
+                }
+            }
+        }
+    }
+}
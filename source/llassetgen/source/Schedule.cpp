@@ -0,0 +1,122 @@
+#include <llassetgen/Schedule.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+    // the innermost report of each thread that starts loops
+    thread_local llassetgen::ScheduleReport* currentReport = nullptr;
+
+    double seconds() {
+        using Clock = std::chrono::steady_clock;
+        return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+    }
+
+    size_t threadCount() {
+#ifdef _OPENMP
+        return static_cast<size_t>(omp_get_max_threads());
+#else
+        return 1;
+#endif
+    }
+
+    size_t threadNumber() {
+#ifdef _OPENMP
+        return static_cast<size_t>(omp_get_thread_num());
+#else
+        return 0;
+#endif
+    }
+}
+
+namespace llassetgen {
+    ScheduleReport::ScheduleReport() : outer(currentReport) { currentReport = this; }
+
+    ScheduleReport::~ScheduleReport() { currentReport = outer; }
+
+    double ScheduleReport::utilization() const {
+        if (threads.empty() || wallSeconds <= 0) {
+            return 0;
+        }
+        double busy = 0;
+        for (const Thread& thread : threads) {
+            busy += thread.busySeconds;
+        }
+        return busy / (wallSeconds * threads.size());
+    }
+
+    std::string ScheduleReport::summary() const {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1);
+        for (size_t t = 0; t < threads.size(); t++) {
+            double share = wallSeconds > 0 ? threads[t].busySeconds / wallSeconds : 0;
+            out << "thread " << t << ": " << threads[t].items << " glyphs, " << threads[t].busySeconds * 1000
+                << " ms busy, " << share * 100 << "% utilized\n";
+        }
+        out << loops << (loops == 1 ? " loop" : " loops") << " in " << wallSeconds * 1000 << " ms, "
+            << utilization() * 100 << "% utilized\n";
+        return out.str();
+    }
+
+    std::vector<size_t> largestFirst(const std::vector<size_t>& costs) {
+        std::vector<size_t> order(costs.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return costs[a] > costs[b]; });
+        return order;
+    }
+
+    void scheduleLargestFirst(const std::vector<size_t>& costs, const std::function<void(size_t)>& work) {
+        const std::vector<size_t> order = largestFirst(costs);
+        const int count = static_cast<int>(order.size());
+        internal::LoopTimer timer;
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int k = 0; k < count; k++) {
+            double startTime = timer.start();
+            work(order[k]);
+            timer.done(startTime);
+        }
+    }
+
+    namespace internal {
+        LoopTimer::LoopTimer() : report(currentReport), loopStart(0) {
+            if (report) {
+                threads.resize(threadCount());
+                loopStart = seconds();
+            }
+        }
+
+        LoopTimer::~LoopTimer() {
+            if (!report) {
+                return;
+            }
+            report->wallSeconds += seconds() - loopStart;
+            report->loops++;
+            if (report->threads.size() < threads.size()) {
+                report->threads.resize(threads.size());
+            }
+            for (size_t t = 0; t < threads.size(); t++) {
+                report->threads[t].items += threads[t].items;
+                report->threads[t].busySeconds += threads[t].busySeconds;
+            }
+        }
+
+        double LoopTimer::start() const { return report ? seconds() : 0; }
+
+        void LoopTimer::done(double startTime) {
+            if (!report) {
+                return;
+            }
+            // each thread only writes its own entry
+            ScheduleReport::Thread& thread = threads[threadNumber()];
+            thread.items++;
+            thread.busySeconds += seconds() - startTime;
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#include <llassetgen/internal/Cpu.h>
+
+#if defined(_MSC_VER) && defined(LLASSETGEN_X86)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+    llassetgen::internal::CpuFeatures detectCpuFeatures() {
+#ifdef LLASSETGEN_X86
+#if defined(__GNUC__)
+        __builtin_cpu_init();
+        return {__builtin_cpu_supports("sse2") != 0, __builtin_cpu_supports("sse4.1") != 0,
+                __builtin_cpu_supports("avx2") != 0};
+#elif defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+        __cpuid(info, 1);
+        bool sse2 = (info[3] & (1 << 26)) != 0;
+        bool sse41 = (info[2] & (1 << 19)) != 0;
+        bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+        bool avx2 = false;
+        if (maxLeaf >= 7 && osAvx) {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+        }
+        return {sse2, sse41, avx2};
+#endif
+#endif
+        return {false, false, false};
+    }
+}
+
+namespace llassetgen {
+    namespace internal {
+        const CpuFeatures& cpuFeatures() {
+            static const CpuFeatures features = detectCpuFeatures();
+            return features;
+        }
+    }
+}
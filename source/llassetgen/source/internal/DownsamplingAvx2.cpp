@@ -0,0 +1,35 @@
+#include <llassetgen/internal/Downsampling.h>
+
+#ifdef LLASSETGEN_X86
+
+#include <immintrin.h>
+
+namespace {
+    // Compiled with AVX2 enabled, only called after checking the CPU at runtime.
+    struct Avx2Lanes {
+        using Float = __m256;
+        static constexpr size_t count = 8;
+
+        static Float load(const float* data) { return _mm256_loadu_ps(data); }
+        static void store(float* data, Float value) { _mm256_storeu_ps(data, value); }
+        static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+        // like std::min(a, b): a unless b is less
+        static Float min(Float a, Float b) { return _mm256_min_ps(b, a); }
+    };
+}
+
+namespace llassetgen {
+    namespace internal {
+        void averageDownsampleRowAvx2(float* out, size_t outWidth, const float* src, size_t srcPitch, size_t xScale,
+                                      size_t yScale, float* accumulator) {
+            downsampleRow<Avx2Lanes, false>(out, outWidth, src, srcPitch, xScale, yScale, accumulator);
+        }
+
+        void minDownsampleRowAvx2(float* out, size_t outWidth, const float* src, size_t srcPitch, size_t xScale,
+                                  size_t yScale, float* accumulator) {
+            downsampleRow<Avx2Lanes, true>(out, outWidth, src, srcPitch, xScale, yScale, accumulator);
+        }
+    }
+}
+
+#endif
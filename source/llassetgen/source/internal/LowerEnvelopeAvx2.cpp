@@ -0,0 +1,56 @@
+#include <llassetgen/internal/LowerEnvelope.h>
+
+#ifdef LLASSETGEN_X86
+
+#include <immintrin.h>
+
+namespace {
+    // Compiled with AVX2 enabled, only called after checking the CPU at runtime.
+    struct Avx2Lanes {
+        using Float = __m256;
+        using Int = __m256i;
+        static constexpr size_t count = llassetgen::internal::avx2LowerEnvelopeLanes;
+
+        static Int laneIndices() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+        static Int set(int32_t value) { return _mm256_set1_epi32(value); }
+        static Float set(float value) { return _mm256_set1_ps(value); }
+        static Float allOnes() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+        static Float load(const float* data) { return _mm256_loadu_ps(data); }
+        static Float load(const uint32_t* data) {
+            return _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)));
+        }
+        static void store(float* data, Float value) { _mm256_storeu_ps(data, value); }
+        static void store(int32_t* data, Int value) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(data), value); }
+        static Float gather(const float* base, Int index) { return _mm256_i32gather_ps(base, index, 4); }
+        static Int gather(const int32_t* base, Int index) { return _mm256_i32gather_epi32(base, index, 4); }
+
+        static Int add(Int a, Int b) { return _mm256_add_epi32(a, b); }
+        static Int sub(Int a, Int b) { return _mm256_sub_epi32(a, b); }
+        static Int mul(Int a, Int b) { return _mm256_mullo_epi32(a, b); }
+        static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+        static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+        static Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+        static Float sqrt(Float a) { return _mm256_sqrt_ps(a); }
+        static Float toFloat(Int a) { return _mm256_cvtepi32_ps(a); }
+
+        static Float less(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static Float lessEqual(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+        static Float bitAnd(Float a, Float b) { return _mm256_and_ps(a, b); }
+        static Float andNot(Float a, Float b) { return _mm256_andnot_ps(a, b); }
+        static Float bitXor(Float a, Float b) { return _mm256_xor_ps(a, b); }
+        static Float select(Float mask, Float a, Float b) { return _mm256_blendv_ps(b, a, mask); }
+        static Int maskToInt(Float mask) { return _mm256_castps_si256(mask); }
+        static bool any(Float mask) { return _mm256_movemask_ps(mask) != 0; }
+    };
+}
+
+namespace llassetgen {
+    namespace internal {
+        void lowerEnvelopeAvx2(float* lines, const uint32_t* signMasks, size_t length, int32_t* apexes, float* begins,
+                               float* values) {
+            lowerEnvelope<Avx2Lanes>(lines, signMasks, length, apexes, begins, values);
+        }
+    }
+}
+
+#endif
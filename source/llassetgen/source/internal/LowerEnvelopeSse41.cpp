@@ -0,0 +1,64 @@
+#include <llassetgen/internal/LowerEnvelope.h>
+
+#ifdef LLASSETGEN_X86
+
+#include <smmintrin.h>
+
+namespace {
+    // Compiled with SSE4.1 enabled, only called after checking the CPU at runtime.
+    struct Sse41Lanes {
+        using Float = __m128;
+        using Int = __m128i;
+        static constexpr size_t count = llassetgen::internal::sse41LowerEnvelopeLanes;
+
+        static Int laneIndices() { return _mm_setr_epi32(0, 1, 2, 3); }
+        static Int set(int32_t value) { return _mm_set1_epi32(value); }
+        static Float set(float value) { return _mm_set1_ps(value); }
+        static Float allOnes() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+        static Float load(const float* data) { return _mm_loadu_ps(data); }
+        static Float load(const uint32_t* data) {
+            return _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+        }
+        static void store(float* data, Float value) { _mm_storeu_ps(data, value); }
+        static void store(int32_t* data, Int value) { _mm_storeu_si128(reinterpret_cast<__m128i*>(data), value); }
+
+        // SSE has no gather instruction, so the lanes are loaded one by one.
+        static Float gather(const float* base, Int index) {
+            return _mm_setr_ps(base[_mm_extract_epi32(index, 0)], base[_mm_extract_epi32(index, 1)],
+                               base[_mm_extract_epi32(index, 2)], base[_mm_extract_epi32(index, 3)]);
+        }
+        static Int gather(const int32_t* base, Int index) {
+            return _mm_setr_epi32(base[_mm_extract_epi32(index, 0)], base[_mm_extract_epi32(index, 1)],
+                                  base[_mm_extract_epi32(index, 2)], base[_mm_extract_epi32(index, 3)]);
+        }
+
+        static Int add(Int a, Int b) { return _mm_add_epi32(a, b); }
+        static Int sub(Int a, Int b) { return _mm_sub_epi32(a, b); }
+        static Int mul(Int a, Int b) { return _mm_mullo_epi32(a, b); }
+        static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+        static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+        static Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+        static Float sqrt(Float a) { return _mm_sqrt_ps(a); }
+        static Float toFloat(Int a) { return _mm_cvtepi32_ps(a); }
+
+        static Float less(Float a, Float b) { return _mm_cmplt_ps(a, b); }
+        static Float lessEqual(Float a, Float b) { return _mm_cmple_ps(a, b); }
+        static Float bitAnd(Float a, Float b) { return _mm_and_ps(a, b); }
+        static Float andNot(Float a, Float b) { return _mm_andnot_ps(a, b); }
+        static Float bitXor(Float a, Float b) { return _mm_xor_ps(a, b); }
+        static Float select(Float mask, Float a, Float b) { return _mm_blendv_ps(b, a, mask); }
+        static Int maskToInt(Float mask) { return _mm_castps_si128(mask); }
+        static bool any(Float mask) { return _mm_movemask_ps(mask) != 0; }
+    };
+}
+
+namespace llassetgen {
+    namespace internal {
+        void lowerEnvelopeSse41(float* lines, const uint32_t* signMasks, size_t length, int32_t* apexes,
+                                float* begins, float* values) {
+            lowerEnvelope<Sse41Lanes>(lines, signMasks, length, apexes, begins, values);
+        }
+    }
+}
+
+#endif
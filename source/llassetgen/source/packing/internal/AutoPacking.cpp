@@ -0,0 +1,216 @@
+#include <llassetgen/packing/internal/AutoPacking.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+#include <llassetgen/packing/internal/Common.h>
+#include <llassetgen/packing/internal/GuillotinePacker.h>
+#include <llassetgen/packing/internal/MaxRectsPacker.h>
+#include <llassetgen/packing/internal/ShelfPacker.h>
+#include <llassetgen/packing/internal/SkylinePacker.h>
+
+using llassetgen::GuillotineHeuristics;
+using llassetgen::PackingSizeType;
+using llassetgen::Rect;
+using llassetgen::Vec2;
+using llassetgen::internal::PackingStrategy;
+
+using Comparator = bool (*)(const Rect<PackingSizeType>&, const Rect<PackingSizeType>&);
+
+// The input orders of (Jylänki, 2010), all descending.
+
+bool byArea(const Rect<PackingSizeType>& rect1, const Rect<PackingSizeType>& rect2) {
+    return std::make_pair(rect1.size.x * rect1.size.y, std::max(rect1.size.x, rect1.size.y)) >
+           std::make_pair(rect2.size.x * rect2.size.y, std::max(rect2.size.x, rect2.size.y));
+}
+
+bool byPerimeter(const Rect<PackingSizeType>& rect1, const Rect<PackingSizeType>& rect2) {
+    return std::make_pair(rect1.size.x + rect1.size.y, std::max(rect1.size.x, rect1.size.y)) >
+           std::make_pair(rect2.size.x + rect2.size.y, std::max(rect2.size.x, rect2.size.y));
+}
+
+bool byLongSide(const Rect<PackingSizeType>& rect1, const Rect<PackingSizeType>& rect2) {
+    return std::make_pair(std::max(rect1.size.x, rect1.size.y), std::min(rect1.size.x, rect1.size.y)) >
+           std::make_pair(std::max(rect2.size.x, rect2.size.y), std::min(rect2.size.x, rect2.size.y));
+}
+
+bool byHeight(const Rect<PackingSizeType>& rect1, const Rect<PackingSizeType>& rect2) {
+    return std::make_pair(rect1.size.y, rect1.size.x) > std::make_pair(rect2.size.y, rect2.size.x);
+}
+
+bool byWidth(const Rect<PackingSizeType>& rect1, const Rect<PackingSizeType>& rect2) {
+    return std::make_pair(rect1.size.x, rect1.size.y) > std::make_pair(rect2.size.x, rect2.size.y);
+}
+
+/**
+ * A packer that gets the rectangles in another order than its own.
+ */
+template <class Packer, Comparator comparator>
+class ReorderedPacker : public Packer {
+   public:
+    using Packer::Packer;
+
+    static bool inputSortingComparator(const Rect<PackingSizeType>& rect1, const Rect<PackingSizeType>& rect2) {
+        return comparator(rect1, rect2);
+    }
+};
+
+// the packer with the given input order, a null comparator keeps its own order
+template <class Packer, Comparator comparator>
+struct Reordered {
+    using type = ReorderedPacker<Packer, comparator>;
+};
+
+template <class Packer>
+struct Reordered<Packer, nullptr> {
+    using type = Packer;
+};
+
+template <class Packer, class... PackerArgs>
+PackingStrategy makeStrategy(const std::string& name, PackerArgs... packerArgs) {
+    return {name, [=](const std::vector<Vec2<PackingSizeType>>& sizes, bool allowRotations,
+                      const Vec2<PackingSizeType>* maxPageSize) {
+                return maxPageSize ? llassetgen::internal::packAtlasPages<Packer>(sizes.begin(), sizes.end(),
+                                                                                  allowRotations, *maxPageSize,
+                                                                                  packerArgs...)
+                                   : llassetgen::internal::packAtlas<Packer>(sizes.begin(), sizes.end(),
+                                                                             allowRotations, packerArgs...);
+            }};
+}
+
+GuillotineHeuristics guillotineHeuristics(GuillotineHeuristics::FreeRectChoice choice,
+                                          GuillotineHeuristics::SplitRule split) {
+    GuillotineHeuristics heuristics;
+    heuristics.choice = choice;
+    heuristics.split = split;
+    return heuristics;
+}
+
+template <Comparator comparator>
+void addStrategies(std::vector<PackingStrategy>& strategies, const std::string& orderName) {
+    using namespace llassetgen::internal;
+    std::string suffix = orderName.empty() ? "" : ", " + orderName;
+    strategies.push_back(makeStrategy<typename Reordered<ShelfPacker, comparator>::type>("shelf" + suffix));
+    strategies.push_back(makeStrategy<typename Reordered<SkylinePacker, comparator>::type>("skyline" + suffix));
+    strategies.push_back(makeStrategy<typename Reordered<MaxRectsPacker, comparator>::type>("maxrects" + suffix));
+
+    // the default and the best other combinations of the choice and split heuristics in (Jylänki, 2010)
+    std::pair<std::string, GuillotineHeuristics> guillotineVariants[] = {
+        {"guillotine", {}},
+        {"guillotine (area fit, shorter leftover axis)",
+         guillotineHeuristics(GuillotineHeuristics::BestAreaFit, GuillotineHeuristics::ShorterLeftoverAxis)},
+        {"guillotine (short side fit, min area)",
+         guillotineHeuristics(GuillotineHeuristics::BestShortSideFit, GuillotineHeuristics::MinArea)},
+    };
+    using Guillotine = typename Reordered<GuillotinePacker, comparator>::type;
+    for (const auto& variant : guillotineVariants) {
+        strategies.push_back(makeStrategy<Guillotine>(variant.first + suffix, variant.second));
+    }
+}
+
+std::vector<PackingStrategy> makeStrategies() {
+    std::vector<PackingStrategy> strategies;
+    addStrategies<nullptr>(strategies, "");
+    addStrategies<byArea>(strategies, "by area");
+    addStrategies<byPerimeter>(strategies, "by perimeter");
+    addStrategies<byLongSide>(strategies, "by long side");
+    addStrategies<byHeight>(strategies, "by height");
+    addStrategies<byWidth>(strategies, "by width");
+    return strategies;
+}
+
+// the area of the bounding box of the rectangles on the last page
+uint64_t lastPageExtent(const llassetgen::Packing& packing) {
+    Vec2<PackingSizeType> extent{0, 0};
+    for (size_t i : packing.rectsOnPage(packing.pageCount() - 1)) {
+        const Rect<PackingSizeType>& rect = packing.rects[i];
+        extent.x = std::max<PackingSizeType>(extent.x, rect.position.x + rect.size.x);
+        extent.y = std::max<PackingSizeType>(extent.y, rect.position.y + rect.size.y);
+    }
+    return static_cast<uint64_t>(extent.x) * extent.y;
+}
+
+namespace llassetgen {
+    namespace internal {
+        const std::vector<PackingStrategy>& packingStrategies() {
+            static const std::vector<PackingStrategy> strategies = makeStrategies();
+            return strategies;
+        }
+
+        bool smallerPacking(const Packing& packing1, const Packing& packing2, size_t rectCount) {
+            bool failed1 = packing1.rects.size() != rectCount;
+            bool failed2 = packing2.rects.size() != rectCount;
+            if (failed1 || failed2) {
+                return !failed1;
+            }
+
+            auto area = [](const Packing& packing) {
+                return static_cast<uint64_t>(packing.atlasSize.x) * packing.atlasSize.y * packing.pageCount();
+            };
+            auto aspect = [](const Packing& packing) {
+                PackingSizeType shortSide = std::min(packing.atlasSize.x, packing.atlasSize.y);
+                return static_cast<double>(std::max(packing.atlasSize.x, packing.atlasSize.y)) /
+                       static_cast<double>(std::max<PackingSizeType>(shortSide, 1));
+            };
+            return std::make_tuple(area(packing1), lastPageExtent(packing1), aspect(packing1)) <
+                   std::make_tuple(area(packing2), lastPageExtent(packing2), aspect(packing2));
+        }
+
+        bool validPacking(const Packing& packing) {
+            for (size_t page = 0; page < packing.pageCount(); page++) {
+                std::vector<size_t> indices = packing.rectsOnPage(page);
+                std::sort(indices.begin(), indices.end(), [&packing](size_t i1, size_t i2) {
+                    return packing.rects[i1].position.x < packing.rects[i2].position.x;
+                });
+
+                for (size_t i = 0; i < indices.size(); i++) {
+                    const Rect<PackingSizeType>& rect = packing.rects[indices[i]];
+                    if (rect.position.x + rect.size.x > packing.atlasSize.x ||
+                        rect.position.y + rect.size.y > packing.atlasSize.y) {
+                        return false;
+                    }
+
+                    // only the rectangles starting left of the right edge of this one can overlap it
+                    for (size_t j = i + 1; j < indices.size(); j++) {
+                        const Rect<PackingSizeType>& other = packing.rects[indices[j]];
+                        if (other.position.x >= rect.position.x + rect.size.x) {
+                            break;
+                        }
+                        if (rect.overlaps(other)) {
+                            return false;
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+
+        Packing autoPackAtlas(const std::vector<Vec2<PackingSizeType>>& sizes, bool allowRotations,
+                              const Vec2<PackingSizeType>* maxPageSize) {
+            const std::vector<PackingStrategy>& strategies = packingStrategies();
+            std::vector<Packing> packings(strategies.size());
+
+            // Packing is cheap compared to the distance transforms, every strategy gets a thread of its own.
+#pragma omp parallel for schedule(dynamic, 1)
+            for (long i = 0; i < static_cast<long>(strategies.size()); i++) {
+                packings[i] = strategies[i].pack(sizes, allowRotations, maxPageSize);
+                // a packer bug must not win by overlapping rectangles, treat it as failed
+                if (!validPacking(packings[i])) {
+                    packings[i].rects.clear();
+                }
+            }
+
+            size_t best = 0;
+            for (size_t i = 1; i < packings.size(); i++) {
+                if (smallerPacking(packings[i], packings[best], sizes.size())) {
+                    best = i;
+                }
+            }
+            Packing packing = std::move(packings[best]);
+            packing.strategy = strategies[best].name;
+            return packing;
+        }
+    }
+}
@@ -42,12 +42,14 @@ namespace llassetgen {
             auto minWidthExponent = ceilLog2(maxSides.x);
             auto minHeightExponent = ceilLog2(maxSides.y);
 
+            // The area exponent is only below a side exponent if rectangles have zero
+            // area, the differences must not wrap around then.
             if (widthExponent < minWidthExponent) {
                 widthExponent = minWidthExponent;
-                heightExponent = std::max(minHeightExponent, areaExponent - widthExponent);
+                heightExponent = std::max(minHeightExponent, areaExponent - std::min(areaExponent, widthExponent));
             } else if (heightExponent < minHeightExponent) {
                 heightExponent = minHeightExponent;
-                widthExponent = std::max(minWidthExponent, areaExponent - heightExponent);
+                widthExponent = std::max(minWidthExponent, areaExponent - std::min(areaExponent, heightExponent));
             }
 
             return {1u << widthExponent, 1u << heightExponent};
@@ -0,0 +1,405 @@
+#include <llassetgen/packing/internal/FreeRectIndex.h>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace {
+    // cell size of the finest grid level, doubled on each level
+    constexpr llassetgen::PackingSizeType baseCellSize = 32;
+
+    // the number of cell sizes from baseCellSize up to the first one that covers `length`
+    size_t levelsFor(llassetgen::PackingSizeType length) {
+        size_t count = 1;
+        for (llassetgen::PackingSizeType cellSize = baseCellSize; cellSize < length; cellSize *= 2) {
+            count++;
+        }
+        return count;
+    }
+
+    // the first level whose cells are at least `length` long
+    size_t levelOf(llassetgen::PackingSizeType length) {
+        return levelsFor(length) - 1;
+    }
+}
+
+namespace llassetgen {
+    namespace internal {
+        constexpr FreeRectIndex::Id FreeRectIndex::none;
+
+        void SuffixMax::reset(size_t keyCount) {
+            leafCount = 1;
+            while (leafCount < keyCount) {
+                leafCount *= 2;
+            }
+            values.assign(keyCount, {});
+            tree.assign(2 * leafCount, 0);
+        }
+
+        void SuffixMax::insert(PackingSizeType key, PackingSizeType value) {
+            values[key].insert(value);
+            update(key);
+        }
+
+        void SuffixMax::erase(PackingSizeType key, PackingSizeType value) {
+            values[key].erase(values[key].find(value));
+            update(key);
+        }
+
+        void SuffixMax::update(size_t key) {
+            size_t node = leafCount + key;
+            tree[node] = values[key].empty() ? 0 : *values[key].rbegin();
+            for (node /= 2; node > 0; node /= 2) {
+                tree[node] = std::max(tree[2 * node], tree[2 * node + 1]);
+            }
+        }
+
+        PackingSizeType SuffixMax::maxFrom(PackingSizeType key) const {
+            if (key >= values.size()) {
+                return 0;
+            }
+            // walk up from the leaf, taking the right sibling of every left child
+            size_t node = leafCount + key;
+            PackingSizeType result = tree[node];
+            for (; node > 1; node /= 2) {
+                if (node % 2 == 0) {
+                    result = std::max(result, tree[node + 1]);
+                }
+            }
+            return result;
+        }
+
+        void FreeRectIndex::reset(const Vec2<PackingSizeType>& atlasSize,
+                                  const std::vector<Rect<PackingSizeType>>& rects) {
+            slots.clear();
+            unusedIds.clear();
+            order.clear();
+            withRelations.clear();
+            byWidth.assign(atlasSize.x + 1, {});
+            byHeight.assign(atlasSize.y + 1, {});
+            widestFrom.reset(atlasSize.y + 1);
+            highestFrom.reset(atlasSize.x + 1);
+
+            levelCount = {levelsFor(atlasSize.x), levelsFor(atlasSize.y)};
+            levels.assign(levelCount.x * levelCount.y, {});
+            for (size_t y = 0; y < levelCount.y; y++) {
+                for (size_t x = 0; x < levelCount.x; x++) {
+                    GridLevel& level = levels[y * levelCount.x + x];
+                    level.cellSize = {baseCellSize << x, baseCellSize << y};
+                    level.cellCount = {std::max<size_t>(1, (atlasSize.x + level.cellSize.x - 1) / level.cellSize.x),
+                                       std::max<size_t>(1, (atlasSize.y + level.cellSize.y - 1) / level.cellSize.y)};
+                }
+            }
+
+            changedIds.clear();
+            for (const auto& rect : rects) {
+                Id id = insert(rect);
+                slots[id].changed = true;
+                changedIds.push_back(id);
+            }
+            updateRelations();
+        }
+
+        std::vector<Rect<PackingSizeType>> FreeRectIndex::rects() const {
+            std::vector<Rect<PackingSizeType>> result;
+            result.reserve(order.size());
+            for (Id id : order) {
+                result.push_back(slots[id].rect);
+            }
+            return result;
+        }
+
+        std::vector<FreeRectIndex::Id>& FreeRectIndex::cell(Id id) {
+            const Slot& slot = slots[id];
+            GridLevel& level = levels[slot.level];
+            size_t x = std::min(slot.rect.position.x / level.cellSize.x, level.cellCount.x - 1);
+            size_t y = std::min(slot.rect.position.y / level.cellSize.y, level.cellCount.y - 1);
+            return level.cells[y * level.cellCount.x + x];
+        }
+
+        std::vector<size_t> FreeRectIndex::relatedPositions() const {
+            std::vector<size_t> positions;
+            positions.reserve(withRelations.size());
+            for (Id id : withRelations) {
+                positions.push_back(slots[id].position);
+            }
+            return positions;
+        }
+
+        std::vector<FreeRectIndex::Id> FreeRectIndex::overlapping(const Rect<PackingSizeType>& rect) const {
+            std::vector<Id> result;
+            auto collect = [&](const std::vector<Id>& ids) {
+                for (Id id : ids) {
+                    if (slots[id].rect.overlaps(rect)) {
+                        result.push_back(id);
+                    }
+                }
+            };
+
+            Vec2<PackingSizeType> end = rect.position + rect.size;
+            for (const GridLevel& level : levels) {
+                if (level.ids.empty()) {
+                    continue;
+                }
+                // the rects of the previous cell reach into the first one
+                size_t minX = rect.position.x / level.cellSize.x, minY = rect.position.y / level.cellSize.y;
+                minX = minX > 0 ? minX - 1 : 0;
+                minY = minY > 0 ? minY - 1 : 0;
+                size_t maxX = std::min((end.x - 1) / level.cellSize.x, level.cellCount.x - 1);
+                size_t maxY = std::min((end.y - 1) / level.cellSize.y, level.cellCount.y - 1);
+                if ((maxX + 1 - minX) * (maxY + 1 - minY) > level.ids.size()) {
+                    // fewer rects on this level than cells to look at
+                    collect(level.ids);
+                    continue;
+                }
+                for (size_t y = minY; y <= maxY; y++) {
+                    for (size_t x = minX; x <= maxX; x++) {
+                        collect(level.cells[y * level.cellCount.x + x]);
+                    }
+                }
+            }
+            return result;
+        }
+
+        std::vector<FreeRectIndex::Id> FreeRectIndex::containers(const Rect<PackingSizeType>& rect) const {
+            std::vector<Id> result;
+            for (size_t ky = levelOf(rect.size.y); ky < levelCount.y; ky++) {
+                for (size_t kx = levelOf(rect.size.x); kx < levelCount.x; kx++) {
+                    const GridLevel& level = levels[ky * levelCount.x + kx];
+                    if (level.ids.empty()) {
+                        continue;
+                    }
+                    // a container starts at most one cell before the corner of `rect`
+                    size_t maxX = std::min(rect.position.x / level.cellSize.x, level.cellCount.x - 1);
+                    size_t maxY = std::min(rect.position.y / level.cellSize.y, level.cellCount.y - 1);
+                    size_t minX = maxX > 0 ? maxX - 1 : 0, minY = maxY > 0 ? maxY - 1 : 0;
+                    for (size_t y = minY; y <= maxY; y++) {
+                        for (size_t x = minX; x <= maxX; x++) {
+                            for (Id id : level.cells[y * level.cellCount.x + x]) {
+                                if (slots[id].rect.contains(rect)) {
+                                    result.push_back(id);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            return result;
+        }
+
+        std::vector<FreeRectIndex::Id> FreeRectIndex::containees(Id id) const {
+            std::vector<Id> result;
+            for (Id other : slots[id].related) {
+                if (slots[id].rect.contains(slots[other].rect)) {
+                    result.push_back(other);
+                }
+            }
+            return result;
+        }
+
+        void FreeRectIndex::relate(Id id1, Id id2) {
+            slots[id1].related.push_back(id2);
+            slots[id2].related.push_back(id1);
+            withRelations.insert(id1);
+            withRelations.insert(id2);
+        }
+
+        void FreeRectIndex::updateRelations() {
+            for (Id id : changedIds) {
+                const auto& rect = slots[id].rect;
+                for (Id other : containers(rect)) {
+                    const Slot& otherSlot = slots[other];
+                    // equal changed rectangles find each other, the one with the smaller id relates them
+                    if (other == id || (otherSlot.changed && rect.contains(otherSlot.rect) && other < id)) {
+                        continue;
+                    }
+                    relate(id, other);
+                }
+                for (Id other : slots[id].candidates) {
+                    const Slot& otherSlot = slots[other];
+                    // changed and equal rectangles are found above
+                    if (otherSlot.position == none || otherSlot.changed || !rect.contains(otherSlot.rect) ||
+                        otherSlot.rect.contains(rect)) {
+                        continue;
+                    }
+                    relate(id, other);
+                }
+            }
+            for (Id id : changedIds) {
+                slots[id].changed = false;
+                slots[id].candidates.clear();
+            }
+            changedIds.clear();
+        }
+
+        void FreeRectIndex::add(Id id) {
+            Slot& slot = slots[id];
+            const auto& rect = slot.rect;
+            slot.level = levelOf(rect.size.y) * levelCount.x + levelOf(rect.size.x);
+            GridLevel& level = levels[slot.level];
+            if (level.cells.empty()) {
+                level.cells.resize(level.cellCount.x * level.cellCount.y);
+            }
+            slot.indexInLevel = level.ids.size();
+            level.ids.push_back(id);
+            cell(id).push_back(id);
+
+            byWidth[rect.size.x].emplace(slot.position, id);
+            byHeight[rect.size.y].emplace(slot.position, id);
+            widestFrom.insert(rect.size.y, rect.size.x);
+            highestFrom.insert(rect.size.x, rect.size.y);
+        }
+
+        void FreeRectIndex::remove(Id id) {
+            Slot& slot = slots[id];
+            const auto& rect = slot.rect;
+            for (Id other : slot.related) {
+                auto& otherRelated = slots[other].related;
+                otherRelated.erase(std::find(otherRelated.begin(), otherRelated.end(), id));
+                if (otherRelated.empty()) {
+                    withRelations.erase(other);
+                }
+            }
+            slot.related.clear();
+            withRelations.erase(id);
+
+            std::vector<Id>& cellIds = cell(id);
+            *std::find(cellIds.begin(), cellIds.end(), id) = cellIds.back();
+            cellIds.pop_back();
+            GridLevel& level = levels[slot.level];
+            slots[level.ids.back()].indexInLevel = slot.indexInLevel;
+            level.ids[slot.indexInLevel] = level.ids.back();
+            level.ids.pop_back();
+
+            byWidth[rect.size.x].erase({slot.position, id});
+            byHeight[rect.size.y].erase({slot.position, id});
+            widestFrom.erase(rect.size.y, rect.size.x);
+            highestFrom.erase(rect.size.x, rect.size.y);
+        }
+
+        void FreeRectIndex::move(Id id, size_t position) {
+            Slot& slot = slots[id];
+            byWidth[slot.rect.size.x].erase({slot.position, id});
+            byHeight[slot.rect.size.y].erase({slot.position, id});
+            slot.position = position;
+            byWidth[slot.rect.size.x].emplace(position, id);
+            byHeight[slot.rect.size.y].emplace(position, id);
+            order[position] = id;
+        }
+
+        FreeRectIndex::Id FreeRectIndex::insert(const Rect<PackingSizeType>& rect) {
+            Id id;
+            if (unusedIds.empty()) {
+                id = slots.size();
+                slots.emplace_back();
+            } else {
+                id = unusedIds.back();
+                unusedIds.pop_back();
+            }
+            Slot& slot = slots[id];
+            slot.rect = rect;
+            slot.position = order.size();
+            slot.changed = false;
+            order.push_back(id);
+            add(id);
+            return id;
+        }
+
+        void FreeRectIndex::split(Id id, const std::vector<Rect<PackingSizeType>>& parts) {
+            assert(!parts.empty());
+            // the rectangles contained in a part are contained in the split one
+            std::vector<Id> candidates = slots[id].changed ? slots[id].candidates : containees(id);
+            remove(id);
+            slots[id].rect = parts[0];
+            add(id);
+            if (!slots[id].changed) {
+                slots[id].changed = true;
+                changedIds.push_back(id);
+            }
+            slots[id].candidates = candidates;
+
+            for (size_t p = 1; p < parts.size(); p++) {
+                Id part = insert(parts[p]);
+                slots[part].changed = true;
+                slots[part].candidates = candidates;
+                changedIds.push_back(part);
+            }
+        }
+
+        void FreeRectIndex::swap(size_t position1, size_t position2) {
+            if (position1 == position2) {
+                return;
+            }
+            Id id1 = order[position1], id2 = order[position2];
+            move(id1, position2);
+            move(id2, position1);
+        }
+
+        void FreeRectIndex::pop() {
+            assert(!order.empty());
+            Id id = order.back();
+            remove(id);
+            order.pop_back();
+            Slot& slot = slots[id];
+            slot.position = none;
+            if (slot.changed) {
+                slot.changed = false;
+                slot.candidates.clear();
+                changedIds.erase(std::find(changedIds.begin(), changedIds.end(), id));
+            }
+            unusedIds.push_back(id);
+        }
+
+        FreeRectIndex::Id FreeRectIndex::firstWithSide(const std::vector<std::set<std::pair<size_t, Id>>>& groups,
+                                                       PackingSizeType side, PackingSizeType minOther,
+                                                       bool otherIsHeight) const {
+            if (side >= groups.size()) {
+                return none;
+            }
+            for (const auto& entry : groups[side]) {
+                const auto& size = slots[entry.second].rect.size;
+                if ((otherIsHeight ? size.y : size.x) >= minOther) {
+                    return entry.second;
+                }
+            }
+            return none;
+        }
+
+        FreeRectIndex::Id FreeRectIndex::bestFit(const Vec2<PackingSizeType>& size, PackingSizeType& score) const {
+            // The score of a free rect that fits is 0 if one of its sides equals the side of `size`, otherwise the
+            // unsigned wrap-around of minus its larger leftover. So the first rect with an equal side wins, then
+            // the first one with the largest leftover.
+            auto first = [&](PackingSizeType width, PackingSizeType height) -> Id {
+                Id byW = firstWithSide(byWidth, width, size.y, true);
+                Id byH = firstWithSide(byHeight, height, size.x, false);
+                if (byW == none || (byH != none && slots[byH].position < slots[byW].position)) {
+                    return byH;
+                }
+                return byW;
+            };
+
+            Id exact = first(size.x, size.y);
+            if (exact != none) {
+                score = 0;
+                return exact;
+            }
+
+            PackingSizeType widest = widestFrom.maxFrom(size.y);
+            PackingSizeType highest = highestFrom.maxFrom(size.x);
+            if (widest < size.x || highest < size.y) {
+                score = std::numeric_limits<PackingSizeType>::max();
+                return none;
+            }
+            PackingSizeType leftover = std::max(widest - size.x, highest - size.y);
+            score = PackingSizeType{0} - leftover;
+            if (score == std::numeric_limits<PackingSizeType>::max()) {
+                // A leftover of 1 on both sides wraps to the score of a rect that does not fit. All rects tie
+                // then, and the first one in list order wins, whether it fits or not.
+                Id firstId = order.front();
+                const Vec2<PackingSizeType>& firstSize = slots[firstId].rect.size;
+                return firstSize.x >= size.x && firstSize.y >= size.y ? firstId : none;
+            }
+            return first(size.x + leftover, size.y + leftover);
+        }
+    }
+}
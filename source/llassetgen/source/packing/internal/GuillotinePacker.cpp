@@ -0,0 +1,225 @@
+#include <llassetgen/packing/internal/GuillotinePacker.h>
+
+#include <algorithm>
+#include <utility>
+
+using llassetgen::GuillotineHeuristics;
+using llassetgen::PackingSizeType;
+using llassetgen::Rect;
+using llassetgen::Vec2;
+
+/**
+ * Score how well a rectangle of the given size fits into a free one, lower is
+ * better. The first component is the one of the heuristic, the second one
+ * breaks ties.
+ */
+std::pair<PackingSizeType, PackingSizeType> fitScore(GuillotineHeuristics::FreeRectChoice choice,
+                                                     const Vec2<PackingSizeType>& freeSize,
+                                                     const Vec2<PackingSizeType>& size) {
+    PackingSizeType leftoverX = freeSize.x - size.x;
+    PackingSizeType leftoverY = freeSize.y - size.y;
+    PackingSizeType shortSide = std::min(leftoverX, leftoverY);
+    if (choice == GuillotineHeuristics::BestAreaFit) {
+        return {freeSize.x * freeSize.y - size.x * size.y, shortSide};
+    }
+    return {shortSide, std::max(leftoverX, leftoverY)};
+}
+
+bool fits(const Vec2<PackingSizeType>& freeSize, const Vec2<PackingSizeType>& size) {
+    return freeSize.x >= size.x && freeSize.y >= size.y;
+}
+
+namespace llassetgen {
+    namespace internal {
+        GuillotinePacker::GuillotinePacker(const Vec2<PackingSizeType>& initialAtlasSize, bool _allowRotations,
+                                           bool _allowGrowth, const GuillotineHeuristics& _heuristics)
+            : BasePacker{initialAtlasSize, _allowRotations, _allowGrowth}, heuristics{_heuristics} {
+            addFreeRect({{0, 0}, initialAtlasSize});
+        }
+
+        bool GuillotinePacker::inputSortingComparator(const Rect<PackingSizeType>& rect1,
+                                                      const Rect<PackingSizeType>& rect2) {
+            // Sort by area descending (DESCA), then by shortest side descending
+            return std::make_pair(rect1.size.x * rect1.size.y, std::min(rect1.size.x, rect1.size.y)) >
+                   std::make_pair(rect2.size.x * rect2.size.y, std::min(rect2.size.x, rect2.size.y));
+        }
+
+        bool GuillotinePacker::pack(Rect<PackingSizeType>& rect) {
+            size_t freeRectIndex = findFreeRect(rect);
+            while (freeRectIndex == freeList.size()) {
+                if (!allowGrowth) {
+                    return false;
+                }
+                grow();
+                freeRectIndex = findFreeRect(rect);
+            }
+
+            Rect<PackingSizeType> freeRect = freeList[freeRectIndex];
+            rect.position = freeRect.position;
+            removeFreeRect(freeRectIndex);
+
+            // Cut the rest of the free rectangle in two, the part below the
+            // placed rectangle and the one right of it. The cut runs along
+            // the whole free rectangle on one axis.
+            Vec2<PackingSizeType> freeMin = freeRect.position;
+            Vec2<PackingSizeType> rectMax = rect.position + rect.size;
+            Vec2<PackingSizeType> leftover = freeRect.size - rect.size;
+            if (splitHorizontally(freeRect.size, rect.size)) {
+                addFreeRect({{freeMin.x, rectMax.y}, {freeRect.size.x, leftover.y}});
+                addFreeRect({{rectMax.x, freeMin.y}, {leftover.x, rect.size.y}});
+            } else {
+                addFreeRect({{freeMin.x, rectMax.y}, {rect.size.x, leftover.y}});
+                addFreeRect({{rectMax.x, freeMin.y}, {leftover.x, freeRect.size.y}});
+            }
+
+            return true;
+        }
+
+        size_t GuillotinePacker::findFreeRect(Rect<PackingSizeType>& rect) const {
+            size_t bestIndex = freeList.size();
+            std::pair<PackingSizeType, PackingSizeType> bestScore;
+            bool bestRotated = false;
+            Vec2<PackingSizeType> rotatedSize{rect.size.y, rect.size.x};
+            bool tryRotated = allowRotations && rect.size.x != rect.size.y;
+            const std::pair<PackingSizeType, PackingSizeType> perfectScore{0, 0};
+
+            for (size_t i = 0; i < freeList.size(); i++) {
+                const Vec2<PackingSizeType>& freeSize = freeList[i].size;
+                if (fits(freeSize, rect.size)) {
+                    auto score = fitScore(heuristics.choice, freeSize, rect.size);
+                    if (bestIndex == freeList.size() || score < bestScore) {
+                        bestIndex = i;
+                        bestScore = score;
+                        bestRotated = false;
+                    }
+                }
+                if (tryRotated && fits(freeSize, rotatedSize)) {
+                    auto score = fitScore(heuristics.choice, freeSize, rotatedSize);
+                    if (bestIndex == freeList.size() || score < bestScore) {
+                        bestIndex = i;
+                        bestScore = score;
+                        bestRotated = true;
+                    }
+                }
+                if (bestIndex != freeList.size() && bestScore == perfectScore) {
+                    // cannot be beaten
+                    break;
+                }
+            }
+
+            if (bestRotated) {
+                rect.size = rotatedSize;
+            }
+            return bestIndex;
+        }
+
+        bool GuillotinePacker::splitHorizontally(const Vec2<PackingSizeType>& freeSize,
+                                                 const Vec2<PackingSizeType>& size) const {
+            // A horizontal cut gives the part below the placed rectangle the whole width of the free one.
+            Vec2<PackingSizeType> leftover = freeSize - size;
+            switch (heuristics.split) {
+                case GuillotineHeuristics::ShorterLeftoverAxis:
+                    return leftover.x <= leftover.y;
+                case GuillotineHeuristics::LongerLeftoverAxis:
+                    return leftover.x > leftover.y;
+                case GuillotineHeuristics::MinArea:
+                    return size.x * leftover.y > leftover.x * size.y;
+                case GuillotineHeuristics::MaxArea:
+                    return size.x * leftover.y <= leftover.x * size.y;
+                case GuillotineHeuristics::ShorterAxis:
+                    return freeSize.x <= freeSize.y;
+                case GuillotineHeuristics::LongerAxis:
+                default:
+                    return freeSize.x > freeSize.y;
+            }
+        }
+
+        void GuillotinePacker::grow() {
+            if (atlasSize_.x > atlasSize_.y) {
+                addFreeRect({{0, atlasSize_.y}, atlasSize_});
+                atlasSize_.y *= 2;
+            } else {
+                addFreeRect({{atlasSize_.x, 0}, atlasSize_});
+                atlasSize_.x *= 2;
+            }
+        }
+
+        void GuillotinePacker::addFreeRect(Rect<PackingSizeType> rect) {
+            if (rect.size.x == 0 || rect.size.y == 0) {
+                return;
+            }
+
+            if (heuristics.merge) {
+                // Grow the rectangle by its neighbours as long as one of them shares a whole edge with it.
+                Rect<PackingSizeType> neighbour;
+                while (true) {
+                    const Vec2<PackingSizeType>& pos = rect.position;
+                    const Vec2<PackingSizeType>& size = rect.size;
+                    if (takeNeighbour(rightEdges, Edge{pos.x, pos.y, size.y}, neighbour)) {
+                        rect.position.x = neighbour.position.x;
+                        rect.size.x += neighbour.size.x;
+                    } else if (takeNeighbour(leftEdges, Edge{pos.x + size.x, pos.y, size.y}, neighbour)) {
+                        rect.size.x += neighbour.size.x;
+                    } else if (takeNeighbour(bottomEdges, Edge{pos.y, pos.x, size.x}, neighbour)) {
+                        rect.position.y = neighbour.position.y;
+                        rect.size.y += neighbour.size.y;
+                    } else if (takeNeighbour(topEdges, Edge{pos.y + size.y, pos.x, size.x}, neighbour)) {
+                        rect.size.y += neighbour.size.y;
+                    } else {
+                        break;
+                    }
+                }
+            }
+
+            freeList.push_back(rect);
+            if (heuristics.merge) {
+                indexEdges(freeList.size() - 1, true);
+            }
+        }
+
+        void GuillotinePacker::removeFreeRect(size_t index) {
+            size_t last = freeList.size() - 1;
+            if (heuristics.merge) {
+                indexEdges(index, false);
+                if (index != last) {
+                    indexEdges(last, false);
+                }
+            }
+
+            freeList[index] = freeList[last];
+            freeList.pop_back();
+            if (heuristics.merge && index != last) {
+                indexEdges(index, true);
+            }
+        }
+
+        bool GuillotinePacker::takeNeighbour(const std::map<Edge, size_t>& edges, const Edge& edge,
+                                             Rect<PackingSizeType>& neighbour) {
+            auto found = edges.find(edge);
+            if (found == edges.end()) {
+                return false;
+            }
+            neighbour = freeList[found->second];
+            removeFreeRect(found->second);
+            return true;
+        }
+
+        void GuillotinePacker::indexEdges(size_t index, bool insert) {
+            const Vec2<PackingSizeType>& pos = freeList[index].position;
+            const Vec2<PackingSizeType>& size = freeList[index].size;
+            std::pair<std::map<Edge, size_t>*, Edge> edges[] = {
+                {&leftEdges, Edge{pos.x, pos.y, size.y}},
+                {&rightEdges, Edge{pos.x + size.x, pos.y, size.y}},
+                {&topEdges, Edge{pos.y, pos.x, size.x}},
+                {&bottomEdges, Edge{pos.y + size.y, pos.x, size.x}},
+            };
+            for (const auto& entry : edges) {
+                if (insert) {
+                    (*entry.first)[entry.second] = index;
+                } else {
+                    entry.first->erase(entry.second);
+                }
+            }
+        }
+    }
+}
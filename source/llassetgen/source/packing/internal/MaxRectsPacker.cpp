@@ -1,7 +1,10 @@
 #include <llassetgen/packing/internal/MaxRectsPacker.h>
 
+#include <algorithm>
+#include <cassert>
 #include <iterator>
 #include <limits>
+#include <set>
 
 using llassetgen::PackingSizeType;
 using llassetgen::Rect;
@@ -11,40 +14,14 @@ bool isInRange(T value, T min, T max) {
     return value > min && value < max;
 }
 
-/**
- * Replace a rect in a vector by one or more replacements.
- *
- * Reuses the replaced rect before pushing to the end of the vector.
- */
-class RectReplacer {
-   private:
-    std::vector<Rect<PackingSizeType>>& vector;
-    Rect<PackingSizeType>& existing;
-    bool usedExisting = false;
-
-   public:
-    RectReplacer(std::vector<Rect<PackingSizeType>>& _vector, Rect<PackingSizeType>& _existing)
-        : vector(_vector), existing(_existing){};
-
-    void addReplacement(Rect<PackingSizeType>&& element);
-};
-
-void RectReplacer::addReplacement(Rect<PackingSizeType>&& element) {
-    if (!usedExisting) {
-        existing = element;
-        usedExisting = true;
-    } else {
-        vector.push_back(element);
-    }
-}
-
 /**
  * Crops a rectangle out of another, turning it into up to 4 remaining rectangles.
  *
  * The remaining rectangles have maximal width and height, and therefore
  * overlap.
  */
-void cropRect(const Rect<PackingSizeType>& rect, const Rect<PackingSizeType>& bbox, RectReplacer replacer) {
+void cropRect(const Rect<PackingSizeType>& rect, const Rect<PackingSizeType>& bbox,
+              std::vector<Rect<PackingSizeType>>& remainders) {
     auto rectMin = rect.position;
     auto rectMax = rect.position + rect.size;
     auto bboxMin = bbox.position;
@@ -52,57 +29,33 @@ void cropRect(const Rect<PackingSizeType>& rect, const Rect<PackingSizeType>& bb
 
     if (bboxMin.x < rectMax.x && bboxMax.x > rectMin.x) {
         if (isInRange(bboxMin.y, rectMin.y, rectMax.y)) {
-            replacer.addReplacement({rectMin, {rect.size.x, bboxMin.y - rectMin.y}});
+            remainders.push_back({rectMin, {rect.size.x, bboxMin.y - rectMin.y}});
         }
 
         if (isInRange(bboxMax.y, rectMin.y, rectMax.y)) {
-            replacer.addReplacement({{rectMin.x, bboxMax.y}, {rect.size.x, rectMax.y - bboxMax.y}});
+            remainders.push_back({{rectMin.x, bboxMax.y}, {rect.size.x, rectMax.y - bboxMax.y}});
         }
     }
 
     if (bboxMin.y < rectMax.y && bboxMax.y > rectMin.y) {
         if (isInRange(bboxMin.x, rectMin.x, rectMax.x)) {
-            replacer.addReplacement({rectMin, {bboxMin.x - rectMin.x, rect.size.y}});
+            remainders.push_back({rectMin, {bboxMin.x - rectMin.x, rect.size.y}});
         }
 
         if (isInRange(bboxMax.x, rectMin.x, rectMax.x)) {
-            replacer.addReplacement({{bboxMax.x, rectMin.y}, {rectMax.x - bboxMax.x, rect.size.y}});
+            remainders.push_back({{bboxMax.x, rectMin.y}, {rectMax.x - bboxMax.x, rect.size.y}});
         }
     }
 }
 
-bool canContain(const Rect<PackingSizeType>& free, const Rect<PackingSizeType>& toBePlaced) {
-    return free.size.x >= toBePlaced.size.x && free.size.y >= toBePlaced.size.y;
-}
-
-/**
- * Score how well a to be placed rectangle fits into a to a free one.
- *
- * Uses the best side short fit heuristic.
- */
-PackingSizeType bssfScore(const Rect<PackingSizeType>& free, const Rect<PackingSizeType>& toBePlaced) {
-    if (!canContain(free, toBePlaced)) {
-        return std::numeric_limits<PackingSizeType>::max();
-    }
-
-    auto remainder = toBePlaced.size - free.size;
-    return std::min(remainder.x, remainder.y);
-}
-
-class BssfComparator {
-   public:
-    explicit BssfComparator(const Rect<PackingSizeType>& _toBePlaced) : toBePlaced(_toBePlaced) {}
-
-    bool operator()(const Rect<PackingSizeType>& free1, const Rect<PackingSizeType>& free2) {
-        return bssfScore(free1, toBePlaced) < bssfScore(free2, toBePlaced);
-    }
-
-   private:
-    const Rect<PackingSizeType>& toBePlaced;
-};
-
 namespace llassetgen {
     namespace internal {
+        MaxRectsPacker::MaxRectsPacker(const Vec2<PackingSizeType>& initialAtlasSize, bool _allowRotations,
+                                       bool _allowGrowth)
+            : BasePacker{initialAtlasSize, _allowRotations, _allowGrowth} {
+            freeList.reset(initialAtlasSize, {{{0, 0}, initialAtlasSize}});
+        }
+
         bool MaxRectsPacker::inputSortingComparator(const Rect<PackingSizeType>& rect1,
                                                     const Rect<PackingSizeType>& rect2) {
             // Sort by shortest side fit descending (DESCSS)
@@ -110,109 +63,174 @@ namespace llassetgen {
         }
 
         bool MaxRectsPacker::pack(Rect<PackingSizeType>& rect) {
-            auto freeRectIter = findFreeRect(rect);
+            auto freeRectId = findFreeRect(rect);
             if (allowGrowth) {
-                while (freeRectIter == freeList.end() || !canContain(*freeRectIter, rect)) {
-                    grow();
-                    freeRectIter = findFreeRect(rect);
+                while (freeRectId == FreeRectIndex::none) {
+                    if (!grow()) {
+                        return false;
+                    }
+                    freeRectId = findFreeRect(rect);
                 }
             } else {
-                if (freeRectIter == freeList.end() || !canContain(*freeRectIter, rect)) {
+                if (freeRectId == FreeRectIndex::none) {
                     return false;
                 }
             }
 
-            rect.position = freeRectIter->position;
+            rect.position = freeList.rect(freeRectId).position;
             cropRects(rect);
             pruneFreeList();
 
             return true;
         }
 
-        void MaxRectsPacker::grow() {
+        bool MaxRectsPacker::grow() {
+            // A side that would overflow when doubled is not grown, packing fails
+            // instead of looping forever.
+            PackingSizeType& side = atlasSize_.x > atlasSize_.y ? atlasSize_.y : atlasSize_.x;
+            if (side == 0 || side > std::numeric_limits<PackingSizeType>::max() / 2) {
+                return false;
+            }
+
+            // rare enough to simply rebuild the index
+            std::vector<Rect<PackingSizeType>> freeRects = freeList.rects();
             if (atlasSize_.x > atlasSize_.y) {
-                for (auto& freeRect : freeList) {
+                for (auto& freeRect : freeRects) {
                     if (freeRect.position.y + freeRect.size.y == atlasSize_.y) {
                         freeRect.size.y += atlasSize_.y;
                     }
                 }
 
-                freeList.push_back({{0, atlasSize_.y}, atlasSize_});
+                freeRects.push_back({{0, atlasSize_.y}, atlasSize_});
                 atlasSize_.y *= 2;
             } else {
-                for (auto& freeRect : freeList) {
+                for (auto& freeRect : freeRects) {
                     if (freeRect.position.x + freeRect.size.x == atlasSize_.x) {
                         freeRect.size.x += atlasSize_.x;
                     }
                 }
 
-                freeList.push_back({{atlasSize_.x, 0}, atlasSize_});
+                freeRects.push_back({{atlasSize_.x, 0}, atlasSize_});
                 atlasSize_.x *= 2;
             }
+            freeList.reset(atlasSize_, freeRects);
+            return true;
         }
 
-        std::vector<Rect<PackingSizeType>>::const_iterator MaxRectsPacker::findFreeRect(
-            Rect<PackingSizeType>& rect) const {
-            if (freeList.empty()) {
-                return freeList.end();
-            }
-
-            auto freeRectIter = std::min_element(freeList.begin(), freeList.end(), BssfComparator{rect});
+        FreeRectIndex::Id MaxRectsPacker::findFreeRect(Rect<PackingSizeType>& rect) const {
+            // The best short side fit score of a free rect, computed as the unsigned difference of the sizes
+            // (rect - free), is 0 if a side fits exactly and wraps around otherwise. This prefers the largest
+            // leftover, which is kept for identical packings. See FreeRectIndex::bestFit.
+            PackingSizeType score;
+            auto freeRectId = freeList.bestFit(rect.size, score);
             if (allowRotations) {
-                Rect<PackingSizeType> rectRotated{rect.position, {rect.size.y, rect.size.x}};
-                auto freeRectRotatedIter =
-                    std::min_element(freeList.begin(), freeList.end(), BssfComparator{rectRotated});
-                if (bssfScore(*freeRectRotatedIter, rectRotated) < bssfScore(*freeRectIter, rect)) {
-                    rect.size = rectRotated.size;
-                    return freeRectRotatedIter;
+                Vec2<PackingSizeType> rotatedSize{rect.size.y, rect.size.x};
+                PackingSizeType rotatedScore;
+                auto freeRectRotatedId = freeList.bestFit(rotatedSize, rotatedScore);
+                if (rotatedScore < score) {
+                    rect.size = rotatedSize;
+                    return freeRectRotatedId;
                 }
             }
 
-            return freeRectIter;
+            return freeRectId;
         }
 
         void MaxRectsPacker::pruneFreeList() {
-            // Remove redundant rectangles by swapping them to the end of the vector
-            // and resizing the vector when done.
+            // Remove redundant rectangles by swapping them to the end of the list
+            // and resizing the list when done. Each rectangle is compared with
+            // the ones after it in list order, only the pairs in which one
+            // contains the other (see FreeRectIndex::related) have to be visited.
             if (freeList.empty()) {
                 return;
             }
 
-            auto endIter = std::prev(freeList.end());
-            for (auto iter1 = freeList.begin(); iter1 < endIter; ++iter1) {
-                for (auto iter2 = std::next(iter1); iter2 <= endIter;) {
-                    if (iter1->contains(*iter2)) {
-                        std::iter_swap(iter2, endIter--);
-                    } else if (iter2->contains(*iter1)) {
-                        std::iter_swap(iter1, endIter--);
+            std::vector<size_t> positions = freeList.relatedPositions();
+            std::set<size_t> pending(positions.begin(), positions.end());
+            size_t end = freeList.size() - 1;
+            while (!pending.empty() && *pending.begin() < end) {
+                size_t position1 = *pending.begin();
+                pending.erase(pending.begin());
+                auto id1 = freeList.idAt(position1);
+
+                while (true) {
+                    // the next related rectangle that is not removed yet
+                    size_t position2 = std::numeric_limits<size_t>::max();
+                    for (auto related : freeList.related(id1)) {
+                        size_t position = freeList.position(related);
+                        if (position > position1 && position <= end) {
+                            position2 = std::min(position2, position);
+                        }
+                    }
+                    if (position2 > end) {
                         break;
+                    }
+
+                    auto id2 = freeList.idAt(position2);
+                    if (freeList.rect(id1).contains(freeList.rect(id2))) {
+                        // the last rectangle takes the place of the removed one and is compared next
+                        bool lastPending = pending.erase(end) > 0;
+                        pending.erase(position2);
+                        freeList.swap(position2, end--);
+                        if (lastPending && position2 <= end) {
+                            pending.insert(position2);
+                        }
                     } else {
-                        ++iter2;
+                        assert(freeList.rect(id2).contains(freeList.rect(id1)));
+                        // the last rectangle takes the place of the removed one and is skipped
+                        pending.erase(end);
+                        freeList.swap(position1, end--);
+                        break;
                     }
                 }
             }
 
-            freeList.resize(endIter - freeList.begin() + 1);
+            while (freeList.size() > end + 1) {
+                freeList.pop();
+            }
         }
 
         void MaxRectsPacker::cropRects(const Rect<PackingSizeType>& placedRect) {
+            // Only the free rectangles overlapping the placed one change (a placed
+            // rectangle of zero width or height can still split the ones it
+            // crosses, so it is widened to one pixel). They are visited in list
+            // order, as if scanning the whole list.
+            Rect<PackingSizeType> searchRect{placedRect.position,
+                                             {std::max<PackingSizeType>(placedRect.size.x, 1),
+                                              std::max<PackingSizeType>(placedRect.size.y, 1)}};
+            std::vector<FreeRectIndex::Id> overlapping = freeList.overlapping(searchRect);
+            std::set<size_t> pending;
+            for (auto id : overlapping) {
+                pending.insert(freeList.position(id));
+            }
+
             size_t rectsToCrop = freeList.size();
-            for (size_t i = 0; i < rectsToCrop;) {
-                if (placedRect == freeList[i]) {
-                    std::swap(freeList[i], freeList[freeList.size() - 1]);
-                    freeList.resize(freeList.size() - 1);
-                    --rectsToCrop;
-                    // Is the swapped rectangle already created due to a crop?
-                    if (freeList.size() != rectsToCrop) {
-                        ++i;
+            std::vector<Rect<PackingSizeType>> remainders;
+            while (!pending.empty() && *pending.begin() < rectsToCrop) {
+                size_t i = *pending.begin();
+                pending.erase(pending.begin());
+                auto id = freeList.idAt(i);
+                if (placedRect.contains(freeList.rect(id))) {
+                    // Nothing remains of the free rectangle. The last rectangle still to crop takes
+                    // its place and is cropped next, the last one created by a crop (if any) takes
+                    // the place of that one.
+                    size_t lastToCrop = --rectsToCrop;
+                    bool lastPending = pending.erase(lastToCrop) > 0;
+                    freeList.swap(i, lastToCrop);
+                    freeList.swap(lastToCrop, freeList.size() - 1);
+                    freeList.pop();
+                    if (lastPending && i < rectsToCrop) {
+                        pending.insert(i);
                     }
                 } else {
-                    auto freeRectCopy = freeList[i];
-                    RectReplacer replacer{freeList, freeList[i]};
-                    cropRect(freeRectCopy, placedRect, replacer);
-                    ++i;
+                    remainders.clear();
+                    cropRect(freeList.rect(id), placedRect, remainders);
+                    if (!remainders.empty()) {
+                        freeList.split(id, remainders);
+                    }
                 }
             }
+            freeList.updateRelations();
         }
     }
 }
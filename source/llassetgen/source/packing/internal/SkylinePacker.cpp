@@ -0,0 +1,134 @@
+#include <llassetgen/packing/internal/SkylinePacker.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace llassetgen {
+    namespace internal {
+        SkylinePacker::SkylinePacker(const Vec2<PackingSizeType>& initialAtlasSize, bool _allowRotations,
+                                     bool _allowGrowth)
+            : BasePacker{initialAtlasSize, _allowRotations, _allowGrowth}, skyline{{0, 0, initialAtlasSize.x}} {}
+
+        bool SkylinePacker::inputSortingComparator(const Rect<PackingSizeType>& rect1,
+                                                   const Rect<PackingSizeType>& rect2) {
+            // Sort by height descending, then by width descending: the skyline stays flat while a row of
+            // equally high rectangles is filled
+            return std::make_pair(rect1.size.y, rect1.size.x) > std::make_pair(rect2.size.y, rect2.size.x);
+        }
+
+        bool SkylinePacker::pack(Rect<PackingSizeType>& rect) {
+            size_t segmentIndex;
+            while (!findPosition(rect, segmentIndex)) {
+                if (!allowGrowth) {
+                    return false;
+                }
+                grow();
+            }
+
+            place(rect, segmentIndex);
+            return true;
+        }
+
+        bool SkylinePacker::fit(size_t segmentIndex, const Vec2<PackingSizeType>& size, PackingSizeType& y) const {
+            PackingSizeType x = skyline[segmentIndex].x;
+            if (size.x > atlasSize_.x - x) {
+                return false;
+            }
+
+            // the rectangle rests on the lowest of the segments below it
+            y = 0;
+            PackingSizeType widthLeft = size.x;
+            for (size_t i = segmentIndex; i < skyline.size(); i++) {
+                y = std::max(y, skyline[i].y);
+                if (y + size.y > atlasSize_.y) {
+                    return false;
+                }
+                if (skyline[i].width >= widthLeft) {
+                    break;
+                }
+                widthLeft -= skyline[i].width;
+            }
+            return true;
+        }
+
+        bool SkylinePacker::findPosition(Rect<PackingSizeType>& rect, size_t& segmentIndex) const {
+            // Bottom left: the lowest bottom edge, then the leftmost position.
+            bool found = false;
+            PackingSizeType bestBottom = 0, bestX = 0;
+            Vec2<PackingSizeType> bestSize;
+            auto tryAll = [&](const Vec2<PackingSizeType>& size) {
+                for (size_t i = 0; i < skyline.size(); i++) {
+                    PackingSizeType y;
+                    if (!fit(i, size, y)) {
+                        continue;
+                    }
+                    PackingSizeType bottom = y + size.y;
+                    if (!found || bottom < bestBottom || (bottom == bestBottom && skyline[i].x < bestX)) {
+                        found = true;
+                        bestBottom = bottom;
+                        bestX = skyline[i].x;
+                        bestSize = size;
+                        segmentIndex = i;
+                    }
+                }
+            };
+
+            tryAll(rect.size);
+            if (allowRotations && rect.size.x != rect.size.y) {
+                tryAll({rect.size.y, rect.size.x});
+            }
+
+            if (found) {
+                rect.size = bestSize;
+                rect.position = {bestX, bestBottom - bestSize.y};
+            }
+            return found;
+        }
+
+        void SkylinePacker::grow() {
+            if (atlasSize_.x > atlasSize_.y) {
+                // the skyline does not depend on the height
+                atlasSize_.y *= 2;
+            } else {
+                if (skyline.back().y == 0) {
+                    skyline.back().width += atlasSize_.x;
+                } else {
+                    skyline.push_back({atlasSize_.x, 0, atlasSize_.x});
+                }
+                atlasSize_.x *= 2;
+            }
+        }
+
+        void SkylinePacker::place(const Rect<PackingSizeType>& rect, size_t segmentIndex) {
+            PackingSizeType left = rect.position.x;
+            PackingSizeType right = rect.position.x + rect.size.x;
+            skyline.insert(skyline.begin() + segmentIndex, {left, rect.position.y + rect.size.y, rect.size.x});
+
+            // shorten or remove the segments covered by the rectangle
+            size_t i = segmentIndex + 1;
+            while (i < skyline.size() && skyline[i].x < right) {
+                PackingSizeType segmentRight = skyline[i].x + skyline[i].width;
+                if (segmentRight <= right) {
+                    skyline.erase(skyline.begin() + i);
+                } else {
+                    skyline[i].width = segmentRight - right;
+                    skyline[i].x = right;
+                    break;
+                }
+            }
+
+            // merge the new segment with its neighbours of equal height
+            size_t j = segmentIndex > 0 ? segmentIndex - 1 : 0;
+            size_t next = segmentIndex + 1;
+            while (j < next && j + 1 < skyline.size()) {
+                if (skyline[j].y == skyline[j + 1].y) {
+                    skyline[j].width += skyline[j + 1].width;
+                    skyline.erase(skyline.begin() + j + 1);
+                    next--;
+                } else {
+                    j++;
+                }
+            }
+        }
+    }
+}
@@ -1,8 +1,13 @@
 #include <gmock/gmock.h>
 #include <llassetgen/Atlas.h>
+#include <llassetgen/FontFinder.h>
+#include <llassetgen/Schedule.h>
+#include <llassetgen/llassetgen.h>
 
 using namespace llassetgen;
 
+extern std::string test_source_path;
+
 std::string atlasTestDestinationPath = "../../";
 std::vector<Vec2<size_t>> atlasTestSizes{{1, 1}, {34, 5}, {23, 79}, {16, 70}, {91, 64}, {98, 82}, {54, 63}, {100, 6}};
 
@@ -43,3 +48,309 @@ TEST(AtlasTest, CreateFontAtlas) {
     std::string outPath = atlasTestDestinationPath + "atlas.png";
     atlas.exportPng<uint8_t>(outPath);
 }
+
+TEST(AtlasTest, PackedFontAtlas) {
+    init();
+    FontFinder fontFinder = FontFinder::fromPath(test_source_path + "SourceSansPro-Regular.ttf");
+    std::set<unsigned long> glyphSet;
+    for (unsigned long c = '!'; c <= '~'; c++) {
+        glyphSet.insert(c);
+    }
+    // odd sizes, such that most glyphs share bytes with their neighbours in the packed atlas
+    std::vector<Image> glyphImages = fontFinder.renderGlyphs(glyphSet, 19, 1, 1);
+    std::vector<Vec2<size_t>> sizes;
+    for (const auto& glyph : glyphImages) {
+        sizes.push_back(glyph.getSize());
+    }
+    Packing p = shelfPackAtlas(sizes.begin(), sizes.end(), false);
+
+    Image expected(p.atlasSize.x, p.atlasSize.y, 1);
+    expected.clear();
+    for (size_t i = 0; i < glyphImages.size(); i++) {
+        for (size_t y = 0; y < sizes[i].y; y++) {
+            for (size_t x = 0; x < sizes[i].x; x++) {
+                expected.setPixel<uint8_t>(p.rects[i].position + Vec2<size_t>{x, y},
+                                           glyphImages[i].getPixel<uint8_t>({x, y}));
+            }
+        }
+    }
+
+    std::vector<unsigned long> glyphs(glyphSet.begin(), glyphSet.end());
+    GlyphRenderer renderer = [&](const std::function<void(size_t, Image&)>& consumer) {
+        fontFinder.renderGlyphs(glyphs, 19, 1, 1, false, consumer);
+    };
+    Image packed = fontAtlas(glyphImages.begin(), glyphImages.end(), p);
+    Image packedDirect = fontAtlas(renderer, p);
+    Image bytes = fontAtlas(glyphImages.begin(), glyphImages.end(), p, 8);
+    Image bytesDirect = fontAtlas(renderer, p, 8);
+    for (size_t y = 0; y < p.atlasSize.y; y++) {
+        for (size_t x = 0; x < p.atlasSize.x; x++) {
+            uint8_t pixel = expected.getPixel<uint8_t>({x, y});
+            ASSERT_EQ(packed.getPixel<uint8_t>({x, y}), pixel) << x << ", " << y;
+            ASSERT_EQ(packedDirect.getPixel<uint8_t>({x, y}), pixel) << x << ", " << y;
+            ASSERT_EQ(bytes.getPixel<uint8_t>({x, y}), pixel * 255) << x << ", " << y;
+            ASSERT_EQ(bytesDirect.getPixel<uint8_t>({x, y}), pixel * 255) << x << ", " << y;
+        }
+    }
+}
+
+TEST(AtlasTest, DirectRenderMismatch) {
+    init();
+    FontFinder fontFinder = FontFinder::fromPath(test_source_path + "SourceSansPro-Regular.ttf");
+    std::set<unsigned long> glyphSet{'A', 'g', 'W'};
+    auto pack = [&](bool antiAliased) {
+        std::vector<Vec2<size_t>> rectSizes;
+        for (const auto& size : fontFinder.glyphSizes(glyphSet, 24, 0, 1, antiAliased)) {
+            rectSizes.push_back(size.second);
+        }
+        return shelfPackAtlas(rectSizes.begin(), rectSizes.end(), false);
+    };
+    Packing p = pack(false);
+
+    // rendered at another size than packed, rethrown once the rendering threads are done
+    std::vector<unsigned long> glyphs(glyphSet.begin(), glyphSet.end());
+    GlyphRenderer otherSize = [&](const std::function<void(size_t, Image&)>& consumer) {
+        fontFinder.renderGlyphs(glyphs, 19, 0, 1, false, consumer);
+    };
+    EXPECT_THROW(fontAtlas(otherSize, p), std::runtime_error);
+    auto dtFunc = [](Image& in, Image& out) { ParabolaEnvelope(in, out).transform(); };
+    EXPECT_THROW(distanceFieldAtlas(otherSize, p, dtFunc), std::runtime_error);
+
+    // anti-aliased glyphs do not fit into a 1 bit atlas
+    GlyphRenderer antiAliased = [&](const std::function<void(size_t, Image&)>& consumer) {
+        fontFinder.renderGlyphs(glyphs, 24, 0, 1, true, consumer);
+    };
+    Packing antiAliasedPacking = pack(true);
+    EXPECT_THROW(fontAtlas(antiAliased, antiAliasedPacking), std::runtime_error);
+    EXPECT_NO_THROW(fontAtlas(antiAliased, antiAliasedPacking, 8));
+}
+
+TEST(AtlasTest, DirectRender) {
+    init();
+    FontFinder fontFinder = FontFinder::fromPath(test_source_path + "SourceSansPro-Regular.ttf");
+    std::set<unsigned long> glyphSet{' ', '#', 'A', 'a', 'g', 'j', 'W', 0x4E00};
+    const size_t padding = 4, divisibleBy = 2;
+
+    std::vector<Image> glyphImages = fontFinder.renderGlyphs(glyphSet, 48, padding, divisibleBy);
+    std::map<unsigned long, Vec2<size_t>> glyphSizes = fontFinder.glyphSizes(glyphSet, 48, padding, divisibleBy);
+    ASSERT_EQ(glyphSizes.size(), glyphImages.size());
+
+    std::vector<unsigned long> glyphs;
+    std::vector<Vec2<size_t>> sizes;
+    for (const auto& glyphSize : glyphSizes) {
+        glyphs.push_back(glyphSize.first);
+        sizes.push_back(glyphSize.second / divisibleBy);
+        EXPECT_EQ(glyphSize.second, glyphImages[sizes.size() - 1].getSize());
+    }
+    Packing p = shelfPackAtlas(sizes.begin(), sizes.end(), false);
+    GlyphRenderer renderer = [&](const std::function<void(size_t, Image&)>& consumer) {
+        fontFinder.renderGlyphs(glyphs, 48, padding, divisibleBy, false, consumer);
+    };
+
+    auto dtFunc = [](Image& in, Image& out) { ParabolaEnvelope(in, out).transform(); };
+    auto downsampling = [](Image& in, Image& out) { in.averageDownsampling<DistanceTransform::OutputType>(out); };
+    Image expected = distanceFieldAtlas(glyphImages.begin(), glyphImages.end(), p, dtFunc, downsampling);
+    Image actual = distanceFieldAtlas(renderer, p, dtFunc, downsampling);
+    for (size_t y = 0; y < p.atlasSize.y; y++) {
+        for (size_t x = 0; x < p.atlasSize.x; x++) {
+            ASSERT_EQ(actual.getPixel<DistanceTransform::OutputType>({x, y}),
+                      expected.getPixel<DistanceTransform::OutputType>({x, y}));
+        }
+    }
+
+    // the font atlas is not downsampled
+    for (size_t i = 0; i < sizes.size(); i++) {
+        sizes[i] = glyphImages[i].getSize();
+    }
+    Packing fontPacking = shelfPackAtlas(sizes.begin(), sizes.end(), false);
+    Image expectedFont = fontAtlas(glyphImages.begin(), glyphImages.end(), fontPacking);
+    Image actualFont = fontAtlas(renderer, fontPacking);
+    for (size_t y = 0; y < fontPacking.atlasSize.y; y++) {
+        for (size_t x = 0; x < fontPacking.atlasSize.x; x++) {
+            ASSERT_EQ(actualFont.getPixel<uint8_t>({x, y}), expectedFont.getPixel<uint8_t>({x, y}));
+        }
+    }
+}
+
+TEST(AtlasTest, ScheduleLargestFirst) {
+    std::vector<size_t> costs{4, 9, 1, 9, 0, 16};
+    EXPECT_EQ(largestFirst(costs), (std::vector<size_t>{5, 1, 3, 0, 2, 4}));
+
+    std::vector<int> visits(costs.size(), 0);
+    ScheduleReport report;
+    {
+        // only the innermost report is filled
+        ScheduleReport inner;
+        scheduleLargestFirst(costs, [&](size_t i) { visits[i]++; });
+        EXPECT_EQ(inner.loops, 1u);
+    }
+    EXPECT_EQ(visits, std::vector<int>(costs.size(), 1));
+    EXPECT_EQ(report.loops, 0u);
+
+    scheduleLargestFirst(costs, [&](size_t i) { visits[i]++; });
+    EXPECT_EQ(visits, std::vector<int>(costs.size(), 2));
+    EXPECT_EQ(report.loops, 1u);
+    size_t items = 0;
+    for (const auto& thread : report.threads) {
+        items += thread.items;
+    }
+    EXPECT_EQ(items, costs.size());
+    EXPECT_GE(report.utilization(), 0);
+    EXPECT_LE(report.utilization(), 1);
+}
+
+TEST(AtlasTest, DirectRenderLargestFirst) {
+    init();
+    FontFinder fontFinder = FontFinder::fromPath(test_source_path + "SourceSansPro-Regular.ttf");
+    std::set<unsigned long> glyphSet{'.', '#', 'A', 'a', 'g', 'j', 'W', 0x4E00};
+    std::map<unsigned long, Vec2<size_t>> glyphSizes = fontFinder.glyphSizes(glyphSet, 48, 2);
+
+    std::vector<unsigned long> glyphs;
+    std::vector<Vec2<size_t>> sizes;
+    for (const auto& glyphSize : glyphSizes) {
+        glyphs.push_back(glyphSize.first);
+        sizes.push_back(glyphSize.second);
+    }
+    Packing p = shelfPackAtlas(sizes.begin(), sizes.end(), false);
+    std::vector<size_t> areas;
+    for (const auto& rect : p.rects) {
+        areas.push_back(rect.size.x * rect.size.y);
+    }
+
+    Image expected = fontAtlas(
+        [&](const std::function<void(size_t, Image&)>& consumer) {
+            fontFinder.renderGlyphs(glyphs, 48, 2, 1, false, consumer);
+        },
+        p);
+    ScheduleReport report;
+    Image actual = fontAtlas(
+        [&](const std::function<void(size_t, Image&)>& consumer) {
+            fontFinder.renderGlyphs(glyphs, 48, 2, 1, false, consumer, areas);
+        },
+        p);
+    for (size_t y = 0; y < p.atlasSize.y; y++) {
+        for (size_t x = 0; x < p.atlasSize.x; x++) {
+            ASSERT_EQ(actual.getPixel<uint8_t>({x, y}), expected.getPixel<uint8_t>({x, y}));
+        }
+    }
+    size_t items = 0;
+    for (const auto& thread : report.threads) {
+        items += thread.items;
+    }
+    EXPECT_EQ(items, glyphs.size());
+}
+
+TEST(AtlasTest, StreamDistanceFieldAtlas) {
+    std::vector<Image> glyphs;
+    for (const auto& size : atlasTestSizes) {
+        glyphs.emplace_back(size.x * 2, size.y * 2, 1);
+        glyphs.back().clear();
+        glyphs.back().fillRect<uint8_t>({size.x / 2, size.y / 2}, {size.x + 1, size.y + 1}, 1);
+    }
+    std::vector<Vec2<size_t>> sizes = atlasTestSizes;
+    Packing p = shelfPackAtlas(sizes.begin(), sizes.end(), false);
+
+    auto dtFunc = [](Image& in, Image& out) { ParabolaEnvelope(in, out).transform(); };
+    auto downsampling = [](Image& in, Image& out) { in.minDownsampling<DistanceTransform::OutputType>(out); };
+    Image expected = distanceFieldAtlas(glyphs.begin(), glyphs.end(), p, dtFunc, downsampling);
+    Image expectedFused = distanceFieldAtlas(glyphs.begin(), glyphs.end(), p, dtFunc);
+
+    GlyphChunkRenderer renderer = [&](const std::vector<size_t>& indices,
+                                      const std::function<void(size_t, Image&)>& consumer) {
+        for (size_t i : indices) {
+            consumer(i, glyphs[i]);
+        }
+    };
+    for (size_t bandHeight : {1, 7, 64, 1000}) {
+        for (bool fused : {false, true}) {
+            Image actual{p.atlasSize.x, p.atlasSize.y, DistanceTransform::bitDepth};
+            size_t row = 0;
+            auto writeRows = [&](const Image& rows) {
+                ASSERT_EQ(rows.getWidth(), p.atlasSize.x);
+                ASSERT_LE(rows.getHeight(), bandHeight);
+                for (size_t y = 0; y < rows.getHeight(); y++, row++) {
+                    const auto* source = rows.getRowData<DistanceTransform::OutputType>(y);
+                    std::copy(source, source + rows.getWidth(), actual.getRowData<DistanceTransform::OutputType>(row));
+                }
+            };
+            if (fused) {
+                streamDistanceFieldAtlas(renderer, p, dtFunc, bandHeight, writeRows);
+            } else {
+                streamDistanceFieldAtlas(renderer, p, dtFunc, downsampling, bandHeight, writeRows);
+            }
+            ASSERT_EQ(row, p.atlasSize.y);
+
+            const Image& reference = fused ? expectedFused : expected;
+            for (size_t y = 0; y < p.atlasSize.y; y++) {
+                for (size_t x = 0; x < p.atlasSize.x; x++) {
+                    ASSERT_EQ(actual.getPixel<DistanceTransform::OutputType>({x, y}),
+                              reference.getPixel<DistanceTransform::OutputType>({x, y}))
+                        << "band height " << bandHeight << " at " << x << ", " << y;
+                }
+            }
+        }
+    }
+}
+
+TEST(AtlasTest, QuantizedDistanceFieldAtlas) {
+    std::vector<Image> glyphs;
+    for (const auto& size : atlasTestSizes) {
+        glyphs.emplace_back(size.x * 2, size.y * 2, 1);
+        glyphs.back().clear();
+        glyphs.back().fillRect<uint8_t>({size.x / 2, size.y / 2}, {size.x + 1, size.y + 1}, 1);
+    }
+    std::vector<Vec2<size_t>> sizes = atlasTestSizes;
+    Packing p = shelfPackAtlas(sizes.begin(), sizes.end(), false);
+
+    auto dtFunc = [](Image& in, Image& out) { ParabolaEnvelope(in, out).transform(); };
+    auto downsampling = [](Image& in, Image& out) { in.averageDownsampling<DistanceTransform::OutputType>(out); };
+    Image reference = distanceFieldAtlas(glyphs.begin(), glyphs.end(), p, dtFunc, downsampling);
+    Image referenceFused = distanceFieldAtlas(glyphs.begin(), glyphs.end(), p, dtFunc);
+
+    for (uint8_t bitDepth : {8, 16}) {
+        Quantization quantization{bitDepth, 10, -5, false};
+        Image expected{p.atlasSize.x, p.atlasSize.y, bitDepth};
+        expected.quantize<DistanceTransform::OutputType>(reference, quantization.black, quantization.white);
+        Image expectedFused{p.atlasSize.x, p.atlasSize.y, bitDepth};
+        expectedFused.quantize<DistanceTransform::OutputType>(referenceFused, quantization.black, quantization.white);
+
+        Image actual = distanceFieldAtlas(glyphs.begin(), glyphs.end(), p, dtFunc, downsampling, quantization);
+        Image actualFused = distanceFieldAtlas(glyphs.begin(), glyphs.end(), p, dtFunc, quantization);
+        ASSERT_EQ(actual.getBitDepth(), bitDepth);
+        for (size_t y = 0; y < p.atlasSize.y; y++) {
+            for (size_t x = 0; x < p.atlasSize.x; x++) {
+                if (bitDepth == 8) {
+                    ASSERT_EQ(actual.getPixel<uint8_t>({x, y}), expected.getPixel<uint8_t>({x, y}));
+                    ASSERT_EQ(actualFused.getPixel<uint8_t>({x, y}), expectedFused.getPixel<uint8_t>({x, y}));
+                } else {
+                    ASSERT_EQ(actual.getPixel<uint16_t>({x, y}), expected.getPixel<uint16_t>({x, y}));
+                    ASSERT_EQ(actualFused.getPixel<uint16_t>({x, y}), expectedFused.getPixel<uint16_t>({x, y}));
+                }
+            }
+        }
+    }
+}
+
+TEST(AtlasTest, HalfFloatDistanceFieldAtlas) {
+    std::vector<Image> glyphs;
+    for (const auto& size : atlasTestSizes) {
+        glyphs.emplace_back(size.x * 2, size.y * 2, 1);
+        glyphs.back().clear();
+        glyphs.back().fillRect<uint8_t>({size.x / 2, size.y / 2}, {size.x + 1, size.y + 1}, 1);
+    }
+    std::vector<Vec2<size_t>> sizes = atlasTestSizes;
+    Packing p = shelfPackAtlas(sizes.begin(), sizes.end(), false);
+
+    auto dtFunc = [](Image& in, Image& out) { ParabolaEnvelope(in, out).transform(); };
+    auto downsampling = [](Image& in, Image& out) { in.averageDownsampling<DistanceTransform::OutputType>(out); };
+    Image reference = distanceFieldAtlas(glyphs.begin(), glyphs.end(), p, dtFunc, downsampling);
+    Image actual =
+        distanceFieldAtlas(glyphs.begin(), glyphs.end(), p, dtFunc, downsampling, Quantization{16, 0, 0, true});
+    ASSERT_EQ(actual.getBitDepth(), 16);
+    for (size_t y = 0; y < p.atlasSize.y; y++) {
+        for (size_t x = 0; x < p.atlasSize.x; x++) {
+            float expected = reference.getPixel<DistanceTransform::OutputType>({x, y});
+            ASSERT_EQ(actual.getPixel<Half>({x, y}).getBits(), Half(expected).getBits());
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include <llassetgen/llassetgen.h>
+
+using namespace llassetgen;
+
+/*
+ * The benchmarks are disabled by default, run them with
+ *   llassetgen-tests --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+ */
+
+template <class Func>
+double measureMilliseconds(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/*
+ * A filled disc with a grid of small squares around it, so that both passes see long runs as well as many edges.
+ */
+Image benchmarkMask(size_t size) {
+    Image mask(size, size, 1);
+    long center = static_cast<long>(size / 2), radius = static_cast<long>(size / 3);
+    for (size_t y = 0; y < size; y++) {
+        for (size_t x = 0; x < size; x++) {
+            long dx = static_cast<long>(x) - center, dy = static_cast<long>(y) - center;
+            bool inside = dx * dx + dy * dy < radius * radius || (x % 64 < 8 && y % 64 < 8);
+            mask.setPixel<uint8_t>({x, y}, inside);
+        }
+    }
+    return mask;
+}
+
+TEST(DistanceTransformBenchmark, DISABLED_ParabolaEnvelopeColumnBlocking) {
+    for (size_t size : {512, 2048, 8192}) {
+        Image input = benchmarkMask(size);
+        Image output(size, size, DistanceTransform::bitDepth);
+        for (size_t blockWidth : {size_t(1), ParabolaEnvelope::defaultColumnBlockWidth}) {
+            double ms = measureMilliseconds([&] { ParabolaEnvelope(input, output, blockWidth).transform(); });
+            std::cout << size << "x" << size << ", column block width " << blockWidth << ": " << ms << " ms"
+                      << std::endl;
+        }
+    }
+}
+
+TEST(DistanceTransformBenchmark, DISABLED_SimdParabolaEnvelope) {
+    std::cout << "SIMD lanes: " << SimdParabolaEnvelope::laneCount() << std::endl;
+    for (size_t size : {512, 2048, 8192}) {
+        Image input = benchmarkMask(size);
+        Image output(size, size, DistanceTransform::bitDepth);
+        double scalarMs = measureMilliseconds([&] { ParabolaEnvelope(input, output).transform(); });
+        double simdMs = measureMilliseconds([&] { SimdParabolaEnvelope(input, output).transform(); });
+        std::cout << size << "x" << size << ": parabola " << scalarMs << " ms, parabola-simd " << simdMs << " ms"
+                  << std::endl;
+    }
+}
+
+TEST(DownsamplingBenchmark, DISABLED_SimdDownsampling) {
+    for (size_t ratio : {2, 4, 8}) {
+        // about a thousand glyph distance fields of 128x128 at once
+        Image input(4096, 4096, DistanceTransform::bitDepth);
+        ParabolaEnvelope(benchmarkMask(4096), input).transform();
+        Image output(4096 / ratio, 4096 / ratio, DistanceTransform::bitDepth);
+        double average = measureMilliseconds([&] { output.averageDownsampling<float>(input); });
+        double simdAverage = measureMilliseconds([&] { output.simdAverageDownsampling(input); });
+        double minimum = measureMilliseconds([&] { output.minDownsampling<float>(input); });
+        double simdMinimum = measureMilliseconds([&] { output.simdMinDownsampling(input); });
+        std::cout << "ratio " << ratio << ": average " << average << " ms, average-simd " << simdAverage
+                  << " ms, min " << minimum << " ms, min-simd " << simdMinimum << " ms" << std::endl;
+    }
+}
+
+TEST(ImageBenchmark, DISABLED_PackedBlits) {
+    // a 1 bit atlas filled with views at odd bit offsets, like the glyphs of a packed font atlas
+    Image source = benchmarkMask(4096);
+    Image atlas(4096 + 7, 4096, 1);
+    for (size_t offset : {0, 3}) {
+        Image target = atlas.view({offset, 0}, {offset + 4096, 4096});
+        Image sourceView = source.view({5, 0}, {4096, 4096});
+        Image targetView = target.view({0, 0}, {4091, 4096});
+        double perPixel = measureMilliseconds([&] {
+            for (size_t y = 0; y < 4096; y++) {
+                for (size_t x = 0; x < 4091; x++) {
+                    targetView.setPixel<uint8_t>({x, y}, sourceView.getPixel<uint8_t>({x, y}));
+                }
+            }
+        });
+        double words = measureMilliseconds([&] { targetView.copyDataFrom(sourceView); });
+        std::cout << "4091x4096 from bit offset 5 to " << offset << ": per pixel " << perPixel
+                  << " ms, copyDataFrom " << words << " ms" << std::endl;
+    }
+}
+
+TEST(PackingBenchmark, DISABLED_MaxRectsManyRects) {
+    for (size_t count : {1000, 10000, 100000}) {
+        // glyph-like sizes, about one font's worth of glyphs per thousand
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<PackingSizeType> side(4, 64);
+        std::vector<Vec2<PackingSizeType>> sizes(count);
+        for (auto& size : sizes) {
+            size = {side(generator), side(generator)};
+        }
+        Packing packing;
+        double ms = measureMilliseconds([&] { packing = maxRectsPackAtlas(sizes.begin(), sizes.end(), true); });
+        std::cout << count << " rects: " << ms << " ms, atlas " << packing.atlasSize.x << "x" << packing.atlasSize.y
+                  << std::endl;
+    }
+}
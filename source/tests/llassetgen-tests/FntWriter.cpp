@@ -113,3 +113,36 @@ TEST(FntWriterTest, fntScaling) {
 
 	writer.saveFnt(testDestinationPath + "fnt_scaled.fnt");
 }
+
+TEST(FntWriterTest, fntPages) {
+	std::string testSourcePath = "../../../source/tests/llassetgen-tests/testfiles/";
+	std::string testDestinationPath = "../../";
+
+	init();
+
+	FT_Face face;
+	std::string faceName = "OpenSans-Regular.ttf";
+	std::string fontFile = testSourcePath + faceName;
+
+	FT_Error faceCreated = FT_New_Face(freetype, fontFile.c_str(), 0, &face);
+	EXPECT_EQ(faceCreated, 0);
+
+	FntWriter writer = FntWriter(face, faceName, 32, 1.0f, 0);
+	std::set<FT_ULong> charcodes{'A', 'B'};
+	writer.readFont(charcodes.begin(), charcodes.end());
+
+	writer.setCharInfo('A', Rect<PackingSizeType>({ 0, 0 }, { 10, 10 }), 0);
+	writer.setCharInfo('B', Rect<PackingSizeType>({ 0, 0 }, { 10, 10 }), 1);
+	writer.setAtlasProperties({ 64, 64 }, { "atlas_0.png", "atlas_1.png" });
+
+	writer.saveFnt(testDestinationPath + "fnt_pages.fnt");
+
+	std::ifstream fntFile(testDestinationPath + "fnt_pages.fnt");
+	std::string content((std::istreambuf_iterator<char>(fntFile)), std::istreambuf_iterator<char>());
+	EXPECT_NE(content.find(" pages=2 "), std::string::npos);
+	EXPECT_NE(content.find("page id=0 file=\"atlas_0.png\"\n"), std::string::npos);
+	EXPECT_NE(content.find("page id=1 file=\"atlas_1.png\"\n"), std::string::npos);
+	EXPECT_NE(content.find("char id=65 "), std::string::npos);
+	EXPECT_NE(content.find(" page=0 "), std::string::npos);
+	EXPECT_NE(content.find(" page=1 "), std::string::npos);
+}
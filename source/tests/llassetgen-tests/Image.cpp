@@ -2,9 +2,13 @@
 #include FT_FREETYPE_H
 
 #include <gmock/gmock.h>
+#include <llassetgen/internal/Downsampling.h>
 #include <llassetgen/llassetgen.h>
 
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <functional>
 
 using namespace llassetgen;
 
@@ -45,6 +49,57 @@ TEST(ImageTest, LoadTTF) {
     canvas.exportPng<uint8_t>(test_destination_path + "glyph1_out.png", 0, 1);
 }
 
+TEST(ImageTest, LoadAntiAliasedTTF) {
+    init();
+
+    FT_Face face;
+    std::string font_file = test_source_path + "SourceSansPro-Regular.ttf";
+    ASSERT_EQ(FT_New_Face(freetype, font_file.c_str(), 0, &face), 0);
+    ASSERT_EQ(FT_Set_Pixel_Sizes(face, 64, 64), 0);
+    ASSERT_EQ(FT_Load_Glyph(face, FT_Get_Char_Index(face, 'J'), FT_LOAD_RENDER | FT_LOAD_TARGET_NORMAL), 0);
+
+    const FT_Bitmap& bitmap = face->glyph->bitmap;
+    size_t padding = 3;
+    Image glyph(bitmap, padding, 4);
+    EXPECT_EQ(glyph.getBitDepth(), 8);
+    EXPECT_EQ(glyph.getWidth() % 4, 0);
+    EXPECT_EQ(glyph.getHeight() % 4, 0);
+    for (size_t y = 0; y < glyph.getHeight(); y++) {
+        for (size_t x = 0; x < glyph.getWidth(); x++) {
+            bool inBitmap = x >= padding && x < padding + bitmap.width && y >= padding && y < padding + bitmap.rows;
+            uint8_t expected = inBitmap ? bitmap.buffer[(y - padding) * bitmap.pitch + x - padding] : 0;
+            EXPECT_EQ(glyph.getPixel<uint8_t>({x, y}), expected);
+        }
+    }
+    FT_Done_Face(face);
+}
+
+TEST(ImageTest, RenderGlyphsParallel) {
+    init();
+
+    FontFinder fontFinder = FontFinder::fromPath(test_source_path + "SourceSansPro-Regular.ttf");
+    std::set<unsigned long> glyphs{' ', 'A', 'J', 'g', 0x2603, '%', 'x', '@', 'W', 0x00e9};
+    for (bool antiAliased : {false, true}) {
+        fontFinder.nonDepictableChars.clear();
+        std::vector<Image> expected = fontFinder.renderGlyphs(glyphs, 48, 2, 4, antiAliased);
+        std::set<FT_ULong> expectedNonDepictable = fontFinder.nonDepictableChars;
+
+        fontFinder.nonDepictableChars.clear();
+        std::vector<Image> images = fontFinder.renderGlyphsParallel(glyphs, 48, 2, 4, antiAliased);
+        EXPECT_EQ(fontFinder.nonDepictableChars, expectedNonDepictable);
+        ASSERT_EQ(images.size(), expected.size());
+        for (size_t i = 0; i < images.size(); i++) {
+            ASSERT_EQ(images[i].getSize(), expected[i].getSize());
+            ASSERT_EQ(images[i].getBitDepth(), expected[i].getBitDepth());
+            for (size_t y = 0; y < images[i].getHeight(); y++) {
+                for (size_t x = 0; x < images[i].getWidth(); x++) {
+                    EXPECT_EQ(images[i].getPixel<uint8_t>({x, y}), expected[i].getPixel<uint8_t>({x, y}));
+                }
+            }
+        }
+    }
+}
+
 TEST(ImageTest, CreateAndWriteOneBitPNG) {
     Image blank_1bit(2, 2, 1);
     blank_1bit.setPixel<uint8_t>(Vec2<size_t>(0, 0), 1);
@@ -108,6 +163,367 @@ TEST(ImageTest, FloatExport) {
                                  float(float_image.getWidth() + float_image.getHeight()));
 }
 
+TEST(ImageTest, PngRowWriter) {
+    Image float_image(100, 37, 32);
+    for (size_t y = 0; y < float_image.getHeight(); y++) {
+        for (size_t x = 0; x < float_image.getWidth(); x++) {
+            float_image.setPixel<float>(Vec2<size_t>(x, y), float(x) - float(y));
+        }
+    }
+    float_image.exportPng<float>(test_destination_path + "rows_whole.png", -40.0f, 100.0f);
+    {
+        PngRowWriter writer(test_destination_path + "rows_streamed.png", 100, 37, 32);
+        for (size_t y = 0; y < float_image.getHeight(); y += 10) {
+            size_t end = std::min<size_t>(y + 10, float_image.getHeight());
+            writer.writeRows<float>(float_image.view({0, y}, {100, end}), -40.0f, 100.0f);
+        }
+    }
+
+    auto readFile = [](const std::string& path) {
+        std::ifstream file(path, std::ifstream::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+    EXPECT_EQ(readFile(test_destination_path + "rows_whole.png"),
+              readFile(test_destination_path + "rows_streamed.png"));
+}
+
+TEST(ImageTest, HalfConversion) {
+    // every half except NaN survives the round trip through float
+    for (uint32_t bits = 0; bits <= 0xFFFF; bits++) {
+        Half half = Half::fromBits(static_cast<uint16_t>(bits));
+        if (std::isnan(float(half))) {
+            EXPECT_TRUE(std::isnan(float(Half(float(half)))));
+        } else {
+            EXPECT_EQ(Half(float(half)).getBits(), bits);
+        }
+    }
+
+    EXPECT_EQ(Half(1.0f).getBits(), 0x3C00);
+    EXPECT_EQ(Half(-2.0f).getBits(), 0xC000);
+    EXPECT_EQ(Half(-0.0f).getBits(), 0x8000);
+    EXPECT_EQ(Half(65504.0f).getBits(), 0x7BFF);
+    EXPECT_EQ(Half(65519.0f).getBits(), 0x7BFF);
+    EXPECT_EQ(Half(65520.0f).getBits(), 0x7C00);
+    EXPECT_EQ(Half(std::numeric_limits<float>::infinity()).getBits(), 0x7C00);
+    EXPECT_EQ(Half(std::ldexp(1.0f, -24)).getBits(), 0x0001);
+    EXPECT_EQ(Half(std::ldexp(1.0f, -25)).getBits(), 0x0000);
+    EXPECT_EQ(Half(std::ldexp(1.5f, -25)).getBits(), 0x0001);
+    EXPECT_EQ(Half(std::ldexp(3.0f, -25)).getBits(), 0x0002);
+    // ties round to even
+    EXPECT_EQ(Half(1.0f + std::ldexp(1.0f, -11)).getBits(), 0x3C00);
+    EXPECT_EQ(Half(1.0f + std::ldexp(3.0f, -11)).getBits(), 0x3C02);
+    EXPECT_EQ(Half(1.0f + std::ldexp(1.0f, -11) + std::ldexp(1.0f, -20)).getBits(), 0x3C01);
+}
+
+TEST(ImageTest, HalfDownsampling) {
+    Image input(8, 4, 16);
+    for (size_t y = 0; y < input.getHeight(); y++) {
+        for (size_t x = 0; x < input.getWidth(); x++) {
+            input.setPixel<Half>({x, y}, float(x) * 0.25f - float(y));
+        }
+    }
+    Image average(4, 2, 16), minimum(4, 2, 16), center(4, 2, 16);
+    average.averageDownsampling<Half>(input);
+    minimum.minDownsampling<Half>(input);
+    center.centerDownsampling<Half>(input);
+    for (size_t y = 0; y < 2; y++) {
+        for (size_t x = 0; x < 4; x++) {
+            EXPECT_EQ(float(average.getPixel<Half>({x, y})), float(2 * x) * 0.25f + 0.125f - float(2 * y) - 0.5f);
+            EXPECT_EQ(float(minimum.getPixel<Half>({x, y})), float(2 * x) * 0.25f - float(2 * y) - 1);
+            EXPECT_EQ(float(center.getPixel<Half>({x, y})), float(input.getPixel<Half>({2 * x + 1, 2 * y + 1})));
+        }
+    }
+}
+
+TEST(ImageTest, KtxExport) {
+    Image half_image(3, 2, 16);
+    for (size_t y = 0; y < half_image.getHeight(); y++) {
+        for (size_t x = 0; x < half_image.getWidth(); x++) {
+            half_image.setPixel<Half>({x, y}, float(x) - float(y) * 0.5f);
+        }
+    }
+    half_image.exportKtx<Half>(test_destination_path + "half.ktx");
+
+    std::ifstream file(test_destination_path + "half.ktx", std::ifstream::binary);
+    std::string ktx((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    auto readUint32 = [&ktx](size_t offset) {
+        uint32_t value;
+        std::memcpy(&value, &ktx[offset], sizeof(value));
+        return value;
+    };
+    ASSERT_EQ(ktx.substr(1, 6), "KTX 11");
+    EXPECT_EQ(readUint32(16), 0x140B);  // GL_HALF_FLOAT
+    EXPECT_EQ(readUint32(28), 0x822D);  // GL_R16F
+    EXPECT_EQ(readUint32(36), 3);
+    EXPECT_EQ(readUint32(40), 2);
+
+    // 3 pixels of 2 bytes per row, padded to 8 bytes
+    size_t imageOffset = 64 + readUint32(60);
+    ASSERT_EQ(readUint32(imageOffset), 16);
+    ASSERT_EQ(ktx.size(), imageOffset + 4 + 16);
+    for (size_t y = 0; y < 2; y++) {
+        for (size_t x = 0; x < 3; x++) {
+            uint16_t bits;
+            std::memcpy(&bits, &ktx[imageOffset + 4 + y * 8 + x * 2], sizeof(bits));
+            EXPECT_EQ(float(Half::fromBits(bits)), float(x) - float(y) * 0.5f);
+        }
+    }
+}
+
+TEST(ImageTest, RowAccess) {
+    Image packed(test_source_path + "A_glyph.png", 1);
+    Image packedView = packed.view({3, 2}, {packed.getWidth() - 5, packed.getHeight()});
+    std::vector<uint8_t> row(packedView.getWidth());
+    for (size_t y = 0; y < packedView.getHeight(); y++) {
+        packedView.unpackRow(y, row.data());
+        for (size_t x = 0; x < packedView.getWidth(); x++) {
+            EXPECT_EQ(packedView.getPixel<uint8_t>({x, y}), row[x]);
+        }
+    }
+
+    Image float_image(16, 8, 32);
+    Image float_view = float_image.view({2, 1}, {12, 7});
+    for (size_t y = 0; y < float_view.getHeight(); y++) {
+        for (size_t x = 0; x < float_view.getWidth(); x++) {
+            float_view.getRowData<float>(y)[x] = float(x * y);
+        }
+    }
+    float* first_row = float_view.getRowData<float>(0);
+    for (size_t y = 0; y < float_view.getHeight(); y++) {
+        for (size_t x = 0; x < float_view.getWidth(); x++) {
+            EXPECT_EQ(float_view.getPixel<float>({x, y}), float(x * y));
+            EXPECT_EQ(first_row[y * float_view.getRowPitch<float>() + x], float(x * y));
+        }
+    }
+}
+
+TEST(ImageTest, TypedView) {
+    Image packed(test_source_path + "A_glyph.png", 1);
+    Image packedView = packed.view({3, 2}, {packed.getWidth() - 5, packed.getHeight()});
+    const ImageView<uint8_t, 1> typedPacked(packedView);
+    ASSERT_EQ(typedPacked.getSize(), packedView.getSize());
+    for (size_t y = 0; y < packedView.getHeight(); y++) {
+        size_t x = 0;
+        for (uint8_t pixel : typedPacked.row(y)) {
+            EXPECT_EQ(pixel, packedView.getPixel<uint8_t>({x, y}));
+            EXPECT_EQ(typedPacked.getPixel({x, y}), pixel);
+            x++;
+        }
+        EXPECT_EQ(x, packedView.getWidth());
+    }
+    for (size_t y = 0; y < packedView.getHeight(); y++) {
+        for (size_t x = 0; x < packedView.getWidth(); x++) {
+            typedPacked.row(y).set(x, (x + y) % 3 == 0);
+        }
+    }
+    for (size_t y = 0; y < packed.getHeight(); y++) {
+        for (size_t x = 0; x < packed.getWidth(); x++) {
+            bool inView = x >= 3 && x < packed.getWidth() - 5 && y >= 2;
+            if (inView) {
+                EXPECT_EQ(packed.getPixel<uint8_t>({x, y}), (x - 3 + y - 2) % 3 == 0);
+            }
+        }
+    }
+
+    Image float_image(16, 8, 32);
+    Image float_view = float_image.view({2, 1}, {12, 7});
+    const ImageView<float> typedFloat(float_view);
+    for (size_t y = 0; y < float_view.getHeight(); y++) {
+        auto row = typedFloat.row(y);
+        ASSERT_EQ(row.size(), float_view.getWidth());
+        for (size_t x = 0; x < row.size(); x++) {
+            row[x] = float(x * y);
+        }
+    }
+    for (size_t y = 0; y < float_view.getHeight(); y++) {
+        for (size_t x = 0; x < float_view.getWidth(); x++) {
+            EXPECT_EQ(float_view.getPixel<float>({x, y}), float(x * y));
+            typedFloat.setPixel({x, y}, -float(x));
+            EXPECT_EQ(float_image.getPixel<float>({x + 2, y + 1}), -float(x));
+        }
+    }
+}
+
+/*
+ * Deterministic pixel values for the blit tests, wrapped to the bit depth by setPixel.
+ */
+template <typename pixelType>
+void fillPattern(Image& image, size_t seed) {
+    for (size_t y = 0; y < image.getHeight(); y++) {
+        for (size_t x = 0; x < image.getWidth(); x++) {
+            image.setPixel<pixelType>({x, y}, static_cast<pixelType>((x * 7 + y * 13 + seed) * 2654435761u >> 7));
+        }
+    }
+}
+
+template <typename pixelType>
+void expectSamePixels(const Image& actual, const Image& expected, const std::string& where) {
+    ASSERT_EQ(actual.getSize(), expected.getSize());
+    for (size_t y = 0; y < actual.getHeight(); y++) {
+        for (size_t x = 0; x < actual.getWidth(); x++) {
+            ASSERT_EQ(actual.getPixel<pixelType>({x, y}), expected.getPixel<pixelType>({x, y}))
+                << where << " at " << x << ", " << y;
+        }
+    }
+}
+
+/*
+ * Copy and fill views at all bit offsets against the pixel by pixel reference, the pixels around the views have to
+ * stay untouched.
+ */
+template <typename pixelType>
+void testBlits(size_t bitDepth) {
+    const size_t width = 150, height = 3;
+    Image source(width, height, bitDepth);
+    fillPattern<pixelType>(source, 1);
+    for (size_t length : {1, 5, 8, 31, 56, 57, 64, 65, 130}) {
+        for (size_t dstX = 0; dstX < 10; dstX++) {
+            for (size_t srcX : {size_t(0), size_t(3), dstX + 8, size_t(width - length)}) {
+                Image actual(width, height, bitDepth), expected(width, height, bitDepth);
+                fillPattern<pixelType>(actual, 2);
+                fillPattern<pixelType>(expected, 2);
+                Image sourceView = source.view({srcX, 0}, {srcX + length, 2});
+                Image expectedView = expected.view({dstX, 1}, {dstX + length, 3});
+                for (size_t y = 0; y < 2; y++) {
+                    for (size_t x = 0; x < length; x++) {
+                        expectedView.setPixel<pixelType>({x, y}, sourceView.getPixel<pixelType>({x, y}));
+                    }
+                }
+                actual.view({dstX, 1}, {dstX + length, 3}).copyDataFrom(sourceView);
+                std::string where = "copy " + std::to_string(length) + " pixels from " + std::to_string(srcX) +
+                                    " to " + std::to_string(dstX) + ", bit depth " + std::to_string(bitDepth);
+                expectSamePixels<pixelType>(actual, expected, where);
+            }
+
+            Image actual(width, height, bitDepth), expected(width, height, bitDepth);
+            fillPattern<pixelType>(actual, 3);
+            fillPattern<pixelType>(expected, 3);
+            auto value = static_cast<pixelType>(length * 3 + dstX);
+            for (size_t y = 1; y < 3; y++) {
+                for (size_t x = dstX + 1; x < dstX + 1 + length; x++) {
+                    expected.setPixel<pixelType>({x, y}, value);
+                }
+            }
+            actual.view({1, 0}, {width, height}).fillRect<pixelType>({dstX, 1}, {dstX + length, 3}, value);
+            std::string where = "fill " + std::to_string(length) + " pixels at " + std::to_string(dstX + 1) +
+                                ", bit depth " + std::to_string(bitDepth);
+            expectSamePixels<pixelType>(actual, expected, where);
+        }
+    }
+}
+
+TEST(ImageTest, BlitPacked) {
+    testBlits<uint8_t>(1);
+    testBlits<uint8_t>(2);
+    testBlits<uint8_t>(4);
+}
+
+TEST(ImageTest, BlitBytes) {
+    testBlits<uint8_t>(8);
+    testBlits<uint16_t>(16);
+    testBlits<float>(32);
+}
+
+TEST(ImageTest, LoadMonoBitmapAtOffset) {
+    const unsigned int width = 77, rows = 4, pitch = 12;
+    std::vector<uint8_t> buffer(pitch * rows);
+    for (size_t i = 0; i < buffer.size(); i++) {
+        buffer[i] = static_cast<uint8_t>(i * 2654435761u >> 11);
+    }
+    FT_Bitmap bitmap = FT_Bitmap();
+    bitmap.width = width;
+    bitmap.rows = rows;
+    bitmap.pitch = pitch;
+    bitmap.buffer = buffer.data();
+    bitmap.pixel_mode = FT_PIXEL_MODE_MONO;
+
+    for (size_t offset = 0; offset < 17; offset++) {
+        Image actual(width + 20, rows + 1, 1), expected(width + 20, rows + 1, 1);
+        fillPattern<uint8_t>(actual, offset);
+        fillPattern<uint8_t>(expected, offset);
+        for (size_t y = 0; y < rows; y++) {
+            for (size_t x = 0; x < width; x++) {
+                expected.setPixel<uint8_t>({offset + x, y + 1}, (buffer[y * pitch + x / 8] >> (7 - x % 8)) & 1);
+            }
+        }
+        actual.view({offset, 1}, {offset + width, rows + 1}).load(bitmap);
+        expectSamePixels<uint8_t>(actual, expected, "load at " + std::to_string(offset));
+    }
+}
+
+/*
+ * Downsample with the given row kernels, like Image::simdAverageDownsampling and Image::simdMinDownsampling do with
+ * the kernels chosen for the CPU.
+ */
+void downsampleRows(const Image& dst, const Image& src, internal::DownsampleRowKernel kernel) {
+    size_t xScale = src.getWidth() / dst.getWidth(), yScale = src.getHeight() / dst.getHeight();
+    std::vector<float> accumulator(src.getWidth());
+    for (size_t y = 0; y < dst.getHeight(); y++) {
+        kernel(dst.getRowData<float>(y), dst.getWidth(), src.getRowData<float>(y * yScale), src.getRowPitch<float>(),
+               xScale, yScale, accumulator.data());
+    }
+}
+
+TEST(ImageTest, SimdDownsampling) {
+    struct Kernels {
+        std::string name;
+        std::function<void(const Image&, const Image&)> average, minimum;
+    };
+    auto rowKernels = [](const std::string& name, internal::DownsampleRowKernel average,
+                         internal::DownsampleRowKernel minimum) {
+        using namespace std::placeholders;
+        return Kernels{name, std::bind(downsampleRows, _1, _2, average), std::bind(downsampleRows, _1, _2, minimum)};
+    };
+    std::vector<Kernels> kernels{
+        {"selected", [](const Image& dst, const Image& src) { dst.simdAverageDownsampling(src); },
+         [](const Image& dst, const Image& src) { dst.simdMinDownsampling(src); }},
+        rowKernels("scalar", internal::downsampleRow<internal::ScalarLanes, false>,
+                   internal::downsampleRow<internal::ScalarLanes, true>)};
+#ifdef LLASSETGEN_X86
+    if (internal::cpuFeatures().sse2) {
+        kernels.push_back(rowKernels("sse2", internal::averageDownsampleRowSse2, internal::minDownsampleRowSse2));
+    }
+    if (internal::cpuFeatures().avx2) {
+        kernels.push_back(rowKernels("avx2", internal::averageDownsampleRowAvx2, internal::minDownsampleRowAvx2));
+    }
+#endif
+
+    Image input(120, 72, 32);
+    for (size_t y = 0; y < input.getHeight(); y++) {
+        for (size_t x = 0; x < input.getWidth(); x++) {
+            float value = std::sin(float(x) * 0.37f) * 20 - std::cos(float(y) * 0.11f) * 7;
+            input.setPixel<float>({x, y}, x % 17 == 3 ? std::numeric_limits<float>::infinity() : value);
+        }
+    }
+    for (size_t xScale : {1, 2, 3, 5, 8}) {
+        for (size_t yScale : {1, 4, 6}) {
+            // odd output widths and a view, so that the rows have a pitch and do not fill whole vectors
+            Image source = input.view({4, 0}, {4 + 13 * xScale, 72 - 72 % yScale});
+            Vec2<size_t> size{source.getWidth() / xScale, source.getHeight() / yScale};
+            Image average(size.x, size.y, 32), minimum(size.x, size.y, 32);
+            average.averageDownsampling<float>(source);
+            minimum.minDownsampling<float>(source);
+            for (const auto& kernel : kernels) {
+                Image simdAverage(size.x, size.y, 32), simdMinimum(size.x, size.y, 32);
+                kernel.average(simdAverage, source);
+                kernel.minimum(simdMinimum, source);
+                for (size_t y = 0; y < size.y; y++) {
+                    for (size_t x = 0; x < size.x; x++) {
+                        float expected = average.getPixel<float>({x, y});
+                        if (std::isinf(expected)) {
+                            EXPECT_EQ(simdAverage.getPixel<float>({x, y}), expected) << kernel.name;
+                        } else {
+                            EXPECT_NEAR(simdAverage.getPixel<float>({x, y}), expected, 1e-4f) << kernel.name;
+                        }
+                        EXPECT_EQ(simdMinimum.getPixel<float>({x, y}), minimum.getPixel<float>({x, y}))
+                            << kernel.name;
+                    }
+                }
+            }
+        }
+    }
+}
+
 class DistanceTransformTest : public testing::Test {};
 
 TEST_F(DistanceTransformTest, DeadReckoning) {
@@ -128,6 +544,112 @@ TEST_F(DistanceTransformTest, ParabolaEnvelope) {
     EXPECT_EQ(1, 1);
 }
 
+TEST_F(DistanceTransformTest, SimdParabolaEnvelope) {
+    Image input(test_source_path + "Helvetica.png", 1),
+        expected(input.getWidth(), input.getHeight(), DistanceTransform::bitDepth),
+        output(input.getWidth(), input.getHeight(), DistanceTransform::bitDepth);
+    ParabolaEnvelope(input, expected).transform();
+    SimdParabolaEnvelope(input, output).transform();
+    for (size_t y = 0; y < output.getHeight(); y++) {
+        EXPECT_EQ(0, std::memcmp(expected.getRowData<float>(y), output.getRowData<float>(y),
+                                 output.getWidth() * sizeof(float)));
+    }
+}
+
+TEST_F(DistanceTransformTest, ParabolaEnvelopeDownsampling) {
+    Image input(test_source_path + "Helvetica.png", 1);
+    for (size_t ratio : {2, 3, 4}) {
+        Image view = input.view({0, 0}, {input.getWidth() / ratio * ratio, input.getHeight() / ratio * ratio});
+        Image full(view.getWidth(), view.getHeight(), DistanceTransform::bitDepth),
+            expected(view.getWidth() / ratio, view.getHeight() / ratio, DistanceTransform::bitDepth),
+            output(view.getWidth() / ratio, view.getHeight() / ratio, DistanceTransform::bitDepth);
+        ParabolaEnvelope(view, full).transform();
+        expected.centerDownsampling<float>(full);
+        ParabolaEnvelope(view, output).transform();
+        for (size_t y = 0; y < output.getHeight(); y++) {
+            EXPECT_EQ(0, std::memcmp(expected.getRowData<float>(y), output.getRowData<float>(y),
+                                     output.getWidth() * sizeof(float)));
+        }
+    }
+}
+
+TEST_F(DistanceTransformTest, ParabolaEnvelopeBandLimit) {
+    Image input(test_source_path + "Helvetica.png", 1),
+        expected(input.getWidth(), input.getHeight(), DistanceTransform::bitDepth),
+        output(input.getWidth(), input.getHeight(), DistanceTransform::bitDepth);
+    ParabolaEnvelope(input, expected).transform();
+    for (float limit : {1.5F, 8.0F, 30.0F}) {
+        ParabolaEnvelope transform(input, output);
+        transform.setBandLimit(limit);
+        transform.transform();
+        for (size_t y = 0; y < output.getHeight(); y++) {
+            for (size_t x = 0; x < output.getWidth(); x++) {
+                float exact = expected.getPixel<float>({x, y}), value = output.getPixel<float>({x, y});
+                if (std::abs(exact) < limit) {
+                    ASSERT_EQ(exact, value);
+                } else {
+                    ASSERT_GE(std::abs(value), limit);
+                    ASSERT_EQ(std::signbit(exact), std::signbit(value));
+                }
+            }
+        }
+    }
+}
+
+TEST_F(DistanceTransformTest, AntiAliasedEuclidean) {
+    // disc with anti-aliased edges, the coverage of each pixel is estimated with 16x16 samples
+    const size_t size = 64, samples = 16;
+    const float center = 32.3F, radius = 17.6F;
+    Image input(size, size, 8), output(size, size, DistanceTransform::bitDepth);
+    for (size_t y = 0; y < size; y++) {
+        for (size_t x = 0; x < size; x++) {
+            size_t covered = 0;
+            for (size_t j = 0; j < samples; j++) {
+                for (size_t i = 0; i < samples; i++) {
+                    float dx = x + (i + 0.5F) / samples - 0.5F - center, dy = y + (j + 0.5F) / samples - 0.5F - center;
+                    covered += dx * dx + dy * dy < radius * radius;
+                }
+            }
+            input.setPixel<uint8_t>({x, y}, static_cast<uint8_t>(covered * 255 / (samples * samples)));
+        }
+    }
+
+    AntiAliasedEuclidean(input, output).transform();
+    for (size_t y = 0; y < size; y++) {
+        for (size_t x = 0; x < size; x++) {
+            float exact = std::hypot(x - center, y - center) - radius;
+            if (std::abs(exact) < 8) {
+                EXPECT_NEAR(exact, output.getPixel<float>({x, y}), 0.2F);
+            }
+        }
+    }
+}
+
+TEST_F(DistanceTransformTest, WorkspaceReuse) {
+    DistanceTransformWorkspace workspace;
+    Image large = workspace.distanceField(64, 32);
+    EXPECT_EQ(large.getWidth(), 64);
+    EXPECT_EQ(large.getHeight(), 32);
+    Image small = workspace.distanceField(16, 16);
+    EXPECT_EQ(small.getWidth(), 16);
+    EXPECT_EQ(small.getRowData<float>(0), large.getRowData<float>(0));
+
+    float* buffer = workspace.get<float>(DistanceTransformWorkspace::LineBuffer, 100);
+    EXPECT_EQ(workspace.get<float>(DistanceTransformWorkspace::LineBuffer, 50), buffer);
+
+    Image input(test_source_path + "Helvetica.png", 1),
+        expected(input.getWidth(), input.getHeight(), DistanceTransform::bitDepth);
+    ParabolaEnvelope(input, expected).transform();
+    for (int run = 0; run < 2; run++) {
+        Image output = DistanceTransformWorkspace::local().distanceField(input.getWidth(), input.getHeight());
+        ParabolaEnvelope(input, output).transform();
+        for (size_t y = 0; y < output.getHeight(); y++) {
+            EXPECT_EQ(0, std::memcmp(expected.getRowData<float>(y), output.getRowData<float>(y),
+                                     output.getWidth() * sizeof(float)));
+        }
+    }
+}
+
 TEST_F(DistanceTransformTest, Compare) {
     Image deadReckoningResult(test_destination_path + "DeadReckoning.png", 16),
           parabolaEnvelopeResult(test_destination_path + "ParabolaEnvelope.png", 16);
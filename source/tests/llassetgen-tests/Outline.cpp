@@ -0,0 +1,207 @@
+#include <gmock/gmock.h>
+#include <llassetgen/llassetgen.h>
+
+#include <bitset>
+#include <cmath>
+
+using namespace llassetgen;
+
+extern std::string test_source_path;
+
+/*
+ * Distance to a segment by sampling it densely.
+ */
+double sampledDistance(const Outline::Segment& segment, Vec2<double> p) {
+    const int samples = 100000;
+    double distance = std::numeric_limits<double>::infinity();
+    for (int i = 0; i <= samples; i++) {
+        Vec2<double> d = segment.point(double(i) / samples) - p;
+        distance = std::min(distance, std::sqrt(d.x * d.x + d.y * d.y));
+    }
+    return distance;
+}
+
+TEST(OutlineTest, SegmentDistance) {
+    Outline outline;
+    outline.moveTo({0, 0});
+    outline.lineTo({10, 2});
+    outline.conicTo({14, 12}, {4, 9});
+    outline.cubicTo({-3, 20}, {-6, -4}, {3, 3});
+    outline.cubicTo({5, 5}, {-5, 5}, {0, 0});
+    ASSERT_EQ(outline.contours.size(), 1);
+
+    for (const auto& segment : outline.contours[0]) {
+        for (double y = -6; y <= 14; y += 1.7) {
+            for (double x = -8; x <= 16; x += 1.3) {
+                EXPECT_NEAR(segment.distance({x, y}), sampledDistance(segment, {x, y}), 1e-3);
+            }
+        }
+    }
+}
+
+TEST(OutlineTest, SquareDistanceField) {
+    // a 4x4 square with a 2x2 hole, the hole has the opposite orientation
+    Outline outline;
+    outline.moveTo({2, 2});
+    outline.lineTo({6, 2});
+    outline.lineTo({6, 6});
+    outline.lineTo({2, 6});
+    outline.lineTo({2, 2});
+    outline.moveTo({3, 3});
+    outline.lineTo({3, 5});
+    outline.lineTo({5, 5});
+    outline.lineTo({5, 3});
+    outline.lineTo({3, 3});
+
+    Image output(8, 8, DistanceTransform::bitDepth);
+    OutlineDistanceField(outline).render(output, {0, 8});
+    for (size_t y = 0; y < 8; y++) {
+        for (size_t x = 0; x < 8; x++) {
+            double px = x + 0.5, py = 8 - (y + 0.5);
+            double outside = std::hypot(std::max({2 - px, px - 6, 0.}), std::max({2 - py, py - 6, 0.}));
+            double edge = std::min({std::abs(px - 2), std::abs(px - 6), std::abs(py - 2), std::abs(py - 6),
+                                    std::abs(px - 3), std::abs(px - 5), std::abs(py - 3), std::abs(py - 5)});
+            bool inSquare = px > 2 && px < 6 && py > 2 && py < 6;
+            bool inHole = px > 3 && px < 5 && py > 3 && py < 5;
+            float expected = inSquare && !inHole ? float(-edge) : float(inHole ? edge : outside);
+            EXPECT_FLOAT_EQ(output.getPixel<DistanceTransform::OutputType>({x, y}), expected) << x << ", " << y;
+        }
+    }
+}
+
+TEST(OutlineTest, BandLimit) {
+    Outline outline;
+    outline.moveTo({10, 10});
+    outline.conicTo({30, 50}, {50, 10});
+    outline.lineTo({10, 10});
+
+    const DistanceTransform::OutputType band = 4;
+    Image exact(64, 64, DistanceTransform::bitDepth), banded(64, 64, DistanceTransform::bitDepth);
+    OutlineDistanceField(outline).render(exact, {0, 64});
+    OutlineDistanceField(outline, band).render(banded, {0, 64});
+    for (size_t y = 0; y < 64; y++) {
+        for (size_t x = 0; x < 64; x++) {
+            auto value = exact.getPixel<DistanceTransform::OutputType>({x, y});
+            auto expected = std::max(-band, std::min(band, value));
+            EXPECT_FLOAT_EQ(banded.getPixel<DistanceTransform::OutputType>({x, y}), expected);
+        }
+    }
+}
+
+TEST(OutlineTest, MatchesRenderedGlyphs) {
+    init();
+    FontFinder fontFinder = FontFinder::fromPath(test_source_path + "SourceSansPro-Regular.ttf");
+    std::set<unsigned long> glyphs{' ', '@', 'A', 'g', 'J', 'Q', 'x', '%'};
+    const size_t padding = 3, divisibleBy = 4;
+
+    std::vector<GlyphOutline> outlines = fontFinder.loadOutlines(glyphs, 64, padding, divisibleBy);
+    std::vector<Image> images = fontFinder.renderGlyphs(glyphs, 64, padding, divisibleBy);
+    ASSERT_EQ(outlines.size(), images.size());
+
+    for (size_t i = 0; i < outlines.size(); i++) {
+        ASSERT_EQ(outlines[i].getSize(), images[i].getSize());
+
+        // the rasterizer and the analytic inside test may only disagree right at the edges
+        Image field(images[i].getWidth(), images[i].getHeight(), DistanceTransform::bitDepth);
+        OutlineDistanceField(outlines[i].outline, 8).render(field, outlines[i].origin);
+        for (size_t y = 0; y < field.getHeight(); y++) {
+            for (size_t x = 0; x < field.getWidth(); x++) {
+                auto distance = field.getPixel<DistanceTransform::OutputType>({x, y});
+                bool inside = images[i].getPixel<uint8_t>({x, y}) != 0;
+                if (std::abs(distance) > 0.75f) {
+                    EXPECT_EQ(distance < 0, inside) << "glyph " << i << " at " << x << ", " << y;
+                }
+            }
+        }
+    }
+}
+
+TEST(OutlineTest, ColorEdges) {
+    Outline outline;
+    // square, four corners
+    outline.moveTo({0, 0});
+    outline.lineTo({4, 0});
+    outline.lineTo({4, 4});
+    outline.lineTo({0, 4});
+    outline.lineTo({0, 0});
+    // circle made of smooth cubics, no corner
+    const double k = 0.5522847498;
+    outline.moveTo({10, 5});
+    outline.cubicTo({10, 5 + k}, {9 + k, 6}, {9, 6});
+    outline.cubicTo({9 - k, 6}, {8, 5 + k}, {8, 5});
+    outline.cubicTo({8, 5 - k}, {9 - k, 4}, {9, 4});
+    outline.cubicTo({9 + k, 4}, {10, 5 - k}, {10, 5});
+    // teardrop, a single curve with one corner
+    outline.moveTo({20, 0});
+    outline.cubicTo({30, 10}, {10, 10}, {20, 0});
+    outline.colorEdges();
+
+    ASSERT_EQ(outline.contours.size(), 3);
+    for (const auto& contour : {outline.contours[0], outline.contours[2]}) {
+        ASSERT_GE(contour.size(), 3);
+        for (size_t i = 0; i < contour.size(); i++) {
+            uint8_t previous = contour[(i + contour.size() - 1) % contour.size()].channels;
+            uint8_t current = contour[i].channels;
+            // at least two channels on each segment, and any two neighbours share at least one
+            EXPECT_GE(std::bitset<3>(current).count(), 2);
+            EXPECT_NE(previous & current, 0);
+        }
+    }
+    // the segments at the corners share a single channel
+    for (size_t i = 0; i < 4; i++) {
+        uint8_t shared = outline.contours[0][i].channels & outline.contours[0][(i + 1) % 4].channels;
+        EXPECT_EQ(std::bitset<3>(shared).count(), 1);
+    }
+    EXPECT_EQ(std::bitset<3>(outline.contours[2].front().channels & outline.contours[2].back().channels).count(), 1);
+    for (const auto& segment : outline.contours[1]) {
+        EXPECT_EQ(segment.channels, Outline::Segment::White);
+    }
+}
+
+/*
+ * Bilinear interpolation between the pixel centers, like a texture lookup.
+ */
+float interpolate(const Image& image, double x, double y) {
+    auto x0 = static_cast<size_t>(std::floor(x)), y0 = static_cast<size_t>(std::floor(y));
+    double fx = x - x0, fy = y - y0;
+    auto pixel = [&](size_t px, size_t py) { return image.getPixel<DistanceTransform::OutputType>({px, py}); };
+    return static_cast<float>((pixel(x0, y0) * (1 - fx) + pixel(x0 + 1, y0) * fx) * (1 - fy) +
+                              (pixel(x0, y0 + 1) * (1 - fx) + pixel(x0 + 1, y0 + 1) * fx) * fy);
+}
+
+TEST(OutlineTest, MultiChannelDistanceField) {
+    Outline outline;
+    outline.moveTo({2, 2});
+    outline.lineTo({10, 2});
+    outline.lineTo({10, 10});
+    outline.lineTo({2, 10});
+    outline.lineTo({2, 2});
+
+    std::vector<Image> channels;
+    for (int c = 0; c < 4; c++) {
+        channels.push_back(Image(12, 12, DistanceTransform::bitDepth));
+    }
+    MultiChannelDistanceField(outline, 4).render(channels[0], channels[1], channels[2], channels[3], {0, 12});
+
+    for (size_t y = 0; y < 12; y++) {
+        for (size_t x = 0; x < 12; x++) {
+            float values[3];
+            for (int c = 0; c < 3; c++) {
+                values[c] = channels[c].getPixel<DistanceTransform::OutputType>({x, y});
+                EXPECT_LE(std::abs(values[c]), 4);
+            }
+            float median =
+                std::max(std::min(values[0], values[1]), std::min(std::max(values[0], values[1]), values[2]));
+            float trueDistance = channels[3].getPixel<DistanceTransform::OutputType>({x, y});
+            EXPECT_EQ(median < 0, trueDistance < 0);
+        }
+    }
+
+    // just inside the corner at (10, 10): the interpolated true distance field rounds the corner off, the median of
+    // the interpolated channels keeps it
+    double x = 9.85 - 0.5, y = 12 - 9.85 - 0.5;
+    EXPECT_GT(interpolate(channels[3], x, y), 0);
+    float red = interpolate(channels[0], x, y), green = interpolate(channels[1], x, y),
+          blue = interpolate(channels[2], x, y);
+    EXPECT_LT(std::max(std::min(red, green), std::min(std::max(red, green), blue)), 0);
+}
@@ -1,6 +1,7 @@
 #include <gmock/gmock.h>
 
 #include <numeric>
+#include <random>
 
 #include <llassetgen/llassetgen.h>
 
@@ -18,6 +19,7 @@ class PackingTest : public testing::Test {
    protected:
     virtual Packing run(const std::vector<Vec>& rectSizes, bool allowRotations, Vec atlasSize) = 0;
     virtual Packing run(const std::vector<Vec>& rectSizes, bool allowRotations) = 0;
+    virtual Packing runPages(const std::vector<Vec>& rectSizes, bool allowRotations, Vec maxPageSize) = 0;
 
     static bool rotatedSizesEquals(Vec size1, Vec size2) { return size1 == size2 || size1 == Vec{size2.y, size2.x}; }
 
@@ -42,6 +44,11 @@ class PackingTest : public testing::Test {
      */
     void validatePacking(const Packing& packing, const std::vector<Vec>& rectSizes, bool allowRotations);
 
+    /**
+     * Expect a multi-page packing to be valid on each page and return it.
+     */
+    Packing expectValidPages(const std::vector<Vec>& rectSizes, bool allowRotations, Vec maxPageSize);
+
     void expectPackingFailure(const std::vector<Vec>& rectSizes, bool allowRotations, Vec atlasSize) {
         std::vector<Rect> emptyVec{};
         EXPECT_EQ(emptyVec, run(rectSizes, allowRotations, atlasSize).rects);
@@ -100,8 +107,55 @@ class PackingTest : public testing::Test {
         expectValidPacking(rectSizesRotated, false);
         expectValidPacking(rectSizesRotated, true);
     }
+
+    void testSinglePage() {
+        Packing packing = expectValidPages({{1, 2}, {3, 4}, {5, 6}}, false, {16, 16});
+        EXPECT_TRUE(packing.pages.empty());
+        EXPECT_EQ(1u, packing.pageCount());
+        EXPECT_GE(16u, packing.atlasSize.x);
+        EXPECT_GE(16u, packing.atlasSize.y);
+    }
+
+    void testMultiplePages() {
+        // at most four of these fit onto a page
+        std::vector<Vec> rectSizes(10, Vec{4, 4});
+        for (bool allowRotations : {false, true}) {
+            Packing packing = expectValidPages(rectSizes, allowRotations, {8, 8});
+            EXPECT_EQ((Vec{8, 8}), packing.atlasSize);
+            EXPECT_EQ(rectSizes.size(), packing.pages.size());
+            EXPECT_EQ(3u, packing.pageCount());
+        }
+
+        // the large rectangles go first, the small ones fill the gaps
+        rectSizes = {{1, 1}, {6, 6}, {6, 6}, {2, 2}};
+        Packing packing = expectValidPages(rectSizes, false, {8, 8});
+        EXPECT_EQ(2u, packing.pageCount());
+    }
+
+    void testRejectTooLargeForPage() {
+        std::vector<Rect> emptyVec{};
+        EXPECT_EQ(emptyVec, runPages({{1, 1}, {9, 1}}, false, {8, 8}).rects);
+        EXPECT_EQ(emptyVec, runPages({{1, 1}, {9, 1}}, true, {8, 8}).rects);
+    }
 };
 
+Packing PackingTest::expectValidPages(const std::vector<Vec>& rectSizes, bool allowRotations, Vec maxPageSize) {
+    Packing packing = runPages(rectSizes, allowRotations, maxPageSize);
+    EXPECT_EQ(rectSizes.size(), packing.rects.size());
+    EXPECT_TRUE(packing.pages.empty() || packing.pages.size() == packing.rects.size());
+
+    for (size_t page = 0; page < packing.pageCount(); page++) {
+        std::vector<size_t> indices = packing.rectsOnPage(page);
+        EXPECT_FALSE(indices.empty());
+        std::vector<Vec> pageSizes;
+        for (size_t i : indices) {
+            pageSizes.push_back(rectSizes[i]);
+        }
+        validatePacking(packing.page(page), pageSizes, allowRotations);
+    }
+    return packing;
+}
+
 Packing PackingTest::expectSuccessfulValidPacking(const std::vector<Vec>& rectSizes, Vec atlasSize,
                                                   bool allowRotations) {
     Packing packing = run(rectSizes, allowRotations, atlasSize);
@@ -140,6 +194,105 @@ class ShelfNextFitPackingTest : public PackingTest {
     Packing run(const std::vector<Vec>& rectSizes, bool allowRotations) override {
         return llassetgen::shelfPackAtlas(rectSizes.begin(), rectSizes.end(), allowRotations);
     }
+
+    Packing runPages(const std::vector<Vec>& rectSizes, bool allowRotations, Vec maxPageSize) override {
+        return llassetgen::shelfPackAtlasPages(rectSizes.begin(), rectSizes.end(), maxPageSize, allowRotations);
+    }
+};
+
+class SkylinePackingTest : public PackingTest {
+    Packing run(const std::vector<Vec>& rectSizes, bool allowRotations, Vec atlasSize) override {
+        return llassetgen::skylinePackAtlas(rectSizes.begin(), rectSizes.end(), atlasSize, allowRotations);
+    }
+
+    Packing run(const std::vector<Vec>& rectSizes, bool allowRotations) override {
+        return llassetgen::skylinePackAtlas(rectSizes.begin(), rectSizes.end(), allowRotations);
+    }
+
+    Packing runPages(const std::vector<Vec>& rectSizes, bool allowRotations, Vec maxPageSize) override {
+        return llassetgen::skylinePackAtlasPages(rectSizes.begin(), rectSizes.end(), maxPageSize, allowRotations);
+    }
+
+   public:
+    void testFillSteps() {
+        // The highest rectangle leaves a step in the skyline, which the two
+        // next ones fill. The merged segment then carries the last one.
+        Packing packing = expectSuccessfulValidPacking({{8, 2}, {4, 6}, {4, 3}, {4, 3}}, {8, 8}, false);
+        EXPECT_EQ((Rect{{0, 0}, {4, 6}}), packing.rects[1]);
+        EXPECT_EQ((Rect{{4, 0}, {4, 3}}), packing.rects[2]);
+        EXPECT_EQ((Rect{{4, 3}, {4, 3}}), packing.rects[3]);
+        EXPECT_EQ((Rect{{0, 6}, {8, 2}}), packing.rects[0]);
+        expectPackingFailure({{8, 2}, {4, 6}, {4, 3}, {4, 3}, {1, 1}}, false, {8, 8});
+    }
+};
+
+class GuillotinePackingTest : public PackingTest {
+   protected:
+    Packing run(const std::vector<Vec>& rectSizes, bool allowRotations, Vec atlasSize) override {
+        return llassetgen::guillotinePackAtlas(rectSizes.begin(), rectSizes.end(), atlasSize, allowRotations,
+                                               heuristics);
+    }
+
+    Packing run(const std::vector<Vec>& rectSizes, bool allowRotations) override {
+        return llassetgen::guillotinePackAtlas(rectSizes.begin(), rectSizes.end(), allowRotations, heuristics);
+    }
+
+    Packing runPages(const std::vector<Vec>& rectSizes, bool allowRotations, Vec maxPageSize) override {
+        return llassetgen::guillotinePackAtlasPages(rectSizes.begin(), rectSizes.end(), maxPageSize, allowRotations,
+                                                    heuristics);
+    }
+
+    llassetgen::GuillotineHeuristics heuristics;
+
+   public:
+    void testAllHeuristics() {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<llassetgen::PackingSizeType> side(1, 32);
+        std::vector<Vec> rectSizes(300);
+        for (auto& size : rectSizes) {
+            size = {side(generator), side(generator)};
+        }
+
+        using Heuristics = llassetgen::GuillotineHeuristics;
+        for (auto choice : {Heuristics::BestAreaFit, Heuristics::BestShortSideFit}) {
+            for (auto split : {Heuristics::ShorterLeftoverAxis, Heuristics::LongerLeftoverAxis, Heuristics::MinArea,
+                               Heuristics::MaxArea, Heuristics::ShorterAxis, Heuristics::LongerAxis}) {
+                for (bool merge : {false, true}) {
+                    heuristics.choice = choice;
+                    heuristics.split = split;
+                    heuristics.merge = merge;
+                    expectValidPacking(rectSizes, false);
+                    expectValidPacking(rectSizes, true);
+                }
+            }
+        }
+    }
+
+    void testMergeFreeRects() {
+        // Test case forces the following to happen:
+        //  - The first rectangle leaves a free 1x1 rectangle below it and a
+        //    free 2x3 one right of it (cut vertically)
+        //  - The second rectangle leaves a free 2x1 rectangle below it
+        //  - Only merged with the 1x1 one, it fits the last rectangle
+        //
+        // To avoid reordering of the rectangles, this test uses the internal
+        // packing class directly.
+        for (bool merge : {false, true}) {
+            heuristics.split = llassetgen::GuillotineHeuristics::LongerAxis;
+            heuristics.merge = merge;
+            llassetgen::internal::GuillotinePacker packer{{3, 3}, false, false, heuristics};
+            for (Vec size : {Vec{1, 2}, Vec{2, 2}}) {
+                Rect r{{0, 0}, size};
+                EXPECT_TRUE(packer.pack(r));
+            }
+
+            Rect r{{0, 0}, {3, 1}};
+            EXPECT_EQ(merge, packer.pack(r));
+            if (merge) {
+                EXPECT_EQ((Rect{{0, 2}, {3, 1}}), r);
+            }
+        }
+    }
 };
 
 class MaxRectsPackingTest : public PackingTest {
@@ -152,6 +305,10 @@ class MaxRectsPackingTest : public PackingTest {
         return llassetgen::maxRectsPackAtlas(rectSizes.begin(), rectSizes.end(), allowRotations);
     }
 
+    Packing runPages(const std::vector<Vec>& rectSizes, bool allowRotations, Vec maxPageSize) override {
+        return llassetgen::maxRectsPackAtlasPages(rectSizes.begin(), rectSizes.end(), maxPageSize, allowRotations);
+    }
+
    public:
     void testNoFreeRect() {
         // No free rect available when packing the second rect.
@@ -170,6 +327,18 @@ class MaxRectsPackingTest : public PackingTest {
         }
     }
 
+    void testManyRects() {
+        // enough free rectangles to split, prune and grow the atlas many times
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<llassetgen::PackingSizeType> side(1, 48);
+        std::vector<Vec> rectSizes(1000);
+        for (auto& size : rectSizes) {
+            size = {side(generator), side(generator)};
+        }
+        expectValidPacking(rectSizes, false);
+        expectSuccessfulValidPacking(rectSizes, {1024, 1024}, false);
+    }
+
     void testFreeRectPruning() {
         // Test case forces the following to happen:
         //  - Rectangle placed top-left, creating two free rectangles which
@@ -198,6 +367,125 @@ class MaxRectsPackingTest : public PackingTest {
         test({{4, 3}, {4, 3}, {8, 5}}, {4, 5});
         test({{3, 4}, {3, 4}, {5, 8}}, {5, 4});
     }
+
+    void testCropAllFreeRects() {
+        // Placing 1x4 removes the free rect it equals and must still crop the
+        // 1x1 free rect it contains.
+        expectValidPacking({{3, 2}, {1, 3}, {4, 3}, {3, 2}, {1, 4}}, false);
+        // Placing 1x6 removes the free rect it equals after a crop, the free
+        // rect taking its place must still be cropped.
+        expectValidPacking({{2, 2}, {1, 3}, {3, 5}, {1, 2}, {1, 6}}, false);
+
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<llassetgen::PackingSizeType> side(1, 40);
+        std::vector<Vec> rectSizes(700);
+        for (auto& size : rectSizes) {
+            size = {side(generator), side(generator)};
+        }
+        expectValidPages(rectSizes, false, {256, 256});
+        expectValidPages(rectSizes, true, {256, 256});
+    }
+
+    void testScoreWrapTie() {
+        // After placing 2x3, the free rect 3x4 is 1 larger than 1x3 on both
+        // sides. Its score wraps to the one of a free rect that does not fit,
+        // so the first free rect (2x1, too small) is chosen and the atlas grows.
+        Packing packing = expectValidPacking({{2, 3}, {1, 3}}, false);
+        EXPECT_EQ((Vec{8, 4}), packing.atlasSize);
+        expectPackingFailure({{2, 3}, {1, 3}}, false, {4, 4});
+    }
+
+    void testZeroArea() {
+        for (bool allowRotations : {false, true}) {
+            Packing packing = expectValidPacking({{4, 0}}, allowRotations);
+            EXPECT_EQ((Vec{4, 1}), packing.atlasSize);
+            packing = expectValidPacking({{0, 4}}, allowRotations);
+            EXPECT_EQ((Vec{1, 4}), packing.atlasSize);
+            packing = expectValidPacking({{0, 0}}, allowRotations);
+            EXPECT_EQ((Vec{1, 1}), packing.atlasSize);
+            expectValidPacking({{1, 2}, {4, 0}, {0, 5}, {3, 3}}, allowRotations);
+        }
+    }
+};
+
+class AutoPackingTest : public PackingTest {
+   protected:
+    // there is no fixed size auto packing, only the variable size and multi-page tests apply
+    Packing run(const std::vector<Vec>& /*unused*/, bool /*unused*/, Vec /*unused*/) override { return {}; }
+
+    Packing run(const std::vector<Vec>& rectSizes, bool allowRotations) override {
+        return llassetgen::autoPackAtlas(rectSizes.begin(), rectSizes.end(), allowRotations);
+    }
+
+    Packing runPages(const std::vector<Vec>& rectSizes, bool allowRotations, Vec maxPageSize) override {
+        return llassetgen::autoPackAtlasPages(rectSizes.begin(), rectSizes.end(), maxPageSize, allowRotations);
+    }
+
+   public:
+    void testSmallestOfAllStrategies() {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<llassetgen::PackingSizeType> side(1, 48);
+        std::vector<Vec> rectSizes(300);
+        for (auto& size : rectSizes) {
+            size = {side(generator), side(generator)};
+        }
+
+        for (bool allowRotations : {false, true}) {
+            Packing packing = expectValidPacking(rectSizes, allowRotations);
+            EXPECT_FALSE(packing.strategy.empty());
+            for (const auto& strategy : llassetgen::internal::packingStrategies()) {
+                Packing other = strategy.pack(rectSizes, allowRotations, nullptr);
+                EXPECT_FALSE(llassetgen::internal::smallerPacking(other, packing, rectSizes.size())) << strategy.name;
+            }
+        }
+    }
+
+    void testSmallerPacking() {
+        auto packing = [](Vec atlasSize, size_t rectCount) {
+            Packing result;
+            result.atlasSize = atlasSize;
+            result.rects.resize(rectCount);
+            return result;
+        };
+        using llassetgen::internal::smallerPacking;
+        EXPECT_TRUE(smallerPacking(packing({8, 8}, 1), packing({16, 8}, 1), 1));
+        // same area, the square one wins
+        EXPECT_TRUE(smallerPacking(packing({8, 8}, 1), packing({16, 4}, 1), 1));
+        EXPECT_FALSE(smallerPacking(packing({16, 4}, 1), packing({8, 8}, 1), 1));
+        // failed packings never win
+        EXPECT_TRUE(smallerPacking(packing({16, 16}, 1), packing({8, 8}, 0), 1));
+        EXPECT_FALSE(smallerPacking(packing({8, 8}, 0), packing({16, 16}, 1), 1));
+        // all pages count
+        Packing twoPages = packing({8, 8}, 2);
+        twoPages.pages = {0, 1};
+        EXPECT_TRUE(smallerPacking(packing({16, 4}, 2), twoPages, 2));
+        // same pages, the one using less of the last page wins
+        Packing tight = packing({8, 8}, 2);
+        tight.rects[0] = {{0, 0}, {4, 4}};
+        tight.rects[1] = {{4, 0}, {4, 4}};
+        Packing loose = packing({8, 8}, 2);
+        loose.rects[0] = {{0, 0}, {4, 4}};
+        loose.rects[1] = {{4, 4}, {4, 4}};
+        EXPECT_TRUE(smallerPacking(tight, loose, 2));
+        EXPECT_FALSE(smallerPacking(loose, tight, 2));
+    }
+
+    void testValidPacking() {
+        using llassetgen::internal::validPacking;
+        Packing packing;
+        packing.atlasSize = {8, 8};
+        packing.rects = {{{0, 0}, {4, 4}}, {{4, 0}, {4, 8}}, {{0, 4}, {4, 4}}};
+        EXPECT_TRUE(validPacking(packing));
+        // overlapping in the last column and row of the first rectangle
+        packing.rects[2].position = {3, 3};
+        EXPECT_FALSE(validPacking(packing));
+        // on another page, they do not overlap
+        packing.pages = {0, 0, 1};
+        EXPECT_TRUE(validPacking(packing));
+        // outside of the atlas
+        packing.rects[2].position = {5, 5};
+        EXPECT_FALSE(validPacking(packing));
+    }
 };
 
 #define ADD_TESTS_FOR_FIXTURE(Fixture)                                              \
@@ -208,15 +496,35 @@ class MaxRectsPackingTest : public PackingTest {
     TEST_F(Fixture, TestAcceptMultipleTiny) { testAcceptMultipleTiny(); }           \
     TEST_F(Fixture, TestVariableSizePacking) { testVariableSizePacking(); }         \
     TEST_F(Fixture, TestNonSquareSizePrediction) { testNonSquareSizePrediction(); } \
-    TEST_F(Fixture, TestTooSmallSizePrediction) { testTooSmallSizePrediction(); }
+    TEST_F(Fixture, TestTooSmallSizePrediction) { testTooSmallSizePrediction(); }   \
+    TEST_F(Fixture, TestSinglePage) { testSinglePage(); }                           \
+    TEST_F(Fixture, TestMultiplePages) { testMultiplePages(); }                     \
+    TEST_F(Fixture, TestRejectTooLargeForPage) { testRejectTooLargeForPage(); }
 
 ADD_TESTS_FOR_FIXTURE(ShelfNextFitPackingTest)
 ADD_TESTS_FOR_FIXTURE(MaxRectsPackingTest)
+ADD_TESTS_FOR_FIXTURE(SkylinePackingTest)
+ADD_TESTS_FOR_FIXTURE(GuillotinePackingTest)
 
 #undef ADD_TESTS_FOR_FIXTURE
 
 TEST_F(MaxRectsPackingTest, TestNoFreeRect) { testNoFreeRect(); }
 TEST_F(MaxRectsPackingTest, TestFreeRectPruning) { testFreeRectPruning(); }
+TEST_F(MaxRectsPackingTest, TestManyRects) { testManyRects(); }
+TEST_F(MaxRectsPackingTest, TestCropAllFreeRects) { testCropAllFreeRects(); }
+TEST_F(MaxRectsPackingTest, TestScoreWrapTie) { testScoreWrapTie(); }
+TEST_F(MaxRectsPackingTest, TestZeroArea) { testZeroArea(); }
+TEST_F(SkylinePackingTest, TestFillSteps) { testFillSteps(); }
+TEST_F(GuillotinePackingTest, TestAllHeuristics) { testAllHeuristics(); }
+TEST_F(GuillotinePackingTest, TestMergeFreeRects) { testMergeFreeRects(); }
+TEST_F(AutoPackingTest, TestVariableSizePacking) { testVariableSizePacking(); }
+TEST_F(AutoPackingTest, TestTooSmallSizePrediction) { testTooSmallSizePrediction(); }
+TEST_F(AutoPackingTest, TestSinglePage) { testSinglePage(); }
+TEST_F(AutoPackingTest, TestMultiplePages) { testMultiplePages(); }
+TEST_F(AutoPackingTest, TestRejectTooLargeForPage) { testRejectTooLargeForPage(); }
+TEST_F(AutoPackingTest, TestSmallestOfAllStrategies) { testSmallestOfAllStrategies(); }
+TEST_F(AutoPackingTest, TestSmallerPacking) { testSmallerPacking(); }
+TEST_F(AutoPackingTest, TestValidPacking) { testValidPacking(); }
 
 TEST(PackingInternalsTest, TestCeilLog2) {
     for (int i = 0; i < 64; i++) {